@@ -0,0 +1,52 @@
+#pragma once
+
+// clock_gettime is POSIX and not part of C99
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define TLBT_BENCH_START() fprintf(stdout, "Starting benchmarks in '%s'.\n", __FILE__)
+
+#define TLBT_BENCH_DONE()                                                                                              \
+  fprintf(stdout, "All benchmarks in '%s' done.\n", __FILE__);                                                        \
+  return 0
+
+// prints the throughput of a measured section in million operations per second
+#define TLBT_BENCH_REPORT(name, ops, seconds)                                                                          \
+  fprintf(stdout, "  %-40s %10.2f Mops/s (%.3f s)\n", name, (double)(ops) / (seconds) / 1e6, seconds)
+
+// wall clock time in seconds. clock() would sum up the time of all threads in multi threaded benchmarks
+static inline double bench_now(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static inline uint64_t bench_rand(uint64_t *state) {
+  // splitmix64
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static inline uint32_t bench_hash_u32(uint32_t x) {
+  // murmur3 finalizer
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35U;
+  x ^= x >> 16;
+  return x;
+}
+
+// keeps the optimizer from removing the benchmarked work
+static volatile uint64_t bench_sink;
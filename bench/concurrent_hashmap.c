@@ -0,0 +1,127 @@
+#include "common.h"
+#include <pthread.h>
+#include <unistd.h>
+
+// reads and mixed reads/writes on 1 to N threads. the baseline is the single threaded map behind one global mutex,
+// which is what sharing a map looked like before. N is the number of online cores unless given as first argument
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/concurrent_hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define KEYS (1u << 20)
+#define OPS_PER_THREAD (1u << 22)
+#define MAX_THREADS 256
+
+typedef struct shared {
+  tlbt_cmap_uint32_t_uint32_t cmap;
+  tlbt_map_uint32_t_uint32_t map;
+  pthread_mutex_t lock;
+  unsigned write_percent;
+} shared;
+
+typedef struct worker {
+  shared *s;
+  uint64_t seed;
+  uint64_t hits;
+} worker;
+
+static void *cmap_worker(void *arg) {
+  worker *w = (worker *)arg;
+  uint64_t state = w->seed;
+  for (uint32_t i = 0; i < OPS_PER_THREAD; ++i) {
+    const uint64_t r = bench_rand(&state);
+    const uint32_t key = (uint32_t)r % (KEYS * 2);
+    if ((r >> 32) % 100 < w->s->write_percent) {
+      tlbt_cmap_uint32_t_uint32_t_insert_or_assign(&w->s->cmap, key, i);
+    } else {
+      uint32_t value = 0;
+      w->hits += tlbt_cmap_uint32_t_uint32_t_get(&w->s->cmap, key, &value);
+    }
+  }
+  return 0;
+}
+
+static void *locked_worker(void *arg) {
+  worker *w = (worker *)arg;
+  uint64_t state = w->seed;
+  for (uint32_t i = 0; i < OPS_PER_THREAD; ++i) {
+    const uint64_t r = bench_rand(&state);
+    const uint32_t key = (uint32_t)r % (KEYS * 2);
+    pthread_mutex_lock(&w->s->lock);
+    if ((r >> 32) % 100 < w->s->write_percent) {
+      tlbt_map_uint32_t_uint32_t_insert_or_assign(&w->s->map, key, i);
+    } else {
+      uint32_t value = 0;
+      w->hits += tlbt_map_uint32_t_uint32_t_get(&w->s->map, key, &value);
+    }
+    pthread_mutex_unlock(&w->s->lock);
+  }
+  return 0;
+}
+
+static void run(const char *name, void *(*fn)(void *), shared *s, int threads) {
+  pthread_t handles[MAX_THREADS];
+  worker workers[MAX_THREADS];
+  const double start = bench_now();
+  for (int i = 0; i < threads; ++i) {
+    workers[i] = (worker){.s = s, .seed = (uint64_t)i * 7919 + 1};
+    pthread_create(&handles[i], 0, fn, &workers[i]);
+  }
+  for (int i = 0; i < threads; ++i) {
+    pthread_join(handles[i], 0);
+    bench_sink += workers[i].hits;
+  }
+  char label[64];
+  snprintf(label, sizeof(label), "%s %d threads", name, threads);
+  TLBT_BENCH_REPORT(label, (double)OPS_PER_THREAD * threads, bench_now() - start);
+}
+
+int main(int argc, char **argv) {
+  TLBT_BENCH_START();
+
+  int max_threads = argc > 1 ? atoi(argv[1]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+  max_threads = max_threads < 1 ? 1 : (max_threads > MAX_THREADS ? MAX_THREADS : max_threads);
+
+  static shared s;
+  pthread_mutex_init(&s.lock, 0);
+  tlbt_cmap_uint32_t_uint32_t_create(&s.cmap, KEYS * 2);
+  tlbt_map_uint32_t_uint32_t_create(&s.map, KEYS * 4);
+  // half of the looked up keys exist
+  for (uint32_t i = 0; i < KEYS * 2; i += 2) {
+    tlbt_cmap_uint32_t_uint32_t_insert(&s.cmap, i, i);
+    tlbt_map_uint32_t_uint32_t_insert(&s.map, i, i);
+  }
+
+  const unsigned write_percents[] = {0, 10};
+  for (size_t w = 0; w < sizeof(write_percents) / sizeof(write_percents[0]); ++w) {
+    s.write_percent = write_percents[w];
+    fprintf(stdout, "  %u%% writes\n", s.write_percent);
+    // powers of 2 and the maximum itself
+    for (int threads = 1;; threads *= 2) {
+      threads = threads > max_threads ? max_threads : threads;
+      run("concurrent", cmap_worker, &s, threads);
+      run("global mutex", locked_worker, &s, threads);
+      if (threads == max_threads)
+        break;
+    }
+  }
+
+  tlbt_cmap_uint32_t_uint32_t_destroy(&s.cmap);
+  tlbt_map_uint32_t_uint32_t_destroy(&s.map);
+  pthread_mutex_destroy(&s.lock);
+
+  TLBT_BENCH_DONE();
+}
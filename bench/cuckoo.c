@@ -0,0 +1,80 @@
+#include "common.h"
+#include "../src/hash.h"
+
+// 64 bit dedup sets: linear probing and simd probing with a max load factor of 0.7 against the bucketized cuckoo set
+// at 0.95. every set is created with room for exactly the number of keys, so the memory is what each one needs at its
+// max load. lookups hit and miss half of the time each
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME linear
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME simd
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_HASH(x) tlbt_hash_mix64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+#define LOOKUPS (1u << 23)
+
+#define SET_BENCH(NAME, TYPE, CAPACITY, BYTES)                                                                         \
+  do {                                                                                                                 \
+    TYPE s = {0};                                                                                                      \
+    TYPE##_create(&s, CAPACITY);                                                                                       \
+    uint64_t state = 1;                                                                                                \
+    double start = bench_now();                                                                                        \
+    for (uint32_t i = 0; i < count; ++i)                                                                               \
+      TYPE##_insert(&s, bench_rand(&state));                                                                           \
+    TLBT_BENCH_REPORT(NAME " insert", count, bench_now() - start);                                                     \
+    uint64_t found = 0;                                                                                                \
+    state = 2;                                                                                                         \
+    start = bench_now();                                                                                               \
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {                                                                           \
+      /* replays the inserted keys for odd random numbers */                                                           \
+      const uint64_t r = bench_rand(&state);                                                                           \
+      uint64_t key_state = 1 + (r >> 1) % count * 0x9E3779B97F4A7C15ULL;                                               \
+      found += TYPE##_contains(&s, r & 1 ? bench_rand(&key_state) : r);                                                \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME " contains", LOOKUPS, bench_now() - start);                                                 \
+    bench_sink += found;                                                                                               \
+    fprintf(stdout, "  %-40s %10.2f bytes per key\n", NAME, (double)(BYTES) / count);                                  \
+    TYPE##_destroy(&s);                                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  // 0.95 of 4 slots in 2^14, 2^18 and 2^21 buckets. the power of 2 capacity of the simd set is 0.68 full then
+  const uint32_t bucket_counts[] = {1u << 14, 1u << 18, 1u << 21};
+  for (size_t c = 0; c < sizeof(bucket_counts) / sizeof(bucket_counts[0]); ++c) {
+    const uint32_t count = (uint32_t)(bucket_counts[c] * 4 * 0.95);
+    fprintf(stdout, "  %u keys\n", count);
+
+    // the smallest capacities whose max load factor fits every key
+    size_t linear_capacity = (size_t)(count / 0.7) + 2;
+    size_t simd_capacity = 16;
+    while ((double)simd_capacity * 0.7 < count + 1)
+      simd_capacity *= 2;
+
+    SET_BENCH("linear probing", tlbt_set_linear, linear_capacity, s.capacity * sizeof(*s.keys));
+    SET_BENCH("simd probing", tlbt_set_simd, simd_capacity, s.capacity * (sizeof(*s.keys) + 1));
+    SET_BENCH("cuckoo", tlbt_cuckoo_set_uint64_t, count, s.bucket_count * sizeof(*s.buckets));
+  }
+
+  TLBT_BENCH_DONE();
+}
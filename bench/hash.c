@@ -0,0 +1,63 @@
+#include "common.h"
+#include "../src/hash.h"
+
+// byte at a time djb2 as used by string_slice_hash in the tests
+static inline uint32_t djb2(const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  uint32_t hash = 36591911;
+  for (size_t i = 0; i < len; ++i)
+    hash = (hash << 5) + hash + p[i];
+  return hash;
+}
+
+#define BYTES_TOTAL (1u << 28)
+
+// hashes BYTES_TOTAL bytes in pieces of LEN bytes and prints GB/s
+#define BYTES_BENCH(NAME, HASH, LEN)                                                                                   \
+  do {                                                                                                                 \
+    const size_t len = (LEN);                                                                                          \
+    const size_t count = BYTES_TOTAL / len;                                                                            \
+    uint32_t acc = 0;                                                                                                  \
+    const double start = bench_now();                                                                                  \
+    for (size_t i = 0; i < count; ++i)                                                                                 \
+      acc += HASH(buffer + (i * 64) % (sizeof(buffer) - len), len);                                                    \
+    const double seconds = bench_now() - start;                                                                        \
+    bench_sink += acc;                                                                                                 \
+    char name[64];                                                                                                     \
+    snprintf(name, sizeof(name), "%s %zu bytes", NAME, len);                                                           \
+    fprintf(stdout, "  %-40s %10.2f GB/s\n", name, (double)BYTES_TOTAL / seconds / 1e9);                               \
+  } while (0)
+
+#define INT_OPS (1u << 27)
+
+#define INT_BENCH(NAME, HASH)                                                                                          \
+  do {                                                                                                                 \
+    uint32_t acc = 0;                                                                                                  \
+    const double start = bench_now();                                                                                  \
+    for (uint32_t i = 0; i < INT_OPS; ++i)                                                                             \
+      acc += HASH(i);                                                                                                  \
+    bench_sink += acc;                                                                                                 \
+    TLBT_BENCH_REPORT(NAME, INT_OPS, bench_now() - start);                                                             \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  // fits into the L2 cache so this measures the hash and not the memory
+  static unsigned char buffer[1 << 16];
+  uint64_t state = 7;
+  for (size_t i = 0; i < sizeof(buffer); ++i)
+    buffer[i] = (unsigned char)bench_rand(&state);
+
+  const size_t lengths[] = {8, 16, 32, 64, 256, 4096};
+  for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+    BYTES_BENCH("djb2", djb2, lengths[l]);
+    BYTES_BENCH("tlbt_hash_bytes", tlbt_hash_bytes, lengths[l]);
+    BYTES_BENCH("tlbt_hash_crc32", tlbt_hash_crc32, lengths[l]);
+  }
+
+  INT_BENCH("tlbt_hash_u32", tlbt_hash_u32);
+  INT_BENCH("tlbt_hash_u64", tlbt_hash_u64);
+
+  TLBT_BENCH_DONE();
+}
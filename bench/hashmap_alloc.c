@@ -0,0 +1,106 @@
+// MAP_ANONYMOUS isn't part of C99
+#define _DEFAULT_SOURCE
+#include "common.h"
+#include <unistd.h>
+
+// creating a table of 64M slots (768 MiB of keys and values) and inserting 16K entries. clearing the slots after
+// malloc writes every page up front. calloc and mmap get zeroed pages from the OS which are only committed once an
+// insert writes to them, so creating is nearly free and the resident memory follows the pages the entries landed in
+
+// called through a pointer because the compiler turns malloc followed by a memset to zero into calloc
+static void *(*volatile plain_malloc)(size_t) = malloc;
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME cleared
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC plain_malloc // without TLBT_CALLOC the slots get cleared after allocating them
+#define TLBT_FREE free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME calloced
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME mapped
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_MMAP
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME huge
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_MMAP
+#define TLBT_MAP_HUGE_PAGES
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define CAPACITY (1u << 26)
+#define ENTRIES (1u << 14)
+#define ROUNDS 3
+
+// resident memory of the process in MiB
+static double resident_mib(void) {
+  FILE *file = fopen("/proc/self/statm", "r");
+  if (!file)
+    return 0.0;
+  unsigned long size = 0, resident = 0;
+  const int read = fscanf(file, "%lu %lu", &size, &resident);
+  fclose(file);
+  return read == 2 ? (double)resident * (double)sysconf(_SC_PAGESIZE) / (1 << 20) : 0.0;
+}
+
+#define ALLOC_BENCH(NAME, TYPE)                                                                                        \
+  do {                                                                                                                 \
+    double create = 0.0, insert = 0.0, created_mib = 0.0, filled_mib = 0.0;                                            \
+    for (int round = 0; round < ROUNDS; ++round) {                                                                     \
+      const double base_mib = resident_mib();                                                                          \
+      TYPE m = {0};                                                                                                    \
+      double start = bench_now();                                                                                      \
+      TYPE##_create(&m, CAPACITY);                                                                                     \
+      create += bench_now() - start;                                                                                   \
+      created_mib += resident_mib() - base_mib;                                                                        \
+      start = bench_now();                                                                                             \
+      for (uint32_t i = 0; i < ENTRIES; ++i)                                                                           \
+        TYPE##_insert(&m, i, i);                                                                                       \
+      insert += bench_now() - start;                                                                                   \
+      filled_mib += resident_mib() - base_mib;                                                                         \
+      bench_sink += m.count;                                                                                           \
+      TYPE##_destroy(&m);                                                                                              \
+    }                                                                                                                  \
+    fprintf(stdout, "  %-40s %10.2f ms\n", NAME " create", create * 1e3 / ROUNDS);                                     \
+    TLBT_BENCH_REPORT(NAME " insert", (double)ENTRIES * ROUNDS, insert);                                               \
+    fprintf(stdout, "  %-40s %10.2f MiB resident after create, %.2f MiB after insert\n", NAME, created_mib / ROUNDS,   \
+            filled_mib / ROUNDS);                                                                                      \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  ALLOC_BENCH("malloc + clear", tlbt_map_cleared_uint32_t);
+  ALLOC_BENCH("calloc", tlbt_map_calloced_uint32_t);
+  ALLOC_BENCH("mmap", tlbt_map_mapped_uint32_t);
+  ALLOC_BENCH("mmap + huge pages", tlbt_map_huge_uint32_t);
+
+  TLBT_BENCH_DONE();
+}
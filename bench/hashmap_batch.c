@@ -0,0 +1,75 @@
+#include "common.h"
+
+// random lookups in a map much bigger than the last level cache. one get after another waits for each cache miss
+// while the batch functions overlap them by prefetching the home slots of the upcoming keys
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define ENTRIES (1u << 22)
+#define BATCH 10000
+#define BATCHES 200
+
+#define BATCH_BENCH(NAME)                                                                                              \
+  do {                                                                                                                 \
+    tlbt_map_##NAME##_uint32_t m = {0};                                                                                \
+    tlbt_map_##NAME##_uint32_t_create(&m, ENTRIES * 2);                                                                \
+    for (uint32_t i = 0; i < ENTRIES; ++i)                                                                             \
+      tlbt_map_##NAME##_uint32_t_insert(&m, i, i);                                                                     \
+                                                                                                                       \
+    static uint32_t keys[BATCH];                                                                                       \
+    static uint32_t values[BATCH];                                                                                     \
+    static bool found[BATCH];                                                                                          \
+    uint64_t state = 1;                                                                                                \
+    uint64_t sum = 0;                                                                                                  \
+    double single = 0.0;                                                                                               \
+    double batched = 0.0;                                                                                              \
+    for (int b = 0; b < BATCHES; ++b) {                                                                                \
+      /* three quarters hits */                                                                                        \
+      for (uint32_t i = 0; i < BATCH; ++i)                                                                             \
+        keys[i] = (uint32_t)(bench_rand(&state) % (ENTRIES + ENTRIES / 3));                                            \
+                                                                                                                       \
+      double start = bench_now();                                                                                      \
+      for (uint32_t i = 0; i < BATCH; ++i) {                                                                           \
+        uint32_t value = 0;                                                                                            \
+        if (tlbt_map_##NAME##_uint32_t_get(&m, keys[i], &value))                                                       \
+          sum += value;                                                                                                \
+      }                                                                                                                \
+      single += bench_now() - start;                                                                                   \
+                                                                                                                       \
+      start = bench_now();                                                                                             \
+      tlbt_map_##NAME##_uint32_t_get_batch(&m, keys, BATCH, values, found);                                            \
+      for (uint32_t i = 0; i < BATCH; ++i)                                                                             \
+        sum += found[i] ? values[i] : 0;                                                                               \
+      batched += bench_now() - start;                                                                                  \
+    }                                                                                                                  \
+    bench_sink += sum;                                                                                                 \
+    fprintf(stdout, "%s\n", #NAME);                                                                                    \
+    TLBT_BENCH_REPORT("get", (double)BATCH * BATCHES, single);                                                         \
+    TLBT_BENCH_REPORT("get_batch", (double)BATCH * BATCHES, batched);                                                  \
+    tlbt_map_##NAME##_uint32_t_destroy(&m);                                                                            \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+  BATCH_BENCH(uint32_t);
+  BATCH_BENCH(simd);
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,64 @@
+#include "common.h"
+
+// building a map from an array of pairs. inserting one by one doubles the map 20 times on the way and moves every
+// entry about once more. reserving first moves nothing and insert_many additionally prefetches the slots ahead
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define ENTRIES (1u << 23)
+#define ROUNDS 3
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  uint32_t *keys = malloc(sizeof(uint32_t) * ENTRIES);
+  uint32_t *values = malloc(sizeof(uint32_t) * ENTRIES);
+  uint64_t state = 5;
+  for (uint32_t i = 0; i < ENTRIES; ++i) {
+    keys[i] = (uint32_t)bench_rand(&state);
+    values[i] = i;
+  }
+
+  double single = 0.0, reserved = 0.0, many = 0.0;
+  for (int round = 0; round < ROUNDS; ++round) {
+    tlbt_map_uint32_t_uint32_t m = {0};
+    tlbt_map_uint32_t_uint32_t_create(&m, 16);
+    double start = bench_now();
+    for (uint32_t i = 0; i < ENTRIES; ++i)
+      tlbt_map_uint32_t_uint32_t_insert(&m, keys[i], values[i]);
+    single += bench_now() - start;
+    bench_sink += m.count;
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+
+    tlbt_map_uint32_t_uint32_t_create(&m, 16);
+    start = bench_now();
+    tlbt_map_uint32_t_uint32_t_reserve(&m, ENTRIES);
+    for (uint32_t i = 0; i < ENTRIES; ++i)
+      tlbt_map_uint32_t_uint32_t_insert(&m, keys[i], values[i]);
+    reserved += bench_now() - start;
+    bench_sink += m.count;
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+
+    tlbt_map_uint32_t_uint32_t_create(&m, 16);
+    start = bench_now();
+    tlbt_map_uint32_t_uint32_t_insert_many(&m, keys, values, ENTRIES);
+    many += bench_now() - start;
+    bench_sink += m.count;
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+  }
+
+  TLBT_BENCH_REPORT("insert", (double)ENTRIES * ROUNDS, single);
+  TLBT_BENCH_REPORT("reserve + insert", (double)ENTRIES * ROUNDS, reserved);
+  TLBT_BENCH_REPORT("insert_many", (double)ENTRIES * ROUNDS, many);
+
+  free(keys);
+  free(values);
+  TLBT_BENCH_DONE();
+}
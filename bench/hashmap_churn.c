@@ -0,0 +1,76 @@
+#include "common.h"
+
+// sliding window of live keys in a fixed memory map: every step removes the oldest key and inserts a new one.
+// tombstones pile up with the default scheme and make misses slower and slower while robin hood stays flat
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME linear
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define CAPACITY (1u << 16)
+#define LIVE (CAPACITY / 2)
+#define ROUNDS 8
+#define HIT_LOOKUPS 20000
+// misses degenerate into full table scans with the default scheme
+#define MISS_LOOKUPS 2000
+
+#define CHURN_BENCH(NAME)                                                                                              \
+  do {                                                                                                                 \
+    static tlbt_map_##NAME##_uint32_t_key keys[CAPACITY];                                                              \
+    static uint32_t values[CAPACITY];                                                                                  \
+    tlbt_map_##NAME##_uint32_t m = {0};                                                                                \
+    tlbt_map_##NAME##_uint32_t_init(&m, CAPACITY, keys, values);                                                       \
+    uint32_t next = 0;                                                                                                 \
+    for (; next < LIVE; ++next)                                                                                        \
+      tlbt_map_##NAME##_uint32_t_insert(&m, next, next);                                                               \
+    fprintf(stdout, "%s\n", #NAME);                                                                                    \
+    for (int round = 1; round <= ROUNDS; ++round) {                                                                    \
+      double start = bench_now();                                                                                      \
+      for (uint32_t i = 0; i < CAPACITY; ++i, ++next) {                                                                \
+        tlbt_map_##NAME##_uint32_t_remove(&m, next - LIVE);                                                            \
+        tlbt_map_##NAME##_uint32_t_insert(&m, next, next);                                                             \
+      }                                                                                                                \
+      const double churn = bench_now() - start;                                                                        \
+      if ((round & (round - 1)) != 0)                                                                                  \
+        continue;                                                                                                      \
+      uint64_t found = 0;                                                                                              \
+      start = bench_now();                                                                                             \
+      for (uint32_t i = 0; i < MISS_LOOKUPS; ++i)                                                                      \
+        found += tlbt_map_##NAME##_uint32_t_contains(&m, 0x80000000u + i);                                             \
+      const double misses = bench_now() - start;                                                                       \
+      start = bench_now();                                                                                             \
+      for (uint32_t i = 0; i < HIT_LOOKUPS; ++i)                                                                       \
+        found += tlbt_map_##NAME##_uint32_t_contains(&m, next - 1 - (i % LIVE));                                       \
+      const double hits = bench_now() - start;                                                                         \
+      bench_sink += found;                                                                                             \
+      char name[64];                                                                                                   \
+      snprintf(name, sizeof(name), "round %d churn (remove + insert)", round);                                         \
+      TLBT_BENCH_REPORT(name, CAPACITY, churn);                                                                        \
+      snprintf(name, sizeof(name), "round %d lookup misses", round);                                                   \
+      TLBT_BENCH_REPORT(name, MISS_LOOKUPS, misses);                                                                   \
+      snprintf(name, sizeof(name), "round %d lookup hits", round);                                                     \
+      TLBT_BENCH_REPORT(name, HIT_LOOKUPS, hits);                                                                      \
+    }                                                                                                                  \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+  CHURN_BENCH(linear);
+  CHURN_BENCH(robin_hood);
+  TLBT_BENCH_DONE();
+}
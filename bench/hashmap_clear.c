@@ -0,0 +1,62 @@
+#include "common.h"
+
+// a scratch map reused for many small requests. every request inserts and looks up a few keys and clears the map
+// afterwards. the map keeps the capacity of the biggest request it has seen, so without TLBT_MAP_EPOCH every clear
+// writes all of its slots
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME reset
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME epoch
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_EPOCH
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define REQUESTS 100000u
+#define KEYS_PER_REQUEST 32u
+
+#define CLEAR_BENCH(NAME, MAP)                                                                                         \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_uint32_t m = {0};                                                                                 \
+    tlbt_map_##MAP##_uint32_t_create(&m, capacity);                                                                    \
+    uint64_t state = 7;                                                                                                \
+    uint64_t found = 0;                                                                                                \
+    const double start = bench_now();                                                                                  \
+    for (uint32_t r = 0; r < REQUESTS; ++r) {                                                                          \
+      for (uint32_t i = 0; i < KEYS_PER_REQUEST; ++i)                                                                  \
+        tlbt_map_##MAP##_uint32_t_insert(&m, (uint32_t)bench_rand(&state), i);                                         \
+      for (uint32_t i = 0; i < KEYS_PER_REQUEST; ++i)                                                                  \
+        found += tlbt_map_##MAP##_uint32_t_contains(&m, (uint32_t)bench_rand(&state));                                 \
+      tlbt_map_##MAP##_uint32_t_clear(&m);                                                                             \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME, REQUESTS, bench_now() - start);                                                            \
+    bench_sink += found;                                                                                               \
+    tlbt_map_##MAP##_uint32_t_destroy(&m);                                                                             \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  const size_t capacities[] = {64, 4096, 65536};
+  for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); ++c) {
+    const size_t capacity = capacities[c];
+    fprintf(stdout, "  %zu slots, requests per second\n", capacity);
+    CLEAR_BENCH("clear resets every slot", reset);
+    CLEAR_BENCH("clear bumps the generation", epoch);
+  }
+
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,111 @@
+#include "common.h"
+
+// capacities which aren't a power of 2 with modulo against TLBT_FAST_RANGE, with a power of 2 table as the baseline.
+// modulo costs a 32 or 64 bit division for the home slot and another one for every probe step. fast range maps the
+// hash with a multiplication and wraps the probe position with a compare. the tables fit into the L2 cache so the
+// divisions aren't hidden behind cache misses. the deques are rings of 1000 elements which are pushed, popped and
+// indexed with `at`
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME modulo
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME fast
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME base2
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_T uint32_t
+#define TLBT_T_NAME modulo
+#define TLBT_NO_SORT
+#define TLBT_STATIC
+#include "../src/deque.h"
+
+#define TLBT_T uint32_t
+#define TLBT_T_NAME fast
+#define TLBT_FAST_RANGE
+#define TLBT_NO_SORT
+#define TLBT_STATIC
+#include "../src/deque.h"
+
+// 65% of 24000 slots. the power of 2 table is the next bigger one and only 48% full
+#define KEYS 15600u
+#define CAPACITY 24000u
+#define LOOKUPS (1u << 25)
+#define RING 1000u
+#define RING_OPS (1u << 26)
+
+#define MAP_BENCH(NAME, TYPE, CAPACITY)                                                                                \
+  do {                                                                                                                 \
+    TYPE m = {0};                                                                                                      \
+    TYPE##_create(&m, CAPACITY);                                                                                       \
+    for (uint32_t i = 0; i < KEYS; ++i)                                                                                \
+      TYPE##_insert(&m, i, i);                                                                                         \
+    uint64_t state = 7;                                                                                                \
+    uint64_t found = 0;                                                                                                \
+    uint32_t value = 0;                                                                                                \
+    double start = bench_now();                                                                                        \
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {                                                                           \
+      found += TYPE##_get(&m, (uint32_t)(bench_rand(&state) % KEYS), &value);                                          \
+      bench_sink += value;                                                                                             \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME " get hit", LOOKUPS, bench_now() - start);                                                  \
+    start = bench_now();                                                                                               \
+    for (uint32_t i = 0; i < LOOKUPS; ++i)                                                                             \
+      found += TYPE##_contains(&m, KEYS + (uint32_t)bench_rand(&state));                                              \
+    TLBT_BENCH_REPORT(NAME " get miss", LOOKUPS, bench_now() - start);                                                 \
+    bench_sink += found;                                                                                               \
+    TYPE##_destroy(&m);                                                                                                \
+  } while (0)
+
+// keeps the ring full. every step reads a few elements through `at`, pops one at the front and pushes one at the back
+#define DEQUE_BENCH(NAME, TYPE)                                                                                        \
+  do {                                                                                                                 \
+    static uint32_t buffer[RING];                                                                                      \
+    TYPE d = {0};                                                                                                      \
+    TYPE##_init(&d, RING, buffer);                                                                                     \
+    for (uint32_t i = 0; i < RING; ++i)                                                                                \
+      TYPE##_push_back(&d, i);                                                                                         \
+    uint64_t sum = 0;                                                                                                  \
+    const double start = bench_now();                                                                                  \
+    for (uint32_t i = 0; i < RING_OPS; ++i) {                                                                          \
+      sum += *TYPE##_at(&d, i % 7) + *TYPE##_at(&d, RING / 2) + *TYPE##_at(&d, RING - 1 - i % 5);                      \
+      TYPE##_pop_front(&d);                                                                                            \
+      TYPE##_push_back(&d, i);                                                                                         \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME, RING_OPS, bench_now() - start);                                                            \
+    bench_sink += sum;                                                                                                 \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  MAP_BENCH("modulo", tlbt_map_modulo_uint32_t, CAPACITY);
+  MAP_BENCH("fast range", tlbt_map_fast_uint32_t, CAPACITY);
+  MAP_BENCH("power of 2", tlbt_map_base2_uint32_t, 32768u);
+
+  DEQUE_BENCH("deque modulo", tlbt_deque_modulo);
+  DEQUE_BENCH("deque fast range", tlbt_deque_fast);
+
+  TLBT_BENCH_DONE();
+}
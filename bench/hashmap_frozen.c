@@ -0,0 +1,67 @@
+#include "common.h"
+
+// read only lookups in a mutable map against the frozen copy of it. the frozen map uses every slot and reads exactly
+// one of them per lookup while the mutable one probes and leaves 30% or more of its slots empty
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define LOOKUPS (1u << 24)
+
+#define LOOKUP_BENCH(NAME, CALL)                                                                                       \
+  do {                                                                                                                 \
+    uint64_t state = 3;                                                                                                \
+    uint64_t found = 0;                                                                                                \
+    const double start = bench_now();                                                                                  \
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {                                                                           \
+      /* keys are even so half of the lookups miss */                                                                  \
+      const uint32_t key = (uint32_t)(bench_rand(&state) % (count * 2));                                               \
+      uint32_t value = 0;                                                                                              \
+      found += CALL;                                                                                                   \
+      bench_sink += value;                                                                                             \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME, LOOKUPS, bench_now() - start);                                                             \
+    bench_sink += found;                                                                                               \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  const uint32_t counts[] = {1u << 10, 1u << 16, 1u << 22};
+  for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+    const uint32_t count = counts[c];
+    fprintf(stdout, "  %u keys\n", count);
+
+    tlbt_map_uint32_t_uint32_t m = {0};
+    tlbt_map_uint32_t_uint32_t_create(&m, 16);
+    for (uint32_t i = 0; i < count; ++i)
+      tlbt_map_uint32_t_uint32_t_insert(&m, i * 2, i);
+
+    tlbt_map_frozen_uint32_t_uint32_t f = {0};
+    const double start = bench_now();
+    tlbt_map_uint32_t_uint32_t_freeze(&m, &f);
+    const double freeze_seconds = bench_now() - start;
+
+    const double map_bytes = (double)m.capacity * (sizeof(*m.keys) + sizeof(*m.values));
+    const double frozen_bytes = (double)f.count * sizeof(*f.entries) +
+                                (double)f.buckets * sizeof(*f.seeds);
+    fprintf(stdout, "  %-40s %10.2f bytes per entry\n", "mutable", map_bytes / count);
+    fprintf(stdout, "  %-40s %10.2f bytes per entry (frozen in %.3f s)\n", "frozen", frozen_bytes / count,
+            freeze_seconds);
+
+    LOOKUP_BENCH("mutable get", tlbt_map_uint32_t_uint32_t_get(&m, key, &value));
+    LOOKUP_BENCH("frozen get", tlbt_map_frozen_uint32_t_uint32_t_get(&f, key, &value));
+
+    tlbt_map_frozen_uint32_t_uint32_t_destroy(&f);
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+  }
+
+  TLBT_BENCH_DONE();
+}
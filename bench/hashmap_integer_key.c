@@ -0,0 +1,86 @@
+#include "common.h"
+#include "../src/hash.h"
+
+// integer keys with the generic slots against TLBT_MAP_INTEGER_KEY. the generic slot of a 4 byte key carries a 4 byte
+// index next to it, the integer slot is only the key. an 8 byte key pads its index to 8 bytes as well. lookups are in
+// random order over a table much bigger than the caches, so fewer bytes per slot means fewer cache misses
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME generic_4
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME integer_4
+#define TLBT_VALUE_T uint32_t
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME generic_8
+#define TLBT_VALUE_T uint64_t
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME integer_8
+#define TLBT_VALUE_T uint64_t
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define KEYS (1u << 22)
+#define LOOKUPS (1u << 23)
+
+// keys 0 to KEYS - 1 are in the map, KEYS to 2 * KEYS - 1 are not
+#define INTEGER_BENCH(NAME, TYPE, KEY, VALUE)                                                                          \
+  do {                                                                                                                 \
+    TYPE m = {0};                                                                                                      \
+    TYPE##_create(&m, 16);                                                                                             \
+    double start = bench_now();                                                                                        \
+    for (uint32_t i = 0; i < KEYS; ++i)                                                                                \
+      TYPE##_insert(&m, (KEY)i, (VALUE)i);                                                                             \
+    TLBT_BENCH_REPORT(NAME " insert", KEYS, bench_now() - start);                                                      \
+    uint64_t state = 3;                                                                                                \
+    uint64_t found = 0;                                                                                                \
+    VALUE value = 0;                                                                                                   \
+    start = bench_now();                                                                                               \
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {                                                                           \
+      found += TYPE##_get(&m, (KEY)(bench_rand(&state) % KEYS), &value);                                               \
+      bench_sink += value;                                                                                             \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME " get hit", LOOKUPS, bench_now() - start);                                                  \
+    start = bench_now();                                                                                               \
+    for (uint32_t i = 0; i < LOOKUPS; ++i)                                                                             \
+      found += TYPE##_get(&m, (KEY)(KEYS + bench_rand(&state) % KEYS), &value);                                        \
+    TLBT_BENCH_REPORT(NAME " get miss", LOOKUPS, bench_now() - start);                                                 \
+    bench_sink += found;                                                                                               \
+    fprintf(stdout, "  %-40s %10.2f bytes per key\n", NAME,                                                            \
+            (double)(m.capacity * (sizeof(*m.keys) + sizeof(*m.values))) / KEYS);                                      \
+    TYPE##_destroy(&m);                                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  INTEGER_BENCH("4/4 generic", tlbt_map_generic_4_uint32_t, uint32_t, uint32_t);
+  INTEGER_BENCH("4/4 integer", tlbt_map_integer_4_uint32_t, uint32_t, uint32_t);
+  INTEGER_BENCH("8/8 generic", tlbt_map_generic_8_uint64_t, uint64_t, uint64_t);
+  INTEGER_BENCH("8/8 integer", tlbt_map_integer_8_uint64_t, uint64_t, uint64_t);
+
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,71 @@
+#include "common.h"
+
+// iterating a map which grew to 8M slots and only holds 10k entries now, like a cache after a burst. without the
+// bitmap every pass reads all slots, with it a pass reads 1 bit per slot and the live slots
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME scan
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME bitmap
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define CAPACITY (1u << 23)
+#define LIVE 10000u
+#define PASSES 20
+
+static bool sum_value(const uint32_t *key, uint32_t *value, void *userdata) {
+  (void)key;
+  *(uint64_t *)userdata += *value;
+  return true;
+}
+
+#define ITERATE_BENCH(NAME, MAP)                                                                                       \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_uint32_t m = {0};                                                                                 \
+    tlbt_map_##MAP##_uint32_t_create(&m, CAPACITY);                                                                    \
+    const uint32_t keys = (uint32_t)(CAPACITY * 0.69);                                                                 \
+    for (uint32_t i = 0; i < keys; ++i)                                                                                \
+      tlbt_map_##MAP##_uint32_t_insert(&m, i, i);                                                                      \
+    for (uint32_t i = LIVE; i < keys; ++i)                                                                             \
+      tlbt_map_##MAP##_uint32_t_remove(&m, i);                                                                         \
+    uint64_t sum = 0;                                                                                                  \
+    double start = bench_now();                                                                                        \
+    for (int pass = 0; pass < PASSES; ++pass) {                                                                        \
+      tlbt_map_iterator_##MAP##_uint32_t it = {0};                                                                     \
+      tlbt_map_iterator_##MAP##_uint32_t_init(&it, &m);                                                                \
+      uint32_t key = 0, value = 0;                                                                                     \
+      while (tlbt_map_iterator_##MAP##_uint32_t_iterate(&it, &key, &value))                                            \
+        sum += value;                                                                                                  \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME " iterate", (uint64_t)PASSES * LIVE, bench_now() - start);                                  \
+    start = bench_now();                                                                                               \
+    for (int pass = 0; pass < PASSES; ++pass)                                                                          \
+      tlbt_map_##MAP##_uint32_t_for_each(&m, sum_value, &sum);                                                         \
+    TLBT_BENCH_REPORT(NAME " for_each", (uint64_t)PASSES * LIVE, bench_now() - start);                                 \
+    bench_sink += sum;                                                                                                 \
+    tlbt_map_##MAP##_uint32_t_destroy(&m);                                                                             \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  ITERATE_BENCH("slot scan", scan);
+  ITERATE_BENCH("occupancy bitmap", bitmap);
+
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,75 @@
+#include "common.h"
+#include "../src/hash.h"
+
+// 32 bit against 64 bit hashes and slot metadata. with n keys a 32 bit hash produces about n^2 / 2^33 full hash
+// collisions, each of which costs a key comparison even with TLBT_MAP_STORE_HASH. past 2^32 slots a 32 bit map can't
+// address the table at all. the size is the first argument as log2 of the number of keys:
+//   build/bench/hashmap_large 31
+// needs about 28 * 2^32 bytes (key, hash and metadata plus the value per slot) for the large map
+
+static uint64_t equals_calls = 0;
+
+static inline bool counting_equals(uint64_t a, uint64_t b) {
+  ++equals_calls;
+  return a == b;
+}
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME small
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_MAP_STORE_HASH
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME large
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) tlbt_hash_mix64(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_MAP_LARGE
+#define TLBT_MAP_STORE_HASH
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define LARGE_BENCH(NAME, MAP)                                                                                         \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_uint32_t m = {0};                                                                                 \
+    tlbt_map_##MAP##_uint32_t_create(&m, 16);                                                                          \
+    uint64_t state = 5;                                                                                                \
+    equals_calls = 0;                                                                                                  \
+    double start = bench_now();                                                                                        \
+    for (uint64_t i = 0; i < count; ++i)                                                                               \
+      tlbt_map_##MAP##_uint32_t_insert(&m, bench_rand(&state), (uint32_t)i);                                           \
+    TLBT_BENCH_REPORT(NAME " insert", count, bench_now() - start);                                                     \
+    state = 5;                                                                                                         \
+    equals_calls = 0;                                                                                                  \
+    uint64_t found = 0;                                                                                                \
+    start = bench_now();                                                                                               \
+    for (uint64_t i = 0; i < count; ++i)                                                                               \
+      found += tlbt_map_##MAP##_uint32_t_contains(&m, bench_rand(&state));                                             \
+    TLBT_BENCH_REPORT(NAME " lookup", count, bench_now() - start);                                                     \
+    bench_sink += found;                                                                                               \
+    /* bench_rand is a bijection of the counter so the keys are distinct and every extra comparison is a collision */  \
+    fprintf(stdout, "  %-40s %10llu full hash collisions\n", NAME, (unsigned long long)(equals_calls - found));       \
+    tlbt_map_##MAP##_uint32_t_destroy(&m);                                                                             \
+  } while (0)
+
+int main(int argc, char **argv) {
+  TLBT_BENCH_START();
+
+  const int log2_count = argc > 1 ? atoi(argv[1]) : 22;
+  const uint64_t count = (uint64_t)1 << log2_count;
+  fprintf(stdout, "  %llu keys\n", (unsigned long long)count);
+
+  if (log2_count < 32)
+    LARGE_BENCH("32 bit", small);
+  LARGE_BENCH("TLBT_MAP_LARGE", large);
+
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,148 @@
+#include "common.h"
+#include "../src/hash.h"
+
+// values in their own array against values interleaved with the keys for growing value sizes. a hit reads the key
+// slot and the value, which are two cache misses split and one interleaved. a miss only probes keys, which are packed
+// tighter when split. lookups are in random order over a table much bigger than the caches
+
+typedef struct value64 {
+  uint64_t data[8];
+} value64;
+
+typedef struct value256 {
+  uint64_t data[32];
+} value256;
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME split_4
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME interleaved_4
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME split_8
+#define TLBT_VALUE_T uint64_t
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME interleaved_8
+#define TLBT_VALUE_T uint64_t
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME split_64
+#define TLBT_VALUE_T value64
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME interleaved_64
+#define TLBT_VALUE_T value64
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME split_256
+#define TLBT_VALUE_T value256
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME interleaved_256
+#define TLBT_VALUE_T value256
+#define TLBT_HASH(x) tlbt_hash_u64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define KEYS (1u << 20)
+#define LOOKUPS (1u << 22)
+
+// keys 0 to KEYS - 1 are in the map, KEYS to 2 * KEYS - 1 are not
+#define LAYOUT_BENCH(NAME, TYPE, KEY, VALUE, BYTES)                                                                    \
+  do {                                                                                                                 \
+    TYPE m = {0};                                                                                                      \
+    TYPE##_create(&m, 16);                                                                                             \
+    VALUE value;                                                                                                       \
+    for (uint32_t i = 0; i < KEYS; ++i) {                                                                              \
+      memset(&value, (int)i, sizeof(value));                                                                           \
+      TYPE##_insert(&m, (KEY)i, value);                                                                                \
+    }                                                                                                                  \
+    uint64_t state = 3;                                                                                                \
+    uint64_t found = 0;                                                                                                \
+    double start = bench_now();                                                                                        \
+    for (uint32_t i = 0; i < LOOKUPS; ++i) {                                                                           \
+      found += TYPE##_get(&m, (KEY)(bench_rand(&state) % KEYS), &value);                                               \
+      bench_sink += *(const uint8_t *)&value;                                                                          \
+    }                                                                                                                  \
+    TLBT_BENCH_REPORT(NAME " get hit", LOOKUPS, bench_now() - start);                                                  \
+    start = bench_now();                                                                                               \
+    for (uint32_t i = 0; i < LOOKUPS; ++i)                                                                             \
+      found += TYPE##_get(&m, (KEY)(KEYS + bench_rand(&state) % KEYS), &value);                                        \
+    TLBT_BENCH_REPORT(NAME " get miss", LOOKUPS, bench_now() - start);                                                 \
+    bench_sink += found;                                                                                               \
+    fprintf(stdout, "  %-40s %10.2f bytes per key\n", NAME, (double)(BYTES) / KEYS);                                   \
+    TYPE##_destroy(&m);                                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  LAYOUT_BENCH("4/4 split", tlbt_map_split_4_uint32_t, uint32_t, uint32_t,
+               m.capacity * (sizeof(*m.keys) + sizeof(*m.values)));
+  LAYOUT_BENCH("4/4 interleaved", tlbt_map_interleaved_4_uint32_t, uint32_t, uint32_t, m.capacity * sizeof(*m.keys));
+  LAYOUT_BENCH("8/8 split", tlbt_map_split_8_uint64_t, uint64_t, uint64_t,
+               m.capacity * (sizeof(*m.keys) + sizeof(*m.values)));
+  LAYOUT_BENCH("8/8 interleaved", tlbt_map_interleaved_8_uint64_t, uint64_t, uint64_t, m.capacity * sizeof(*m.keys));
+  LAYOUT_BENCH("8/64 split", tlbt_map_split_64_value64, uint64_t, value64,
+               m.capacity * (sizeof(*m.keys) + sizeof(*m.values)));
+  LAYOUT_BENCH("8/64 interleaved", tlbt_map_interleaved_64_value64, uint64_t, value64, m.capacity * sizeof(*m.keys));
+  LAYOUT_BENCH("8/256 split", tlbt_map_split_256_value256, uint64_t, value256,
+               m.capacity * (sizeof(*m.keys) + sizeof(*m.values)));
+  LAYOUT_BENCH("8/256 interleaved", tlbt_map_interleaved_256_value256, uint64_t, value256,
+               m.capacity * sizeof(*m.keys));
+
+  TLBT_BENCH_DONE();
+}
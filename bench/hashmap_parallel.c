@@ -0,0 +1,62 @@
+#include "common.h"
+
+// building a map of 8M random keys with insert_many on one thread against build_parallel on more and more threads.
+// every thread inserts into its own region of the table, so the build should scale with the number of cores
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_PARALLEL_BUILD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define ENTRIES (1u << 23)
+#define ROUNDS 3
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  uint32_t *keys = malloc(sizeof(uint32_t) * ENTRIES);
+  uint32_t *values = malloc(sizeof(uint32_t) * ENTRIES);
+  uint64_t state = 9;
+  for (uint32_t i = 0; i < ENTRIES; ++i) {
+    keys[i] = (uint32_t)bench_rand(&state);
+    values[i] = i;
+  }
+
+  double seconds = 0.0;
+  for (int round = 0; round < ROUNDS; ++round) {
+    tlbt_map_uint32_t_uint32_t m = {0};
+    tlbt_map_uint32_t_uint32_t_create(&m, 16);
+    const double start = bench_now();
+    tlbt_map_uint32_t_uint32_t_insert_many(&m, keys, values, ENTRIES);
+    seconds += bench_now() - start;
+    bench_sink += m.count;
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+  }
+  TLBT_BENCH_REPORT("insert_many", (double)ENTRIES * ROUNDS, seconds);
+
+  const size_t threads[] = {1, 2, 4, 8, 16};
+  for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+    seconds = 0.0;
+    for (int round = 0; round < ROUNDS; ++round) {
+      tlbt_map_uint32_t_uint32_t m = {0};
+      tlbt_map_uint32_t_uint32_t_create(&m, 16);
+      const double start = bench_now();
+      tlbt_map_uint32_t_uint32_t_build_parallel(&m, keys, values, ENTRIES, threads[t]);
+      seconds += bench_now() - start;
+      bench_sink += m.count;
+      tlbt_map_uint32_t_uint32_t_destroy(&m);
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "build_parallel %zu threads", threads[t]);
+    TLBT_BENCH_REPORT(name, (double)ENTRIES * ROUNDS, seconds);
+  }
+
+  free(keys);
+  free(values);
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,178 @@
+#include "common.h"
+#include <pthread.h>
+
+// lookups in a read-mostly map of 64K keys while one writer changes it every millisecond. the plain map is read by a
+// single thread without any synchronization as the baseline. the locked map is read under a mutex which the writer
+// holds while it updates the map in place. the rcu map is read through snapshots while the writer publishes a changed
+// copy, either with read_begin and read_end around every lookup or around batches of 256 lookups which are then
+// plain gets. on a single core the threads take turns, so it shows the cost per lookup rather than the scaling
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_RCU
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define KEYS (1u << 16)
+#define LOOKUPS (1u << 24)
+
+typedef tlbt_map_uint32_t_uint32_t map;
+typedef tlbt_map_rcu_uint32_t_uint32_t rcu;
+
+typedef struct {
+  size_t reader;
+  size_t lookups;
+  map *locked;
+  pthread_mutex_t *lock;
+  rcu *rcu;
+  uint64_t found;
+} task;
+
+static volatile int writing;
+
+static void *read_locked(void *arg) {
+  task *t = (task *)arg;
+  uint64_t state = t->reader + 1;
+  uint32_t value = 0;
+  for (size_t i = 0; i < t->lookups; ++i) {
+    pthread_mutex_lock(t->lock);
+    t->found += tlbt_map_uint32_t_uint32_t_get(t->locked, (uint32_t)bench_rand(&state) % KEYS, &value);
+    pthread_mutex_unlock(t->lock);
+  }
+  return NULL;
+}
+
+static void *read_rcu(void *arg) {
+  task *t = (task *)arg;
+  uint64_t state = t->reader + 1;
+  uint32_t value = 0;
+  for (size_t i = 0; i < t->lookups; ++i)
+    t->found += tlbt_map_rcu_uint32_t_uint32_t_get(t->rcu, t->reader, (uint32_t)bench_rand(&state) % KEYS, &value);
+  return NULL;
+}
+
+static void *read_rcu_batched(void *arg) {
+  task *t = (task *)arg;
+  uint64_t state = t->reader + 1;
+  uint32_t value = 0;
+  for (size_t i = 0; i < t->lookups; i += 256) {
+    map *m = tlbt_map_rcu_uint32_t_uint32_t_read_begin(t->rcu, t->reader);
+    for (size_t j = 0; j < 256; ++j)
+      t->found += tlbt_map_uint32_t_uint32_t_get(m, (uint32_t)bench_rand(&state) % KEYS, &value);
+    tlbt_map_rcu_uint32_t_uint32_t_read_end(t->rcu, t->reader);
+  }
+  return NULL;
+}
+
+static void pause_writer(void) {
+  const struct timespec millisecond = {0, 1000000};
+  nanosleep(&millisecond, NULL);
+}
+
+// changes a few hundred values every millisecond until the readers are done
+static void *write_locked(void *arg) {
+  task *t = (task *)arg;
+  for (uint32_t round = 0; __atomic_load_n(&writing, __ATOMIC_RELAXED); ++round) {
+    pthread_mutex_lock(t->lock);
+    for (uint32_t i = 0; i < 256; ++i)
+      tlbt_map_uint32_t_uint32_t_insert_or_assign(t->locked, (round * 256 + i) % KEYS, round);
+    pthread_mutex_unlock(t->lock);
+    pause_writer();
+  }
+  return NULL;
+}
+
+static void *write_rcu(void *arg) {
+  task *t = (task *)arg;
+  for (uint32_t round = 0; __atomic_load_n(&writing, __ATOMIC_RELAXED); ++round) {
+    map *next = tlbt_map_rcu_uint32_t_uint32_t_prepare_copy(t->rcu);
+    for (uint32_t i = 0; i < 256; ++i)
+      tlbt_map_uint32_t_uint32_t_insert_or_assign(next, (round * 256 + i) % KEYS, round);
+    tlbt_map_rcu_uint32_t_uint32_t_publish(t->rcu, next);
+    pause_writer();
+  }
+  tlbt_map_rcu_uint32_t_uint32_t_synchronize(t->rcu);
+  return NULL;
+}
+
+static double run(void *(*reader)(void *), void *(*writer)(void *), task *tasks, size_t readers) {
+  pthread_t handles[16];
+  pthread_t handle;
+  __atomic_store_n(&writing, 1, __ATOMIC_RELAXED);
+  const double start = bench_now();
+  pthread_create(&handle, NULL, writer, &tasks[0]);
+  for (size_t t = 0; t < readers; ++t)
+    pthread_create(&handles[t], NULL, reader, &tasks[t]);
+  for (size_t t = 0; t < readers; ++t)
+    pthread_join(handles[t], NULL);
+  const double elapsed = bench_now() - start;
+  __atomic_store_n(&writing, 0, __ATOMIC_RELAXED);
+  pthread_join(handle, NULL);
+  for (size_t t = 0; t < readers; ++t)
+    bench_sink += tasks[t].found;
+  return elapsed;
+}
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  {
+    map m = {0};
+    tlbt_map_uint32_t_uint32_t_create(&m, KEYS * 2);
+    for (uint32_t i = 0; i < KEYS; ++i)
+      tlbt_map_uint32_t_uint32_t_insert(&m, i, i);
+    uint64_t state = 1, found = 0;
+    uint32_t value = 0;
+    const double start = bench_now();
+    for (size_t i = 0; i < LOOKUPS; ++i)
+      found += tlbt_map_uint32_t_uint32_t_get(&m, (uint32_t)bench_rand(&state) % KEYS, &value);
+    TLBT_BENCH_REPORT("plain 1 thread", LOOKUPS, bench_now() - start);
+    bench_sink += found;
+    tlbt_map_uint32_t_uint32_t_destroy(&m);
+  }
+
+  const size_t threads[] = {1, 2, 4, 8, 16};
+  for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); ++k) {
+    const size_t n = threads[k];
+    task tasks[16];
+
+    map locked = {0};
+    tlbt_map_uint32_t_uint32_t_create(&locked, KEYS * 2);
+    for (uint32_t i = 0; i < KEYS; ++i)
+      tlbt_map_uint32_t_uint32_t_insert(&locked, i, i);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    rcu r = {0};
+    tlbt_map_rcu_uint32_t_uint32_t_create(&r, n);
+    map *first = tlbt_map_rcu_uint32_t_uint32_t_prepare(&r);
+    tlbt_map_uint32_t_uint32_t_copy(first, &locked);
+    tlbt_map_rcu_uint32_t_uint32_t_publish(&r, first);
+
+    for (size_t t = 0; t < n; ++t)
+      tasks[t] = (task){t, LOOKUPS / n, &locked, &lock, &r, 0};
+    const double locked_time = run(read_locked, write_locked, tasks, n);
+    for (size_t t = 0; t < n; ++t)
+      tasks[t].found = 0;
+    const double rcu_time = run(read_rcu, write_rcu, tasks, n);
+    for (size_t t = 0; t < n; ++t)
+      tasks[t].found = 0;
+    const double batched_time = run(read_rcu_batched, write_rcu, tasks, n);
+
+    char name[64];
+    snprintf(name, sizeof(name), "mutex %zu readers", n);
+    TLBT_BENCH_REPORT(name, LOOKUPS, locked_time);
+    snprintf(name, sizeof(name), "rcu %zu readers", n);
+    TLBT_BENCH_REPORT(name, LOOKUPS, rcu_time);
+    snprintf(name, sizeof(name), "rcu batched %zu readers", n);
+    TLBT_BENCH_REPORT(name, LOOKUPS, batched_time);
+
+    tlbt_map_rcu_uint32_t_uint32_t_destroy(&r);
+    tlbt_map_uint32_t_uint32_t_destroy(&locked);
+  }
+
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,54 @@
+#include "common.h"
+
+// grows a dynamic map from a tiny capacity and records the slowest single insert. rehashing everything at once
+// makes the worst insert as slow as the whole table while the incremental mode only migrates a few slots per call
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME rehash
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME incremental
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define ENTRIES (1u << 22)
+
+#define RESIZE_BENCH(NAME)                                                                                             \
+  do {                                                                                                                 \
+    tlbt_map_##NAME##_uint32_t m = {0};                                                                                \
+    tlbt_map_##NAME##_uint32_t_create(&m, 16);                                                                         \
+    double worst = 0.0;                                                                                                \
+    const double start = bench_now();                                                                                  \
+    for (uint32_t i = 0; i < ENTRIES; ++i) {                                                                           \
+      const double before = bench_now();                                                                               \
+      tlbt_map_##NAME##_uint32_t_insert(&m, i, i);                                                                     \
+      const double took = bench_now() - before;                                                                        \
+      if (took > worst)                                                                                                \
+        worst = took;                                                                                                  \
+    }                                                                                                                  \
+    const double total = bench_now() - start;                                                                          \
+    fprintf(stdout, "%s\n", #NAME);                                                                                    \
+    TLBT_BENCH_REPORT("insert (including timer overhead)", ENTRIES, total);                                            \
+    fprintf(stdout, "  %-40s %10.3f ms\n", "slowest single insert", worst * 1e3);                                      \
+    tlbt_map_##NAME##_uint32_t_destroy(&m);                                                                            \
+  } while (0)
+
+int main(void) {
+  TLBT_BENCH_START();
+  RESIZE_BENCH(rehash);
+  RESIZE_BENCH(incremental);
+  TLBT_BENCH_DONE();
+}
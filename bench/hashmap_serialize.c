@@ -0,0 +1,71 @@
+// mmap and fileno are POSIX and not part of C99
+#define _POSIX_C_SOURCE 200112L
+
+#include "common.h"
+#include <sys/mman.h>
+
+// startup cost of a big map: inserting every key again against reading a saved map and viewing it through mmap.
+// the file sits in the page cache so the mmap numbers are the minor fault cost, a cold disk adds its read time
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define KEYS (1u << 22)
+
+static void lookup_all(const char *name, tlbt_map_uint32_t_uint32_t *m, double setup_seconds) {
+  const double start = bench_now();
+  uint64_t found = 0;
+  for (uint32_t i = 0; i < KEYS; ++i) {
+    uint32_t value = 0;
+    found += tlbt_map_uint32_t_uint32_t_get(m, i * 2, &value);
+    bench_sink += value;
+  }
+  bench_sink += found;
+  const double seconds = bench_now() - start;
+  fprintf(stdout, "  %-40s %10.3f s (first pass over all keys %.3f s)\n", name, setup_seconds, seconds);
+}
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  double start = bench_now();
+  tlbt_map_uint32_t_uint32_t m = {0};
+  tlbt_map_uint32_t_uint32_t_create(&m, 16);
+  for (uint32_t i = 0; i < KEYS; ++i)
+    tlbt_map_uint32_t_uint32_t_insert(&m, i * 2, i);
+  lookup_all("insert every key", &m, bench_now() - start);
+
+  FILE *file = tmpfile();
+  start = bench_now();
+  tlbt_map_uint32_t_uint32_t_save(&m, file);
+  fflush(file);
+  const double save_seconds = bench_now() - start;
+  fseek(file, 0, SEEK_END);
+  const size_t size = (size_t)ftell(file);
+  rewind(file);
+  fprintf(stdout, "  %-40s %10.3f s (%.1f MiB)\n", "save", save_seconds, (double)size / (1024 * 1024));
+  tlbt_map_uint32_t_uint32_t_destroy(&m);
+
+  start = bench_now();
+  tlbt_map_uint32_t_uint32_t loaded = {0};
+  tlbt_map_uint32_t_uint32_t_load(&loaded, file);
+  lookup_all("load", &loaded, bench_now() - start);
+  tlbt_map_uint32_t_uint32_t_destroy(&loaded);
+
+  start = bench_now();
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+  tlbt_map_uint32_t_uint32_t viewed = {0};
+  tlbt_map_uint32_t_uint32_t_view(&viewed, data, size);
+  lookup_all("mmap and view", &viewed, bench_now() - start);
+  munmap(data, size);
+
+  fclose(file);
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,126 @@
+#include "common.h"
+#include <pthread.h>
+
+// counting 16M words with a skewed distribution over up to 1M distinct keys, like a word count. the few hottest keys
+// make up a big part of the input. one map behind a mutex serializes every thread on it, the sharded map lets every
+// thread count into its own maps and merges them per partition afterwards. the time includes merging
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_SHARDED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define WORDS (1u << 24)
+#define PARTITIONS 64
+
+typedef tlbt_map_uint32_t_uint32_t map;
+typedef tlbt_map_sharded_uint32_t_uint32_t sharded;
+
+static void add(uint32_t *into, uint32_t value, void *userdata) {
+  (void)userdata;
+  *into += value;
+}
+
+typedef struct {
+  const uint32_t *words;
+  size_t first;
+  size_t last;
+  size_t thread;
+  map *shared;
+  pthread_mutex_t *lock;
+  sharded *sharded;
+} task;
+
+static void *count_locked(void *arg) {
+  const task *t = (const task *)arg;
+  for (size_t i = t->first; i < t->last; ++i) {
+    pthread_mutex_lock(t->lock);
+    bool inserted = false;
+    uint32_t *count = tlbt_map_uint32_t_uint32_t_get_or_insert(t->shared, t->words[i], &inserted);
+    *count = inserted ? 1 : *count + 1;
+    pthread_mutex_unlock(t->lock);
+  }
+  return NULL;
+}
+
+static void *count_sharded(void *arg) {
+  const task *t = (const task *)arg;
+  for (size_t i = t->first; i < t->last; ++i)
+    tlbt_map_sharded_uint32_t_uint32_t_add(t->sharded, t->thread, t->words[i], 1);
+  return NULL;
+}
+
+static void run(void *(*worker)(void *), task *tasks, size_t threads) {
+  pthread_t handles[16];
+  for (size_t t = 0; t < threads; ++t)
+    pthread_create(&handles[t], NULL, worker, &tasks[t]);
+  for (size_t t = 0; t < threads; ++t)
+    pthread_join(handles[t], NULL);
+}
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  // the number of bits of a word is uniform, so word 0 is about a tenth of the input and most keys are rare
+  uint32_t *words = malloc(sizeof(uint32_t) * WORDS);
+  uint64_t state = 17;
+  for (uint32_t i = 0; i < WORDS; ++i) {
+    const uint64_t r = bench_rand(&state);
+    words[i] = (uint32_t)(r >> 32) & ((1u << (r % 21)) - 1);
+  }
+
+  const size_t threads[] = {1, 2, 4, 8, 16};
+  for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); ++k) {
+    const size_t n = threads[k];
+    task tasks[16];
+
+    map shared = {0};
+    tlbt_map_uint32_t_uint32_t_create(&shared, 16);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    for (size_t t = 0; t < n; ++t)
+      tasks[t] = (task){words, WORDS * t / n, WORDS * (t + 1) / n, t, &shared, &lock, NULL};
+    double start = bench_now();
+    run(count_locked, tasks, n);
+    const double locked = bench_now() - start;
+    bench_sink += shared.count;
+
+    sharded s = {0};
+    tlbt_map_sharded_uint32_t_uint32_t_create(&s, n, PARTITIONS, add, NULL);
+    for (size_t t = 0; t < n; ++t)
+      tasks[t].sharded = &s;
+    start = bench_now();
+    run(count_sharded, tasks, n);
+    const double counted = bench_now() - start;
+    tlbt_map_sharded_uint32_t_uint32_t_merge(&s);
+    const double merged = bench_now() - start;
+
+    // both have to agree
+    size_t distinct = 0;
+    for (size_t p = 0; p < PARTITIONS; ++p)
+      distinct += tlbt_map_sharded_uint32_t_uint32_t_partition(&s, p)->count;
+    uint32_t zeros = 0, expected = 0;
+    tlbt_map_sharded_uint32_t_uint32_t_get(&s, 0, &zeros);
+    tlbt_map_uint32_t_uint32_t_get(&shared, 0, &expected);
+    if (distinct != shared.count || zeros != expected)
+      fprintf(stdout, "  the sharded map counted differently\n");
+
+    char name[64];
+    snprintf(name, sizeof(name), "mutex %zu threads", n);
+    TLBT_BENCH_REPORT(name, WORDS, locked);
+    snprintf(name, sizeof(name), "sharded %zu threads", n);
+    TLBT_BENCH_REPORT(name, WORDS, merged);
+    fprintf(stdout, "  %-40s %10.2f ms of it merging\n", "", (merged - counted) * 1e3);
+
+    tlbt_map_sharded_uint32_t_uint32_t_destroy(&s);
+    tlbt_map_uint32_t_uint32_t_destroy(&shared);
+  }
+
+  free(words);
+  TLBT_BENCH_DONE();
+}
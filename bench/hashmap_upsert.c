@@ -0,0 +1,53 @@
+#include "common.h"
+
+// counting the occurrences of skewed keys. without an upsert every update needs a get followed by remove and insert,
+// which probes the table three times
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define DISTINCT (1u << 18)
+#define UPDATES (1u << 23)
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  static uint32_t keys[UPDATES];
+  uint64_t state = 99;
+  for (uint32_t i = 0; i < UPDATES; ++i) {
+    // squaring a uniform number makes small keys a lot more common
+    const uint64_t r = bench_rand(&state) % DISTINCT;
+    keys[i] = (uint32_t)(r * r / DISTINCT);
+  }
+
+  tlbt_map_uint32_t_uint32_t m = {0};
+  tlbt_map_uint32_t_uint32_t_create(&m, 16);
+  double start = bench_now();
+  for (uint32_t i = 0; i < UPDATES; ++i) {
+    uint32_t count = 0;
+    if (tlbt_map_uint32_t_uint32_t_get(&m, keys[i], &count))
+      tlbt_map_uint32_t_uint32_t_remove(&m, keys[i]);
+    tlbt_map_uint32_t_uint32_t_insert(&m, keys[i], count + 1);
+  }
+  TLBT_BENCH_REPORT("get + remove + insert", UPDATES, bench_now() - start);
+  tlbt_map_uint32_t_uint32_t_destroy(&m);
+
+  tlbt_map_uint32_t_uint32_t_create(&m, 16);
+  start = bench_now();
+  for (uint32_t i = 0; i < UPDATES; ++i) {
+    bool inserted = false;
+    uint32_t *count = tlbt_map_uint32_t_uint32_t_get_or_insert(&m, keys[i], &inserted);
+    *count = inserted ? 1 : *count + 1;
+  }
+  TLBT_BENCH_REPORT("get_or_insert", UPDATES, bench_now() - start);
+  bench_sink += m.count;
+  tlbt_map_uint32_t_uint32_t_destroy(&m);
+
+  TLBT_BENCH_DONE();
+}
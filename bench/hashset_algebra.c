@@ -0,0 +1,104 @@
+#include "common.h"
+
+// set algebra on two sets of 10M random keys which share about half of them. the naive loops iterate one set, call
+// contains on the other and insert into an output which grows on the way. the set functions size the output once,
+// reuse the stored hashes and prefetch the slots of the other set a few keys ahead
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_HASH(x) bench_hash_u32(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define ENTRIES 10000000u
+#define ROUNDS 3
+
+typedef tlbt_set_uint32_t set;
+
+static void naive_intersect(set *out, set *a, set *b) {
+  tlbt_set_uint32_t_clear(out);
+  tlbt_set_iterator_uint32_t it = {0};
+  tlbt_set_iterator_uint32_t_init(&it, a);
+  uint32_t key = 0;
+  while (tlbt_set_iterator_uint32_t_iterate(&it, &key)) {
+    if (tlbt_set_uint32_t_contains(b, key))
+      tlbt_set_uint32_t_insert(out, key);
+  }
+}
+
+static void naive_difference(set *out, set *a, set *b) {
+  tlbt_set_uint32_t_clear(out);
+  tlbt_set_iterator_uint32_t it = {0};
+  tlbt_set_iterator_uint32_t_init(&it, a);
+  uint32_t key = 0;
+  while (tlbt_set_iterator_uint32_t_iterate(&it, &key)) {
+    if (!tlbt_set_uint32_t_contains(b, key))
+      tlbt_set_uint32_t_insert(out, key);
+  }
+}
+
+int main(void) {
+  TLBT_BENCH_START();
+
+  set a = {0}, b = {0};
+  tlbt_set_uint32_t_create(&a, 16);
+  tlbt_set_uint32_t_create(&b, 16);
+  tlbt_set_uint32_t_reserve(&a, ENTRIES);
+  tlbt_set_uint32_t_reserve(&b, ENTRIES);
+  uint64_t state = 13;
+  for (uint32_t i = 0; i < ENTRIES; ++i) {
+    const uint32_t key = (uint32_t)bench_rand(&state);
+    tlbt_set_uint32_t_insert(&a, key);
+    tlbt_set_uint32_t_insert(&b, (i & 1) ? key : (uint32_t)bench_rand(&state));
+  }
+
+  double naive_and = 0.0, naive_minus = 0.0, into_and = 0.0, into_minus = 0.0, counting = 0.0;
+  for (int round = 0; round < ROUNDS; ++round) {
+    // fresh outputs every round so the naive loops pay for growing them like they would in practice
+    set out = {0};
+    tlbt_set_uint32_t_create(&out, 16);
+    double start = bench_now();
+    naive_intersect(&out, &a, &b);
+    naive_and += bench_now() - start;
+    bench_sink += out.count;
+    tlbt_set_uint32_t_destroy(&out);
+
+    tlbt_set_uint32_t_create(&out, 16);
+    start = bench_now();
+    naive_difference(&out, &a, &b);
+    naive_minus += bench_now() - start;
+    bench_sink += out.count;
+    tlbt_set_uint32_t_destroy(&out);
+
+    tlbt_set_uint32_t_create(&out, 16);
+    start = bench_now();
+    tlbt_set_uint32_t_intersect_into(&out, &a, &b);
+    into_and += bench_now() - start;
+    bench_sink += out.count;
+    tlbt_set_uint32_t_destroy(&out);
+
+    tlbt_set_uint32_t_create(&out, 16);
+    start = bench_now();
+    tlbt_set_uint32_t_difference_into(&out, &a, &b);
+    into_minus += bench_now() - start;
+    bench_sink += out.count;
+    tlbt_set_uint32_t_destroy(&out);
+
+    start = bench_now();
+    bench_sink += tlbt_set_uint32_t_intersection_count(&a, &b);
+    counting += bench_now() - start;
+  }
+
+  TLBT_BENCH_REPORT("naive intersect", (double)ENTRIES * ROUNDS, naive_and);
+  TLBT_BENCH_REPORT("intersect_into", (double)ENTRIES * ROUNDS, into_and);
+  TLBT_BENCH_REPORT("naive difference", (double)ENTRIES * ROUNDS, naive_minus);
+  TLBT_BENCH_REPORT("difference_into", (double)ENTRIES * ROUNDS, into_minus);
+  TLBT_BENCH_REPORT("intersection_count", (double)ENTRIES * ROUNDS, counting);
+
+  tlbt_set_uint32_t_destroy(&a);
+  tlbt_set_uint32_t_destroy(&b);
+  TLBT_BENCH_DONE();
+}
@@ -0,0 +1,649 @@
+/*
+hashmap which can be shared between threads. the map is split into segments by the upper bits of the hash. every
+segment is an open addressing table with linear probing, its own lock and a sequence counter:
+- get and contains never take a lock and never write shared memory. they read the table optimistically and retry
+  if a writer modified the same segment in the meantime (seqlock), so reads scale with the number of cores. they
+  are not lock free though: while a write to the same segment is in progress they wait for it (see notes)
+- insert, insert_or_assign and remove lock only the segment of the key. writers of different segments don't block
+  each other
+- growing builds a new table twice as big while readers keep using the old one and publishes it afterwards. tables
+  which were replaced are kept until the map is destroyed because a reader might still be inside of them. together
+  they are never bigger than the current tables
+- tombstones are dropped in place when a segment runs out of room without needing more, so removing and inserting
+  keys over and over doesn't allocate anything
+
+requires GCC or clang (__atomic builtins) and pthreads
+
+types:
+- tlbt_cmap_KEY_VALUE  map type KEY and VALUE depend on your definitions
+
+functions (_ph variants require you to provide the hash):
+- tlbt_cmap_KEY_VALUE_create                creates the map with room for at least capacity entries
+- tlbt_cmap_KEY_VALUE_destroy               destroys the map. no other thread may use it anymore
+- tlbt_cmap_KEY_VALUE_get(_ph)              tries retrieving the value with a key
+- tlbt_cmap_KEY_VALUE_contains(_ph)         checks if a value exists with its key
+- tlbt_cmap_KEY_VALUE_insert(_ph)           inserts the entry. false if the key already exists
+- tlbt_cmap_KEY_VALUE_insert_or_assign(_ph) inserts the entry or overwrites the value of an existing key. true if
+                                            the key was inserted
+- tlbt_cmap_KEY_VALUE_remove(_ph)           tries removing the entry with a key
+- tlbt_cmap_KEY_VALUE_count                 the number of entries. only a snapshot while other threads write
+
+TLBT_DEFINITION      if you want to define the types and functions in a header file
+TLBT_IMPLEMENTATION  for the corresponding implementation of the definitions in a separate source file
+TLBT_STATIC          if you want to define and implement them statically in a source file
+
+=== required definitions ===
+TLBT_KEY_T                      the hashmap key type
+TLBT_HASH OR TLBT_HASH_REF      the function for hashing the key
+TLBT_EQUALS OR TLBT_EQUALS_REF  the function for checking key equality
+
+=== optional definitions ===
+TLBT_VALUE_T            the hashmap value type. when omitted it will be a hashset
+TLBT_KEY_T_NAME         default is TLBT_KEY_T
+TLBT_VALUE_T_NAME       default is TLBT_VALUE_T
+TLBT_ASSERT             default is assert from <assert.h>
+TLBT_MEMSET             default is memset from <string.h>
+TLBT_MAX_LOAD_FACTOR    float ]0,1[. tombstones count towards the load. default is 0.7
+TLBT_SIZE_T             default is size_t from <stddef.h>
+TLBT_UINT32_T           default is uint32_t from <stdint.h>
+TLBT_CMAP_SEGMENT_BITS  default is 6 (64 segments). between 1 and 16. more segments mean less contention between
+                        writers and fewer retries of readers
+TLBT_CMAP_CACHE_LINE    default is 64. segments are padded to it so writers don't invalidate their neighbours
+TLBT_CMAP_SPINS         default is 64. how often a reader spins while a write is in progress before yielding
+TLBT_CMAP_PAUSE         default is the pause instruction on x86 with GCC and clang and nothing otherwise
+
+=== memory ===
+memory is always managed by the implementation
+
+TLBT_MALLOC  default is malloc from <stdlib.h>
+TLBT_FREE    default is free from <stdlib.h>
+
+=== notes ===
+when omitting the TLBT_VALUE_T definition all types and functions have the prefix tlbt_cset_KEY instead of
+tlbt_cmap_KEY_VALUE
+
+readers of a segment spin (TLBT_CMAP_SPINS times, then sched_yield) while a writer of that segment is inside of
+insert, insert_or_assign or remove, so a writer which gets preempted there stalls them until it runs again. the
+write sections are a handful of stores, so this is short in practice. publishing every slot atomically instead
+would need keys and values which fit into an atomic, which TLBT_KEY_T and TLBT_VALUE_T don't have to, and would
+make every lookup pay for it
+
+readers copy keys and values with plain loads which can race with a writer of the same slot. such copies are
+always thrown away because the sequence counter changed, but the C11 memory model still calls it a data race and
+ThreadSanitizer reports it. a reader can therefore observe a key while it is being overwritten. it is passed to
+TLBT_EQUALS before being thrown away, which therefore mustn't crash on such keys. plain values and pointers which
+stay valid as long as the map are fine. 31 bits of the hash have to match before TLBT_EQUALS is called so this is
+rare
+
+unlike the single threaded map, insert fails if the key is already present. otherwise two threads inserting the same
+key would end up with two entries
+
+for usage examples please check the test files in the test directory
+*/
+
+#define TLBT_COMBINE(a, b) a##b
+#define TLBT_COMBINE2(a, b) TLBT_COMBINE(a, b)
+
+#ifndef TLBT_KEY_T
+#error "TLBT_KEY_T must be defined"
+#endif
+
+#ifndef TLBT_KEY_T_NAME
+#define TLBT_KEY_T_NAME TLBT_KEY_T
+#endif
+
+#ifndef TLBT_VALUE_T_NAME
+#define TLBT_VALUE_T_NAME TLBT_VALUE_T
+#endif
+
+#ifndef TLBT_MAX_LOAD_FACTOR
+#define TLBT_MAX_LOAD_FACTOR (0.70)
+#endif
+
+#ifndef TLBT_CMAP_SEGMENT_BITS
+#define TLBT_CMAP_SEGMENT_BITS 6
+#endif
+
+#if TLBT_CMAP_SEGMENT_BITS < 1 || TLBT_CMAP_SEGMENT_BITS > 16
+#error "TLBT_CMAP_SEGMENT_BITS has to be between 1 and 16"
+#endif
+
+#define TLBT_CMAP_SEGMENTS (1u << TLBT_CMAP_SEGMENT_BITS)
+
+#ifndef TLBT_CMAP_CACHE_LINE
+#define TLBT_CMAP_CACHE_LINE 64
+#endif
+
+#ifndef TLBT_CMAP_SPINS
+#define TLBT_CMAP_SPINS 64
+#endif
+
+#ifndef TLBT_CMAP_PAUSE
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define TLBT_CMAP_PAUSE() __builtin_ia32_pause()
+#else
+#define TLBT_CMAP_PAUSE() ((void)0)
+#endif
+#endif
+
+#ifndef TLBT_MALLOC
+#include <stdlib.h>
+#define TLBT_MALLOC malloc
+// memory is managed by this implementation so redefine free just in case
+#undef TLBT_FREE
+#define TLBT_FREE free
+#endif
+
+#ifndef TLBT_ASSERT
+#include <assert.h>
+#define TLBT_ASSERT assert
+#endif
+
+#ifndef TLBT_UINT32_T
+#include <stdint.h>
+#define TLBT_UINT32_T uint32_t
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+_Static_assert(sizeof(TLBT_UINT32_T) == 4, "TLBT_UINT32_T has to have 4 bytes");
+#endif
+
+#ifndef TLBT_SIZE_T
+#include <stddef.h>
+#define TLBT_SIZE_T size_t
+#endif
+
+#ifndef TLBT_MEMSET
+#include <string.h>
+#define TLBT_MEMSET memset
+#endif
+
+#ifdef TLBT_VALUE_T
+#define TLBT_CMAP_TYPE TLBT_COMBINE2(tlbt_cmap_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#else
+#define TLBT_CMAP_TYPE TLBT_COMBINE2(tlbt_cset_, TLBT_KEY_T_NAME)
+#endif
+
+#define TLBT_CMAP_SLOT_TYPE TLBT_COMBINE2(TLBT_CMAP_TYPE, TLBT_COMBINE2(_, slot))
+#define TLBT_CMAP_TABLE_TYPE TLBT_COMBINE2(TLBT_CMAP_TYPE, TLBT_COMBINE2(_, table))
+#define TLBT_CMAP_SEGMENT_TYPE TLBT_COMBINE2(TLBT_CMAP_TYPE, TLBT_COMBINE2(_, segment))
+#define TLBT_CMAP_FUNC(name) TLBT_COMBINE2(TLBT_CMAP_TYPE, TLBT_COMBINE2(_, name))
+#define TLBT_CMAP_FUNC_INTERNAL(name) TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_CMAP_TYPE, TLBT_COMBINE2(_, name)))
+
+// slot states. occupied slots keep the lower 31 bits of the hash with the highest bit set
+#define TLBT_CMAP_EMPTY ((TLBT_UINT32_T)0)
+#define TLBT_CMAP_DELETED ((TLBT_UINT32_T)1)
+#define TLBT_CMAP_TAG(hash) ((TLBT_UINT32_T)(hash) | ((TLBT_UINT32_T)1 << 31))
+#define TLBT_CMAP_IS_OCCUPIED(meta) (((meta) >> 31) != 0)
+
+#ifdef TLBT_STATIC
+#undef TLBT_DEFINITION
+#define TLBT_DEFINITION
+#undef TLBT_IMPLEMENTATION
+#define TLBT_IMPLEMENTATION
+#define TLBT_INLINE static inline
+#else
+#define TLBT_INLINE
+#endif
+
+#ifdef TLBT_DEFINITION
+
+#include <stdbool.h>
+#include <pthread.h>
+
+typedef struct TLBT_CMAP_SLOT_TYPE {
+  TLBT_UINT32_T meta; // empty, deleted or the tag of the hash. the only field readers access atomically
+  TLBT_KEY_T key;
+#ifdef TLBT_VALUE_T
+  TLBT_VALUE_T value;
+#endif
+} TLBT_CMAP_SLOT_TYPE;
+
+typedef struct TLBT_CMAP_TABLE_TYPE {
+  TLBT_SIZE_T capacity;                  // always a power of 2
+  struct TLBT_CMAP_TABLE_TYPE *previous; // the table this one replaced. freed on destroy
+  TLBT_CMAP_SLOT_TYPE slots[];
+} TLBT_CMAP_TABLE_TYPE;
+
+typedef struct TLBT_CMAP_SEGMENT_TYPE {
+  TLBT_CMAP_TABLE_TYPE *table;
+  TLBT_UINT32_T seq; // odd while a writer modifies the table
+  TLBT_SIZE_T count;
+  TLBT_SIZE_T deleted;
+  pthread_mutex_t lock;
+  char padding[TLBT_CMAP_CACHE_LINE];
+} TLBT_CMAP_SEGMENT_TYPE;
+
+typedef struct TLBT_CMAP_TYPE {
+  TLBT_CMAP_SEGMENT_TYPE segments[TLBT_CMAP_SEGMENTS];
+} TLBT_CMAP_TYPE;
+
+TLBT_INLINE void TLBT_CMAP_FUNC(create)(TLBT_CMAP_TYPE *const m, TLBT_SIZE_T capacity);
+TLBT_INLINE void TLBT_CMAP_FUNC(destroy)(TLBT_CMAP_TYPE *const m);
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                           TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_or_assign_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                     TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_CMAP_FUNC(get_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out, TLBT_UINT32_T hash);
+#else
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
+#endif
+TLBT_INLINE bool TLBT_CMAP_FUNC(remove_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_CMAP_FUNC(contains_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value);
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_or_assign)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value);
+TLBT_INLINE bool TLBT_CMAP_FUNC(get)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out);
+#else
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key);
+#endif
+TLBT_INLINE bool TLBT_CMAP_FUNC(remove)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key);
+TLBT_INLINE bool TLBT_CMAP_FUNC(contains)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key);
+
+TLBT_INLINE TLBT_SIZE_T TLBT_CMAP_FUNC(count)(TLBT_CMAP_TYPE *const m);
+
+#endif
+
+#ifdef TLBT_IMPLEMENTATION
+
+#include <sched.h>
+
+#if !defined(TLBT_HASH) && !defined(TLBT_HASH_REF)
+#error "TLBT_HASH or TLBT_HASH_REF must be defined"
+#endif
+
+#undef TLBT_HASH_FUNC
+#ifdef TLBT_HASH
+#define TLBT_HASH_FUNC(x) TLBT_HASH((x))
+#endif
+#ifdef TLBT_HASH_REF
+#define TLBT_HASH_FUNC(x) TLBT_HASH_REF(&(x))
+#endif
+
+#if !defined(TLBT_EQUALS) && !defined(TLBT_EQUALS_REF)
+#error "TLBT_EQUALS or TLBT_EQUALS_REF must be defined"
+#endif
+
+#undef TLBT_EQUALS_FUNC
+#ifdef TLBT_EQUALS
+#define TLBT_EQUALS_FUNC(a, b) TLBT_EQUALS((a), (b))
+#endif
+#ifdef TLBT_EQUALS_REF
+#define TLBT_EQUALS_FUNC(a, b) TLBT_EQUALS_REF(&(a), &(b))
+#endif
+
+static inline TLBT_CMAP_SEGMENT_TYPE *TLBT_CMAP_FUNC_INTERNAL(segment)(TLBT_CMAP_TYPE *const m, TLBT_UINT32_T hash) {
+  // the lower bits select the slot inside of the segment
+  return &m->segments[hash >> (32 - TLBT_CMAP_SEGMENT_BITS)];
+}
+
+static inline TLBT_CMAP_TABLE_TYPE *TLBT_CMAP_FUNC_INTERNAL(table_alloc)(TLBT_SIZE_T capacity) {
+  TLBT_CMAP_TABLE_TYPE *t =
+      (TLBT_CMAP_TABLE_TYPE *)TLBT_MALLOC(sizeof(TLBT_CMAP_TABLE_TYPE) + capacity * sizeof(TLBT_CMAP_SLOT_TYPE));
+  TLBT_ASSERT(t && "Failed to allocate memory for the concurrent map");
+  t->capacity = capacity;
+  t->previous = 0;
+  TLBT_MEMSET(t->slots, 0, capacity * sizeof(TLBT_CMAP_SLOT_TYPE));
+  return t;
+}
+
+static inline void TLBT_CMAP_FUNC_INTERNAL(backoff)(unsigned spins) {
+  if (spins < TLBT_CMAP_SPINS)
+    TLBT_CMAP_PAUSE();
+  else
+    sched_yield();
+}
+
+// readers retry as long as the counter is odd or changed while they were reading
+static inline void TLBT_CMAP_FUNC_INTERNAL(write_begin)(TLBT_CMAP_SEGMENT_TYPE *const s) {
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void TLBT_CMAP_FUNC_INTERNAL(write_end)(TLBT_CMAP_SEGMENT_TYPE *const s) {
+  __atomic_store_n(&s->seq, s->seq + 1, __ATOMIC_RELEASE);
+}
+
+// only called by the writer holding the lock. returns the slot of the key or the slot it should be inserted into
+static inline bool TLBT_CMAP_FUNC_INTERNAL(find_slot)(const TLBT_CMAP_TABLE_TYPE *const t, TLBT_KEY_T key,
+                                                      TLBT_UINT32_T hash, TLBT_SIZE_T *out_slot) {
+  const TLBT_UINT32_T tag = TLBT_CMAP_TAG(hash);
+  const TLBT_SIZE_T mask = t->capacity - 1;
+  TLBT_SIZE_T i = hash & mask;
+  TLBT_SIZE_T insert_at = t->capacity;
+  for (TLBT_SIZE_T n = 0; n < t->capacity; ++n, i = (i + 1) & mask) {
+    const TLBT_UINT32_T meta = t->slots[i].meta;
+    if (meta == TLBT_CMAP_EMPTY) {
+      *out_slot = insert_at != t->capacity ? insert_at : i;
+      return false;
+    }
+    if (meta == TLBT_CMAP_DELETED) {
+      if (insert_at == t->capacity)
+        insert_at = i;
+    } else if (meta == tag && TLBT_EQUALS_FUNC(t->slots[i].key, key)) {
+      *out_slot = i;
+      return true;
+    }
+  }
+  // the load factor guarantees an empty slot or a tombstone
+  *out_slot = insert_at;
+  return false;
+}
+
+// drops the tombstones of the table of a segment without replacing it. readers retry while the counter is odd and the
+// capacity stays the same, so they can't probe out of bounds in the meantime
+static inline void TLBT_CMAP_FUNC_INTERNAL(purge)(TLBT_CMAP_SEGMENT_TYPE *const s) {
+  TLBT_CMAP_TABLE_TYPE *const t = s->table;
+  const TLBT_SIZE_T mask = t->capacity - 1;
+  // no probe sequence crosses an empty slot, so walking from one moves every entry towards its home slot only
+  TLBT_SIZE_T start = 0;
+  while (t->slots[start].meta != TLBT_CMAP_EMPTY)
+    ++start;
+
+  TLBT_CMAP_FUNC_INTERNAL(write_begin)(s);
+  for (TLBT_SIZE_T i = 0; i < t->capacity; ++i) {
+    if (t->slots[i].meta == TLBT_CMAP_DELETED)
+      __atomic_store_n(&t->slots[i].meta, TLBT_CMAP_EMPTY, __ATOMIC_RELAXED);
+  }
+  for (TLBT_SIZE_T n = 1; n <= t->capacity; ++n) {
+    const TLBT_SIZE_T i = (start + n) & mask;
+    const TLBT_UINT32_T meta = t->slots[i].meta;
+    if (!TLBT_CMAP_IS_OCCUPIED(meta))
+      continue;
+    TLBT_SIZE_T j = meta & mask;
+    while (j != i && t->slots[j].meta != TLBT_CMAP_EMPTY)
+      j = (j + 1) & mask;
+    if (j != i) {
+      t->slots[j].key = t->slots[i].key;
+#ifdef TLBT_VALUE_T
+      t->slots[j].value = t->slots[i].value;
+#endif
+      __atomic_store_n(&t->slots[j].meta, meta, __ATOMIC_RELAXED);
+      __atomic_store_n(&t->slots[i].meta, TLBT_CMAP_EMPTY, __ATOMIC_RELAXED);
+    }
+  }
+  TLBT_CMAP_FUNC_INTERNAL(write_end)(s);
+  s->deleted = 0;
+}
+
+// replaces the table of a segment with one twice as big and without tombstones if the entries need the room and
+// purges it otherwise. readers still in the old table see a consistent state because nothing writes to it anymore
+static inline void TLBT_CMAP_FUNC_INTERNAL(grow)(TLBT_CMAP_SEGMENT_TYPE *const s) {
+  TLBT_CMAP_TABLE_TYPE *const old = s->table;
+  if ((float)(s->count + 1) <= (float)old->capacity * TLBT_MAX_LOAD_FACTOR / 2) {
+    TLBT_CMAP_FUNC_INTERNAL(purge)(s);
+    return;
+  }
+
+  const TLBT_SIZE_T capacity = old->capacity * 2;
+  TLBT_CMAP_TABLE_TYPE *const t = TLBT_CMAP_FUNC_INTERNAL(table_alloc)(capacity);
+  const TLBT_SIZE_T mask = capacity - 1;
+  for (TLBT_SIZE_T i = 0; i < old->capacity; ++i) {
+    const TLBT_UINT32_T meta = old->slots[i].meta;
+    if (!TLBT_CMAP_IS_OCCUPIED(meta))
+      continue;
+    // the tag has enough bits of the hash left to find the new slot without hashing again
+    TLBT_SIZE_T j = meta & mask;
+    while (t->slots[j].meta != TLBT_CMAP_EMPTY)
+      j = (j + 1) & mask;
+    t->slots[j] = old->slots[i];
+  }
+
+  t->previous = old;
+  __atomic_store_n(&s->table, t, __ATOMIC_RELEASE);
+  s->deleted = 0;
+}
+
+TLBT_INLINE void TLBT_CMAP_FUNC(create)(TLBT_CMAP_TYPE *const m, TLBT_SIZE_T capacity) {
+  const TLBT_SIZE_T per_segment = (TLBT_SIZE_T)((float)(capacity / TLBT_CMAP_SEGMENTS + 1) / TLBT_MAX_LOAD_FACTOR);
+  TLBT_SIZE_T segment_capacity = 8;
+  while (segment_capacity < per_segment)
+    segment_capacity *= 2;
+
+  for (TLBT_SIZE_T i = 0; i < TLBT_CMAP_SEGMENTS; ++i) {
+    TLBT_CMAP_SEGMENT_TYPE *const s = &m->segments[i];
+    s->table = TLBT_CMAP_FUNC_INTERNAL(table_alloc)(segment_capacity);
+    s->seq = 0;
+    s->count = 0;
+    s->deleted = 0;
+    pthread_mutex_init(&s->lock, 0);
+  }
+}
+
+TLBT_INLINE void TLBT_CMAP_FUNC(destroy)(TLBT_CMAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < TLBT_CMAP_SEGMENTS; ++i) {
+    TLBT_CMAP_SEGMENT_TYPE *const s = &m->segments[i];
+    TLBT_CMAP_TABLE_TYPE *t = s->table;
+    while (t) {
+      TLBT_CMAP_TABLE_TYPE *const previous = t->previous;
+      TLBT_FREE(t);
+      t = previous;
+    }
+    s->table = 0;
+    pthread_mutex_destroy(&s->lock);
+  }
+}
+
+// shared by insert and insert_or_assign. returns true if the key was inserted
+#ifdef TLBT_VALUE_T
+static inline bool TLBT_CMAP_FUNC_INTERNAL(upsert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                   TLBT_UINT32_T hash, bool assign) {
+#else
+static inline bool TLBT_CMAP_FUNC_INTERNAL(upsert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+#endif
+  TLBT_CMAP_SEGMENT_TYPE *const s = TLBT_CMAP_FUNC_INTERNAL(segment)(m, hash);
+  pthread_mutex_lock(&s->lock);
+
+  if ((float)(s->count + s->deleted + 1) > (float)s->table->capacity * TLBT_MAX_LOAD_FACTOR)
+    TLBT_CMAP_FUNC_INTERNAL(grow)(s);
+
+  TLBT_CMAP_TABLE_TYPE *const t = s->table;
+  TLBT_SIZE_T i = 0;
+  if (TLBT_CMAP_FUNC_INTERNAL(find_slot)(t, key, hash, &i)) {
+#ifdef TLBT_VALUE_T
+    if (assign) {
+      TLBT_CMAP_FUNC_INTERNAL(write_begin)(s);
+      t->slots[i].value = value;
+      TLBT_CMAP_FUNC_INTERNAL(write_end)(s);
+    }
+#endif
+    pthread_mutex_unlock(&s->lock);
+    return false;
+  }
+
+  TLBT_CMAP_FUNC_INTERNAL(write_begin)(s);
+  if (t->slots[i].meta == TLBT_CMAP_DELETED)
+    --s->deleted;
+  t->slots[i].key = key;
+#ifdef TLBT_VALUE_T
+  t->slots[i].value = value;
+#endif
+  __atomic_store_n(&t->slots[i].meta, TLBT_CMAP_TAG(hash), __ATOMIC_RELAXED);
+  TLBT_CMAP_FUNC_INTERNAL(write_end)(s);
+  __atomic_store_n(&s->count, s->count + 1, __ATOMIC_RELAXED);
+
+  pthread_mutex_unlock(&s->lock);
+  return true;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                           TLBT_UINT32_T hash) {
+  return TLBT_CMAP_FUNC_INTERNAL(upsert)(m, key, value, hash, false);
+}
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_or_assign_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                     TLBT_UINT32_T hash) {
+  return TLBT_CMAP_FUNC_INTERNAL(upsert)(m, key, value, hash, true);
+}
+#else
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+  return TLBT_CMAP_FUNC_INTERNAL(upsert)(m, key, hash);
+}
+#endif
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(remove_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+  TLBT_CMAP_SEGMENT_TYPE *const s = TLBT_CMAP_FUNC_INTERNAL(segment)(m, hash);
+  pthread_mutex_lock(&s->lock);
+
+  TLBT_CMAP_TABLE_TYPE *const t = s->table;
+  TLBT_SIZE_T i = 0;
+  const bool found = TLBT_CMAP_FUNC_INTERNAL(find_slot)(t, key, hash, &i);
+  if (found) {
+    // a tombstone keeps the probe sequences of the following entries intact for readers
+    TLBT_CMAP_FUNC_INTERNAL(write_begin)(s);
+    __atomic_store_n(&t->slots[i].meta, TLBT_CMAP_DELETED, __ATOMIC_RELAXED);
+    TLBT_CMAP_FUNC_INTERNAL(write_end)(s);
+    __atomic_store_n(&s->count, s->count - 1, __ATOMIC_RELAXED);
+    ++s->deleted;
+  }
+
+  pthread_mutex_unlock(&s->lock);
+  return found;
+}
+
+// optimistic lookup without the lock. copies the value out while probing and only trusts the copy if no writer
+// touched the segment. waits while a write to the segment is in progress, so it is not lock free
+#ifdef TLBT_VALUE_T
+static inline bool TLBT_CMAP_FUNC_INTERNAL(read)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                                 TLBT_UINT32_T hash) {
+#else
+static inline bool TLBT_CMAP_FUNC_INTERNAL(read)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+#endif
+  TLBT_CMAP_SEGMENT_TYPE *const s = TLBT_CMAP_FUNC_INTERNAL(segment)(m, hash);
+  const TLBT_UINT32_T tag = TLBT_CMAP_TAG(hash);
+
+  for (unsigned spins = 0;; ++spins) {
+    const TLBT_UINT32_T seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    if (seq & 1) {
+      TLBT_CMAP_FUNC_INTERNAL(backoff)(spins);
+      continue;
+    }
+
+    const TLBT_CMAP_TABLE_TYPE *const t = __atomic_load_n(&s->table, __ATOMIC_ACQUIRE);
+    const TLBT_SIZE_T mask = t->capacity - 1;
+    TLBT_SIZE_T i = hash & mask;
+    bool found = false;
+#ifdef TLBT_VALUE_T
+    TLBT_VALUE_T value;
+    TLBT_MEMSET(&value, 0, sizeof(value));
+#endif
+    // the capacity of a table never changes so the probe ends even if the slots change underneath
+    for (TLBT_SIZE_T n = 0; n < t->capacity; ++n, i = (i + 1) & mask) {
+      const TLBT_UINT32_T meta = __atomic_load_n(&t->slots[i].meta, __ATOMIC_RELAXED);
+      if (meta == TLBT_CMAP_EMPTY)
+        break;
+      if (meta != tag)
+        continue;
+      TLBT_KEY_T candidate = t->slots[i].key;
+      if (TLBT_EQUALS_FUNC(candidate, key)) {
+#ifdef TLBT_VALUE_T
+        value = t->slots[i].value;
+#endif
+        found = true;
+        break;
+      }
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq) {
+#ifdef TLBT_VALUE_T
+      if (found)
+        *out = value;
+#endif
+      return found;
+    }
+    TLBT_CMAP_FUNC_INTERNAL(backoff)(spins);
+  }
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CMAP_FUNC(get_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                        TLBT_UINT32_T hash) {
+  return TLBT_CMAP_FUNC_INTERNAL(read)(m, key, out, hash);
+}
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(contains_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+  TLBT_VALUE_T ignored;
+  return TLBT_CMAP_FUNC_INTERNAL(read)(m, key, &ignored, hash);
+}
+#else
+TLBT_INLINE bool TLBT_CMAP_FUNC(contains_ph)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+  return TLBT_CMAP_FUNC_INTERNAL(read)(m, key, hash);
+}
+#endif
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_CMAP_FUNC(insert_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert_or_assign)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_CMAP_FUNC(insert_or_assign_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(get)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out) {
+  return TLBT_CMAP_FUNC(get_ph)(m, key, out, TLBT_HASH_FUNC(key));
+}
+#else
+TLBT_INLINE bool TLBT_CMAP_FUNC(insert)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CMAP_FUNC(insert_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+#endif
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(remove)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CMAP_FUNC(remove_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CMAP_FUNC(contains)(TLBT_CMAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CMAP_FUNC(contains_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_CMAP_FUNC(count)(TLBT_CMAP_TYPE *const m) {
+  TLBT_SIZE_T count = 0;
+  for (TLBT_SIZE_T i = 0; i < TLBT_CMAP_SEGMENTS; ++i)
+    count += __atomic_load_n(&m->segments[i].count, __ATOMIC_RELAXED);
+  return count;
+}
+
+#endif
+
+#undef TLBT_ASSERT
+#undef TLBT_CMAP_CACHE_LINE
+#undef TLBT_CMAP_DELETED
+#undef TLBT_CMAP_EMPTY
+#undef TLBT_CMAP_FUNC
+#undef TLBT_CMAP_FUNC_INTERNAL
+#undef TLBT_CMAP_IS_OCCUPIED
+#undef TLBT_CMAP_PAUSE
+#undef TLBT_CMAP_SEGMENTS
+#undef TLBT_CMAP_SEGMENT_BITS
+#undef TLBT_CMAP_SEGMENT_TYPE
+#undef TLBT_CMAP_SLOT_TYPE
+#undef TLBT_CMAP_SPINS
+#undef TLBT_CMAP_TABLE_TYPE
+#undef TLBT_CMAP_TAG
+#undef TLBT_CMAP_TYPE
+#undef TLBT_COMBINE
+#undef TLBT_COMBINE2
+#undef TLBT_DEFINITION
+#undef TLBT_EQUALS
+#undef TLBT_EQUALS_FUNC
+#undef TLBT_EQUALS_REF
+#undef TLBT_FREE
+#undef TLBT_HASH
+#undef TLBT_HASH_FUNC
+#undef TLBT_HASH_REF
+#undef TLBT_IMPLEMENTATION
+#undef TLBT_INLINE
+#undef TLBT_KEY_T
+#undef TLBT_KEY_T_NAME
+#undef TLBT_MALLOC
+#undef TLBT_MAX_LOAD_FACTOR
+#undef TLBT_MEMSET
+#undef TLBT_SIZE_T
+#undef TLBT_STATIC
+#undef TLBT_UINT32_T
+#undef TLBT_VALUE_T
+#undef TLBT_VALUE_T_NAME
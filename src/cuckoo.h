@@ -0,0 +1,597 @@
+/*
+bucketized cuckoo hashmap. every key has exactly two candidate buckets of 4 slots, both derived from one 64 bit hash:
+- get, contains and remove look into at most two buckets (8 slots) no matter how full the map is. every slot keeps an
+  8 bit tag of the hash so most mismatching keys are rejected without TLBT_EQUALS
+- insert moves entries to their other bucket if both candidate buckets are full. the shortest chain of moves is
+  found with a breadth first search. the second bucket only depends on the first one and the tag (partial key cuckoo
+  hashing) so the search never hashes the keys it moves
+- maps stay fast at a load of 0.95 where linear probing has long degraded, so they need a lot less memory
+
+types:
+- tlbt_cuckoo_map_KEY_VALUE         map type KEY and VALUE depend on your definitions
+- tlbt_cuckoo_map_KEY_VALUE_bucket  4 slots with their tags, keys and values
+
+functions (_ph variants require you to provide the hash):
+- tlbt_cuckoo_map_KEY_VALUE_get(_ph)              tries retrieving the value with a key
+- tlbt_cuckoo_map_KEY_VALUE_contains(_ph)         checks if a value exists with its key
+- tlbt_cuckoo_map_KEY_VALUE_insert(_ph)           inserts the entry. false if the key already exists or the map is full
+- tlbt_cuckoo_map_KEY_VALUE_insert_or_assign(_ph) inserts the entry or overwrites the value of an existing key. false
+                                                  if the map is full
+- tlbt_cuckoo_map_KEY_VALUE_remove(_ph)           tries removing the entry with a key
+- tlbt_cuckoo_map_KEY_VALUE_clear                 resets the map
+if TLBT_DYNAMIC_MEMORY is not defined
+- tlbt_cuckoo_map_KEY_VALUE_init     initializes the map with a buffer of buckets (no allocations)
+if TLBT_DYNAMIC_MEMORY is defined
+- tlbt_cuckoo_map_KEY_VALUE_create   creates the map with room for at least capacity entries
+- tlbt_cuckoo_map_KEY_VALUE_destroy  destroys the map
+
+TLBT_DEFINITION      if you want to define the types and functions in a header file
+TLBT_IMPLEMENTATION  for the corresponding implementation of the definitions in a separate source file
+TLBT_STATIC          if you want to define and implement them statically in a source file
+
+=== required definitions ===
+TLBT_KEY_T                      the hashmap key type
+TLBT_HASH OR TLBT_HASH_REF      the function for hashing the key. has to return 64 bits which are well mixed in all
+                                bits (e.g. tlbt_hash_mix64 or tlbt_hash_bytes64 from hash.h)
+TLBT_EQUALS OR TLBT_EQUALS_REF  the function for checking key equality
+
+=== optional definitions ===
+TLBT_VALUE_T             the hashmap value type. when omitted it will be a hashset
+TLBT_KEY_T_NAME          default is TLBT_KEY_T
+TLBT_VALUE_T_NAME        default is TLBT_VALUE_T
+TLBT_ASSERT              default is assert from <assert.h>
+TLBT_MEMSET              default is memset from <string.h>
+TLBT_MAX_LOAD_FACTOR     float ]0,1[. default is 0.95. the map grows when it's reached or when no chain of moves
+                         frees a slot, which gets likely above 0.97
+TLBT_SIZE_T              default is size_t from <stddef.h>
+TLBT_UINT8_T             default is uint8_t from <stdint.h>
+TLBT_UINT64_T            default is uint64_t from <stdint.h>
+TLBT_CUCKOO_MAX_SEARCH   default is 512. how many buckets an insert visits at most looking for a free slot
+TLBT_PREFETCH            default is __builtin_prefetch with GCC and clang and nothing otherwise. lookups prefetch the
+                         second bucket while checking the first
+
+=== memory ===
+if TLBT_DYNAMIC_MEMORY is not defined, you have to provide the buckets to the init function. the number of buckets
+has to be a power of 2 and at least 2. resizing won't work
+if TLBT_DYNAMIC_MEMORY is defined, then memory is managed by the implementation and the map doubles when it's full
+
+TLBT_MALLOC  if TLBT_DYNAMIC_MEMORY is defined. default is malloc from <stdlib.h>
+TLBT_FREE    if TLBT_DYNAMIC_MEMORY is defined. default is free from <stdlib.h>
+
+=== notes ===
+when omitting the TLBT_VALUE_T definition all types and functions have the prefix tlbt_cuckoo_set_KEY instead of
+tlbt_cuckoo_map_KEY_VALUE
+
+unlike the linear probing map, insert fails if the key is already present. it has to look into both buckets anyway
+so deduplicating needs only one call
+
+at most 8 keys can share the same 64 bit hash. inserting more of them fails even with TLBT_DYNAMIC_MEMORY
+
+inserting moves other entries around. pointers into the map are invalidated by every insert
+
+for usage examples please check the test files in the test directory
+*/
+
+#define TLBT_COMBINE(a, b) a##b
+#define TLBT_COMBINE2(a, b) TLBT_COMBINE(a, b)
+
+#ifndef TLBT_KEY_T
+#error "TLBT_KEY_T must be defined"
+#endif
+
+#ifndef TLBT_KEY_T_NAME
+#define TLBT_KEY_T_NAME TLBT_KEY_T
+#endif
+
+#ifndef TLBT_VALUE_T_NAME
+#define TLBT_VALUE_T_NAME TLBT_VALUE_T
+#endif
+
+#ifndef TLBT_MAX_LOAD_FACTOR
+#define TLBT_MAX_LOAD_FACTOR (0.95)
+#endif
+
+#ifndef TLBT_CUCKOO_MAX_SEARCH
+#define TLBT_CUCKOO_MAX_SEARCH 512
+#endif
+
+#define TLBT_CUCKOO_SLOTS 4
+
+#ifndef TLBT_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define TLBT_PREFETCH(addr) __builtin_prefetch((addr))
+#else
+#define TLBT_PREFETCH(addr) ((void)(addr))
+#endif
+#endif
+
+#ifdef TLBT_DYNAMIC_MEMORY
+#ifndef TLBT_MALLOC
+#include <stdlib.h>
+#define TLBT_MALLOC malloc
+// memory is managed by this implementation so redefine free just in case
+#undef TLBT_FREE
+#define TLBT_FREE free
+#endif
+#endif
+
+#ifndef TLBT_ASSERT
+#include <assert.h>
+#define TLBT_ASSERT assert
+#endif
+
+#ifndef TLBT_UINT8_T
+#include <stdint.h>
+#define TLBT_UINT8_T uint8_t
+#endif
+
+#ifndef TLBT_UINT64_T
+#include <stdint.h>
+#define TLBT_UINT64_T uint64_t
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+_Static_assert(sizeof(TLBT_UINT64_T) == 8, "TLBT_UINT64_T has to have 8 bytes");
+#endif
+
+#ifndef TLBT_SIZE_T
+#include <stddef.h>
+#define TLBT_SIZE_T size_t
+#endif
+
+#ifndef TLBT_MEMSET
+#include <string.h>
+#define TLBT_MEMSET memset
+#endif
+
+#ifdef TLBT_VALUE_T
+#define TLBT_CUCKOO_TYPE                                                                                               \
+  TLBT_COMBINE2(tlbt_cuckoo_map_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#else
+#define TLBT_CUCKOO_TYPE TLBT_COMBINE2(tlbt_cuckoo_set_, TLBT_KEY_T_NAME)
+#endif
+
+#define TLBT_CUCKOO_BUCKET_TYPE TLBT_COMBINE2(TLBT_CUCKOO_TYPE, TLBT_COMBINE2(_, bucket))
+#define TLBT_CUCKOO_NODE_TYPE TLBT_COMBINE2(TLBT_CUCKOO_TYPE, TLBT_COMBINE2(_, node))
+#define TLBT_CUCKOO_FUNC(name) TLBT_COMBINE2(TLBT_CUCKOO_TYPE, TLBT_COMBINE2(_, name))
+#define TLBT_CUCKOO_FUNC_INTERNAL(name) TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_CUCKOO_TYPE, TLBT_COMBINE2(_, name)))
+
+#ifdef TLBT_STATIC
+#undef TLBT_DEFINITION
+#define TLBT_DEFINITION
+#undef TLBT_IMPLEMENTATION
+#define TLBT_IMPLEMENTATION
+#define TLBT_INLINE static inline
+#else
+#define TLBT_INLINE
+#endif
+
+#ifdef TLBT_DEFINITION
+
+#include <stdbool.h>
+
+typedef struct TLBT_CUCKOO_BUCKET_TYPE {
+  TLBT_UINT8_T tags[TLBT_CUCKOO_SLOTS]; // 0 for empty slots. occupied ones keep the upper 8 bits of the hash
+  TLBT_KEY_T keys[TLBT_CUCKOO_SLOTS];
+#ifdef TLBT_VALUE_T
+  TLBT_VALUE_T values[TLBT_CUCKOO_SLOTS];
+#endif
+} TLBT_CUCKOO_BUCKET_TYPE;
+
+typedef struct TLBT_CUCKOO_TYPE {
+  TLBT_CUCKOO_BUCKET_TYPE *buckets;
+  TLBT_SIZE_T bucket_count; // always a power of 2
+  TLBT_SIZE_T count;
+} TLBT_CUCKOO_TYPE;
+
+#ifdef TLBT_DYNAMIC_MEMORY
+TLBT_INLINE void TLBT_CUCKOO_FUNC(create)(TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T capacity);
+TLBT_INLINE void TLBT_CUCKOO_FUNC(destroy)(TLBT_CUCKOO_TYPE *const m);
+#else
+TLBT_INLINE void TLBT_CUCKOO_FUNC(init)(TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T bucket_count,
+                                        TLBT_CUCKOO_BUCKET_TYPE *bucket_buffer);
+#endif
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                             TLBT_UINT64_T hash);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_or_assign_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                       TLBT_UINT64_T hash);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(get_ph)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                          TLBT_UINT64_T hash);
+#else
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash);
+#endif
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(remove_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(contains_ph)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash);
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_or_assign)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(get)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out);
+#else
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key);
+#endif
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(remove)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key);
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(contains)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key);
+
+TLBT_INLINE void TLBT_CUCKOO_FUNC(clear)(TLBT_CUCKOO_TYPE *const m);
+
+#endif
+
+#ifdef TLBT_IMPLEMENTATION
+
+#if !defined(TLBT_HASH) && !defined(TLBT_HASH_REF)
+#error "TLBT_HASH or TLBT_HASH_REF must be defined"
+#endif
+
+#undef TLBT_HASH_FUNC
+#ifdef TLBT_HASH
+#define TLBT_HASH_FUNC(x) TLBT_HASH((x))
+#endif
+#ifdef TLBT_HASH_REF
+#define TLBT_HASH_FUNC(x) TLBT_HASH_REF(&(x))
+#endif
+
+#if !defined(TLBT_EQUALS) && !defined(TLBT_EQUALS_REF)
+#error "TLBT_EQUALS or TLBT_EQUALS_REF must be defined"
+#endif
+
+#undef TLBT_EQUALS_FUNC
+#ifdef TLBT_EQUALS
+#define TLBT_EQUALS_FUNC(a, b) TLBT_EQUALS((a), (b))
+#endif
+#ifdef TLBT_EQUALS_REF
+#define TLBT_EQUALS_FUNC(a, b) TLBT_EQUALS_REF(&(a), &(b))
+#endif
+
+// a bucket of the breadth first search and the move which leads to it: the entry in `slot` of the parent bucket has
+// this bucket as its other candidate
+typedef struct TLBT_CUCKOO_NODE_TYPE {
+  TLBT_SIZE_T bucket;
+  int parent; // -1 for the two candidate buckets of the new key
+  int slot;
+} TLBT_CUCKOO_NODE_TYPE;
+
+// the upper 8 bits are the tag. 0 marks empty slots so it's replaced with 1
+static inline TLBT_UINT8_T TLBT_CUCKOO_FUNC_INTERNAL(tag)(TLBT_UINT64_T hash) {
+  const TLBT_UINT8_T tag = (TLBT_UINT8_T)(hash >> 56);
+  return tag ? tag : 1;
+}
+
+// the lower bits select the first bucket
+static inline TLBT_SIZE_T TLBT_CUCKOO_FUNC_INTERNAL(first)(const TLBT_CUCKOO_TYPE *const m, TLBT_UINT64_T hash) {
+  return (TLBT_SIZE_T)hash & (m->bucket_count - 1);
+}
+
+// xor with a distance derived from the tag. applied to either bucket it yields the other one
+static inline TLBT_SIZE_T TLBT_CUCKOO_FUNC_INTERNAL(other)(const TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T bucket,
+                                                           TLBT_UINT8_T tag) {
+  const TLBT_SIZE_T distance = (TLBT_SIZE_T)(tag * 0xC6A4A7935BD1E995ULL) & (m->bucket_count - 1);
+  return bucket ^ (distance ? distance : 1);
+}
+
+static inline TLBT_SIZE_T TLBT_CUCKOO_FUNC_INTERNAL(second)(const TLBT_CUCKOO_TYPE *const m, TLBT_UINT64_T hash) {
+  return TLBT_CUCKOO_FUNC_INTERNAL(other)(m, TLBT_CUCKOO_FUNC_INTERNAL(first)(m, hash),
+                                          TLBT_CUCKOO_FUNC_INTERNAL(tag)(hash));
+}
+
+static inline int TLBT_CUCKOO_FUNC_INTERNAL(find_in)(const TLBT_CUCKOO_BUCKET_TYPE *const b, TLBT_KEY_T key,
+                                                     TLBT_UINT8_T tag) {
+  for (int s = 0; s < TLBT_CUCKOO_SLOTS; ++s) {
+    if (b->tags[s] == tag && TLBT_EQUALS_FUNC(b->keys[s], key))
+      return s;
+  }
+  return -1;
+}
+
+static inline int TLBT_CUCKOO_FUNC_INTERNAL(free_slot)(const TLBT_CUCKOO_BUCKET_TYPE *const b) {
+  for (int s = 0; s < TLBT_CUCKOO_SLOTS; ++s) {
+    if (b->tags[s] == 0)
+      return s;
+  }
+  return -1;
+}
+
+// returns the bucket of the key or NULL and writes its slot
+static inline TLBT_CUCKOO_BUCKET_TYPE *TLBT_CUCKOO_FUNC_INTERNAL(find)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key,
+                                                                      TLBT_UINT64_T hash, int *out_slot) {
+  const TLBT_UINT8_T tag = TLBT_CUCKOO_FUNC_INTERNAL(tag)(hash);
+  TLBT_CUCKOO_BUCKET_TYPE *const first = &m->buckets[TLBT_CUCKOO_FUNC_INTERNAL(first)(m, hash)];
+  TLBT_CUCKOO_BUCKET_TYPE *const second = &m->buckets[TLBT_CUCKOO_FUNC_INTERNAL(second)(m, hash)];
+  // both loads are independent so the second cache miss overlaps with the first one
+  TLBT_PREFETCH(second);
+  if ((*out_slot = TLBT_CUCKOO_FUNC_INTERNAL(find_in)(first, key, tag)) >= 0)
+    return first;
+  if ((*out_slot = TLBT_CUCKOO_FUNC_INTERNAL(find_in)(second, key, tag)) >= 0)
+    return second;
+  return 0;
+}
+
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(on_path)(const TLBT_CUCKOO_NODE_TYPE *nodes, int node,
+                                                      TLBT_SIZE_T bucket) {
+  for (; node >= 0; node = nodes[node].parent) {
+    if (nodes[node].bucket == bucket)
+      return true;
+  }
+  return false;
+}
+
+// places a key which isn't in the map yet. if both buckets are full, a breadth first search looks for the shortest
+// chain of entries which can each move to their other bucket and ends in a bucket with a free slot. a bucket never
+// appears twice on a chain, so every moved entry is still the one the search looked at. false if there is none
+#ifdef TLBT_VALUE_T
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(place)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                    TLBT_UINT64_T hash) {
+#else
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(place)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash) {
+#endif
+  TLBT_CUCKOO_NODE_TYPE nodes[TLBT_CUCKOO_MAX_SEARCH];
+  nodes[0] = (TLBT_CUCKOO_NODE_TYPE){TLBT_CUCKOO_FUNC_INTERNAL(first)(m, hash), -1, 0};
+  nodes[1] = (TLBT_CUCKOO_NODE_TYPE){TLBT_CUCKOO_FUNC_INTERNAL(second)(m, hash), -1, 0};
+  int tail = 2;
+
+  for (int head = 0; head < tail; ++head) {
+    TLBT_CUCKOO_BUCKET_TYPE *const b = &m->buckets[nodes[head].bucket];
+    int free_slot = TLBT_CUCKOO_FUNC_INTERNAL(free_slot)(b);
+    if (free_slot >= 0) {
+      // moves the entries along the chain, starting with the one next to the free slot
+      TLBT_CUCKOO_BUCKET_TYPE *to = b;
+      for (int node = head; nodes[node].parent >= 0; node = nodes[node].parent) {
+        TLBT_CUCKOO_BUCKET_TYPE *const from = &m->buckets[nodes[nodes[node].parent].bucket];
+        const int slot = nodes[node].slot;
+        to->tags[free_slot] = from->tags[slot];
+        to->keys[free_slot] = from->keys[slot];
+#ifdef TLBT_VALUE_T
+        to->values[free_slot] = from->values[slot];
+#endif
+        to = from;
+        free_slot = slot;
+      }
+      to->tags[free_slot] = TLBT_CUCKOO_FUNC_INTERNAL(tag)(hash);
+      to->keys[free_slot] = key;
+#ifdef TLBT_VALUE_T
+      to->values[free_slot] = value;
+#endif
+      return true;
+    }
+
+    for (int s = 0; s < TLBT_CUCKOO_SLOTS && tail < TLBT_CUCKOO_MAX_SEARCH; ++s) {
+      const TLBT_SIZE_T other = TLBT_CUCKOO_FUNC_INTERNAL(other)(m, nodes[head].bucket, b->tags[s]);
+      if (!TLBT_CUCKOO_FUNC_INTERNAL(on_path)(nodes, head, other))
+        nodes[tail++] = (TLBT_CUCKOO_NODE_TYPE){other, head, s};
+    }
+  }
+  return false;
+}
+
+#ifdef TLBT_DYNAMIC_MEMORY
+
+static inline void TLBT_CUCKOO_FUNC_INTERNAL(alloc)(TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T bucket_count) {
+  m->buckets = (TLBT_CUCKOO_BUCKET_TYPE *)TLBT_MALLOC(sizeof(TLBT_CUCKOO_BUCKET_TYPE) * bucket_count);
+  TLBT_ASSERT(m->buckets && "Failed to allocate memory for the cuckoo map");
+  TLBT_MEMSET(m->buckets, 0, sizeof(TLBT_CUCKOO_BUCKET_TYPE) * bucket_count);
+  m->bucket_count = bucket_count;
+  m->count = 0;
+}
+
+TLBT_INLINE void TLBT_CUCKOO_FUNC(create)(TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T capacity) {
+  TLBT_SIZE_T bucket_count = 2;
+  while ((float)bucket_count * TLBT_CUCKOO_SLOTS * TLBT_MAX_LOAD_FACTOR < (float)capacity)
+    bucket_count *= 2;
+  TLBT_CUCKOO_FUNC_INTERNAL(alloc)(m, bucket_count);
+}
+
+TLBT_INLINE void TLBT_CUCKOO_FUNC(destroy)(TLBT_CUCKOO_TYPE *const m) {
+  TLBT_FREE(m->buckets);
+  m->buckets = 0;
+  m->bucket_count = 0;
+  m->count = 0;
+}
+
+// keys with the same hash always get the same two buckets. once they fill both of them no table is big enough
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(saturated)(const TLBT_CUCKOO_TYPE *const m, TLBT_UINT64_T hash) {
+  const TLBT_CUCKOO_BUCKET_TYPE *const first = &m->buckets[TLBT_CUCKOO_FUNC_INTERNAL(first)(m, hash)];
+  const TLBT_CUCKOO_BUCKET_TYPE *const second = &m->buckets[TLBT_CUCKOO_FUNC_INTERNAL(second)(m, hash)];
+  for (int s = 0; s < TLBT_CUCKOO_SLOTS; ++s) {
+    if (first->tags[s] == 0 || second->tags[s] == 0 || TLBT_HASH_FUNC(first->keys[s]) != hash ||
+        TLBT_HASH_FUNC(second->keys[s]) != hash)
+      return false;
+  }
+  return true;
+}
+
+// moves every entry into a table with twice the buckets. in the unlikely case that they don't fit it doubles again
+static inline void TLBT_CUCKOO_FUNC_INTERNAL(grow)(TLBT_CUCKOO_TYPE *const m) {
+  TLBT_SIZE_T bucket_count = m->bucket_count * 2;
+  for (;;) {
+    TLBT_CUCKOO_TYPE n;
+    TLBT_CUCKOO_FUNC_INTERNAL(alloc)(&n, bucket_count);
+    bool placed = true;
+    for (TLBT_SIZE_T i = 0; i < m->bucket_count && placed; ++i) {
+      const TLBT_CUCKOO_BUCKET_TYPE *const b = &m->buckets[i];
+      for (int s = 0; s < TLBT_CUCKOO_SLOTS && placed; ++s) {
+        if (b->tags[s] == 0)
+          continue;
+#ifdef TLBT_VALUE_T
+        placed = TLBT_CUCKOO_FUNC_INTERNAL(place)(&n, b->keys[s], b->values[s], TLBT_HASH_FUNC(b->keys[s]));
+#else
+        placed = TLBT_CUCKOO_FUNC_INTERNAL(place)(&n, b->keys[s], TLBT_HASH_FUNC(b->keys[s]));
+#endif
+      }
+    }
+    if (placed) {
+      n.count = m->count;
+      TLBT_FREE(m->buckets);
+      *m = n;
+      return;
+    }
+    TLBT_FREE(n.buckets);
+    bucket_count *= 2;
+  }
+}
+
+#else
+
+TLBT_INLINE void TLBT_CUCKOO_FUNC(init)(TLBT_CUCKOO_TYPE *const m, TLBT_SIZE_T bucket_count,
+                                        TLBT_CUCKOO_BUCKET_TYPE *bucket_buffer) {
+  TLBT_ASSERT(bucket_count >= 2 && (bucket_count & (bucket_count - 1)) == 0);
+  m->buckets = bucket_buffer;
+  m->bucket_count = bucket_count;
+  m->count = 0;
+  TLBT_MEMSET(m->buckets, 0, sizeof(TLBT_CUCKOO_BUCKET_TYPE) * bucket_count);
+}
+
+#endif
+
+// the key must not be in the map yet
+#ifdef TLBT_VALUE_T
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(add)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                  TLBT_UINT64_T hash) {
+#else
+static inline bool TLBT_CUCKOO_FUNC_INTERNAL(add)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash) {
+#endif
+#ifdef TLBT_DYNAMIC_MEMORY
+  if ((float)(m->count + 1) > (float)m->bucket_count * TLBT_CUCKOO_SLOTS * TLBT_MAX_LOAD_FACTOR)
+    TLBT_CUCKOO_FUNC_INTERNAL(grow)(m);
+#ifdef TLBT_VALUE_T
+  while (!TLBT_CUCKOO_FUNC_INTERNAL(place)(m, key, value, hash)) {
+#else
+  while (!TLBT_CUCKOO_FUNC_INTERNAL(place)(m, key, hash)) {
+#endif
+    if (TLBT_CUCKOO_FUNC_INTERNAL(saturated)(m, hash))
+      return false;
+    TLBT_CUCKOO_FUNC_INTERNAL(grow)(m);
+  }
+#else
+  if ((float)(m->count + 1) > (float)m->bucket_count * TLBT_CUCKOO_SLOTS * TLBT_MAX_LOAD_FACTOR)
+    return false;
+#ifdef TLBT_VALUE_T
+  if (!TLBT_CUCKOO_FUNC_INTERNAL(place)(m, key, value, hash))
+#else
+  if (!TLBT_CUCKOO_FUNC_INTERNAL(place)(m, key, hash))
+#endif
+    return false;
+#endif
+  ++m->count;
+  return true;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                             TLBT_UINT64_T hash) {
+  int slot = 0;
+  if (TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot))
+    return false;
+  return TLBT_CUCKOO_FUNC_INTERNAL(add)(m, key, value, hash);
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_or_assign_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                       TLBT_UINT64_T hash) {
+  int slot = 0;
+  TLBT_CUCKOO_BUCKET_TYPE *const b = TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot);
+  if (b) {
+    b->values[slot] = value;
+    return true;
+  }
+  return TLBT_CUCKOO_FUNC_INTERNAL(add)(m, key, value, hash);
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(get_ph)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                          TLBT_UINT64_T hash) {
+  int slot = 0;
+  const TLBT_CUCKOO_BUCKET_TYPE *const b = TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot);
+  if (!b)
+    return false;
+  *out = b->values[slot];
+  return true;
+}
+#else
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash) {
+  int slot = 0;
+  if (TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot))
+    return false;
+  return TLBT_CUCKOO_FUNC_INTERNAL(add)(m, key, hash);
+}
+#endif
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(remove_ph)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash) {
+  int slot = 0;
+  TLBT_CUCKOO_BUCKET_TYPE *const b = TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot);
+  if (!b)
+    return false;
+  b->tags[slot] = 0;
+  --m->count;
+  return true;
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(contains_ph)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_UINT64_T hash) {
+  int slot = 0;
+  return TLBT_CUCKOO_FUNC_INTERNAL(find)(m, key, hash, &slot) != 0;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_CUCKOO_FUNC(insert_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert_or_assign)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_CUCKOO_FUNC(insert_or_assign_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(get)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out) {
+  return TLBT_CUCKOO_FUNC(get_ph)(m, key, out, TLBT_HASH_FUNC(key));
+}
+#else
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(insert)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CUCKOO_FUNC(insert_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+#endif
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(remove)(TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CUCKOO_FUNC(remove_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_CUCKOO_FUNC(contains)(const TLBT_CUCKOO_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_CUCKOO_FUNC(contains_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE void TLBT_CUCKOO_FUNC(clear)(TLBT_CUCKOO_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->bucket_count; ++i)
+    TLBT_MEMSET(m->buckets[i].tags, 0, sizeof(m->buckets[i].tags));
+  m->count = 0;
+}
+
+#endif
+
+#undef TLBT_ASSERT
+#undef TLBT_COMBINE
+#undef TLBT_COMBINE2
+#undef TLBT_CUCKOO_BUCKET_TYPE
+#undef TLBT_CUCKOO_FUNC
+#undef TLBT_CUCKOO_FUNC_INTERNAL
+#undef TLBT_CUCKOO_MAX_SEARCH
+#undef TLBT_CUCKOO_NODE_TYPE
+#undef TLBT_CUCKOO_SLOTS
+#undef TLBT_CUCKOO_TYPE
+#undef TLBT_DEFINITION
+#undef TLBT_DYNAMIC_MEMORY
+#undef TLBT_EQUALS
+#undef TLBT_EQUALS_FUNC
+#undef TLBT_EQUALS_REF
+#undef TLBT_FREE
+#undef TLBT_HASH
+#undef TLBT_HASH_FUNC
+#undef TLBT_HASH_REF
+#undef TLBT_IMPLEMENTATION
+#undef TLBT_INLINE
+#undef TLBT_KEY_T
+#undef TLBT_KEY_T_NAME
+#undef TLBT_MALLOC
+#undef TLBT_MAX_LOAD_FACTOR
+#undef TLBT_MEMSET
+#undef TLBT_PREFETCH
+#undef TLBT_SIZE_T
+#undef TLBT_STATIC
+#undef TLBT_UINT64_T
+#undef TLBT_UINT8_T
+#undef TLBT_VALUE_T
+#undef TLBT_VALUE_T_NAME
@@ -44,6 +44,8 @@ TLBT_T_NAME            default is TLBT_T
 TLBT_ASSERT            default is assert from <assert.h>
 TLBT_MEMCPY            default is memcpy from <string.h>
 TLBT_BASE2_CAPACITY    will use bit operations instead of modulo
+TLBT_FAST_RANGE        wraps indices with a compare and subtract instead of modulo. `at` requires the index to be
+                       smaller than the capacity then. no effect with TLBT_BASE2_CAPACITY
 TLBT_SIZE_T            default is size_t from <stddef.h>
 TLBT_NO_SORT           don't define a sort function. this makes the TLBT_COMPARE/_REF definitions unrequired
 TLBT_DEQUE_NO_ITERATOR don't define an iterator struct and functions
@@ -73,7 +75,14 @@ TLBT_FREE    if TLBT_DYNAMIC_MEMORY is defined. default is free from <stdlib.h>
 #define TLBT_MOD(a, b) ((a) % (b))
 #endif
 
+#if defined(TLBT_FAST_RANGE) && !defined(TLBT_BASE2_CAPACITY)
+// both wrap only by less than one capacity
+#define TLBT_DEQUE_INC_WRAP(n, s) ((n) + 1 == (s) ? 0 : (n) + 1)
+#define TLBT_DEQUE_WRAP(n, s) ((n) < (s) ? (n) : (n) - (s))
+#else
 #define TLBT_DEQUE_INC_WRAP(n, s) (TLBT_MOD(((n) + 1), (s)))
+#define TLBT_DEQUE_WRAP(n, s) (TLBT_MOD((n), (s)))
+#endif
 #define TLBT_DEQUE_DEC_WRAP(n, s) ((n) == 0 ? (s) - 1 : (n) - 1)
 
 #ifdef TLBT_DYNAMIC_MEMORY
@@ -339,7 +348,7 @@ TLBT_INLINE TLBT_T *TLBT_DEQUE_FUNC(peek_back)(TLBT_DEQUE_TYPE *const d) {
 }
 
 TLBT_INLINE TLBT_T *TLBT_DEQUE_FUNC(at)(TLBT_DEQUE_TYPE *const d, const TLBT_SIZE_T index) {
-  return d->count == 0 ? NULL : &d->data[TLBT_MOD(d->head + index, d->capacity)];
+  return d->count == 0 ? NULL : &d->data[TLBT_DEQUE_WRAP(d->head + index, d->capacity)];
 }
 
 #ifndef TLBT_NO_SORT
@@ -468,7 +477,9 @@ TLBT_INLINE bool TLBT_DEQUE_FUNC(copy)(TLBT_DEQUE_TYPE *const dest, const TLBT_D
 #undef TLBT_DEQUE_ITERATOR_TYPE
 #undef TLBT_DEQUE_NO_ITERATOR
 #undef TLBT_DEQUE_TYPE
+#undef TLBT_DEQUE_WRAP
 #undef TLBT_DYNAMIC_MEMORY
+#undef TLBT_FAST_RANGE
 #undef TLBT_FREE
 #undef TLBT_IMPLEMENTATION
 #undef TLBT_INLINE
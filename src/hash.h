@@ -0,0 +1,197 @@
+/*
+hash functions meant for TLBT_HASH of the hashmap. the results spread well over all bits which matters for
+TLBT_BASE2_CAPACITY because only the lower bits select the slot. hashes are not portable across endianness
+
+functions:
+- tlbt_hash_mix32     murmur3 finalizer. bijective 32 bit mixer
+- tlbt_hash_mix64     variant 13 of the murmur3 finalizer (splitmix64). bijective 64 bit mixer
+- tlbt_hash_u32       hashes a 32 bit integer
+- tlbt_hash_u64       hashes a 64 bit integer down to 32 bits
+- tlbt_hash_ptr       hashes a pointer
+- tlbt_hash_bytes64   hashes a buffer 8 bytes at a time (xxh64)
+- tlbt_hash_bytes     tlbt_hash_bytes64 folded to 32 bits with seed 0
+- tlbt_hash_string    tlbt_hash_bytes of a null terminated string
+- tlbt_hash_crc32     hashes a buffer with the crc32 instruction. faster than tlbt_hash_bytes on most machines. same
+                      as tlbt_hash_bytes if SSE4.2 isn't available or TLBT_HASH_NO_SSE42 is defined
+
+ready-made macros for the hashmap, e.g. #define TLBT_HASH(x) TLBT_HASH_U32(x)
+- TLBT_HASH_U32(x)   any integer of up to 32 bits
+- TLBT_HASH_U64(x)   any integer of up to 64 bits
+- TLBT_HASH_PTR(x)   pointers
+- TLBT_HASH_CSTR(x)  null terminated strings
+
+=== optional definitions ===
+TLBT_HASH_NO_SSE42  don't use the crc32 instruction even if it is available
+*/
+
+#ifndef TLBT_HASH_H
+#define TLBT_HASH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if !defined(TLBT_HASH_NO_SSE42) && defined(__SSE4_2__) && (defined(__x86_64__) || defined(_M_X64))
+#include <nmmintrin.h>
+#define TLBT_HASH_SSE42
+#endif
+
+#define TLBT_HASH_U32(x) tlbt_hash_u32((uint32_t)(x))
+#define TLBT_HASH_U64(x) tlbt_hash_u64((uint64_t)(x))
+#define TLBT_HASH_PTR(x) tlbt_hash_ptr((const void *)(x))
+#define TLBT_HASH_CSTR(x) tlbt_hash_string((x))
+
+#define TLBT_XXH_PRIME1 0x9E3779B185EBCA87ULL
+#define TLBT_XXH_PRIME2 0xC2B2AE3D27D4EB4FULL
+#define TLBT_XXH_PRIME3 0x165667B19E3779F9ULL
+#define TLBT_XXH_PRIME4 0x85EBCA77C2B2AE63ULL
+#define TLBT_XXH_PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint32_t tlbt_hash_mix32(uint32_t x) {
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35U;
+  x ^= x >> 16;
+  return x;
+}
+
+static inline uint64_t tlbt_hash_mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return x;
+}
+
+static inline uint32_t tlbt_hash_u32(uint32_t x) {
+  return tlbt_hash_mix32(x);
+}
+
+static inline uint32_t tlbt_hash_u64(uint64_t x) {
+  const uint64_t h = tlbt_hash_mix64(x);
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+static inline uint32_t tlbt_hash_ptr(const void *p) {
+  return tlbt_hash_u64((uint64_t)(uintptr_t)p);
+}
+
+// unaligned loads. memcpy compiles to a single mov on every relevant compiler
+static inline uint64_t tlbt_hash_read64(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t tlbt_hash_read32(const unsigned char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t tlbt_hash_rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t tlbt_hash_xxh_round(uint64_t acc, uint64_t input) {
+  acc += input * TLBT_XXH_PRIME2;
+  acc = tlbt_hash_rotl64(acc, 31);
+  return acc * TLBT_XXH_PRIME1;
+}
+
+static inline uint64_t tlbt_hash_xxh_merge(uint64_t acc, uint64_t lane) {
+  acc ^= tlbt_hash_xxh_round(0, lane);
+  return acc * TLBT_XXH_PRIME1 + TLBT_XXH_PRIME4;
+}
+
+static inline uint64_t tlbt_hash_bytes64(const void *data, size_t len, uint64_t seed) {
+  const unsigned char *p = (const unsigned char *)data;
+  const unsigned char *const end = p + len;
+  uint64_t h;
+
+  if (len >= 32) {
+    // four independent lanes keep the multipliers busy
+    uint64_t v1 = seed + TLBT_XXH_PRIME1 + TLBT_XXH_PRIME2;
+    uint64_t v2 = seed + TLBT_XXH_PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - TLBT_XXH_PRIME1;
+    const unsigned char *const limit = end - 32;
+    do {
+      v1 = tlbt_hash_xxh_round(v1, tlbt_hash_read64(p));
+      v2 = tlbt_hash_xxh_round(v2, tlbt_hash_read64(p + 8));
+      v3 = tlbt_hash_xxh_round(v3, tlbt_hash_read64(p + 16));
+      v4 = tlbt_hash_xxh_round(v4, tlbt_hash_read64(p + 24));
+      p += 32;
+    } while (p <= limit);
+    h = tlbt_hash_rotl64(v1, 1) + tlbt_hash_rotl64(v2, 7) + tlbt_hash_rotl64(v3, 12) + tlbt_hash_rotl64(v4, 18);
+    h = tlbt_hash_xxh_merge(h, v1);
+    h = tlbt_hash_xxh_merge(h, v2);
+    h = tlbt_hash_xxh_merge(h, v3);
+    h = tlbt_hash_xxh_merge(h, v4);
+  } else {
+    h = seed + TLBT_XXH_PRIME5;
+  }
+  h += (uint64_t)len;
+
+  for (; end - p >= 8; p += 8) {
+    h ^= tlbt_hash_xxh_round(0, tlbt_hash_read64(p));
+    h = tlbt_hash_rotl64(h, 27) * TLBT_XXH_PRIME1 + TLBT_XXH_PRIME4;
+  }
+  if (end - p >= 4) {
+    h ^= (uint64_t)tlbt_hash_read32(p) * TLBT_XXH_PRIME1;
+    h = tlbt_hash_rotl64(h, 23) * TLBT_XXH_PRIME2 + TLBT_XXH_PRIME3;
+    p += 4;
+  }
+  for (; p < end; ++p) {
+    h ^= (uint64_t)(*p) * TLBT_XXH_PRIME5;
+    h = tlbt_hash_rotl64(h, 11) * TLBT_XXH_PRIME1;
+  }
+
+  h ^= h >> 33;
+  h *= TLBT_XXH_PRIME2;
+  h ^= h >> 29;
+  h *= TLBT_XXH_PRIME3;
+  h ^= h >> 32;
+  return h;
+}
+
+static inline uint32_t tlbt_hash_bytes(const void *data, size_t len) {
+  const uint64_t h = tlbt_hash_bytes64(data, len, 0);
+  return (uint32_t)(h ^ (h >> 32));
+}
+
+static inline uint32_t tlbt_hash_string(const char *str) {
+  return tlbt_hash_bytes(str, strlen(str));
+}
+
+static inline uint32_t tlbt_hash_crc32(const void *data, size_t len) {
+#ifdef TLBT_HASH_SSE42
+  const unsigned char *p = (const unsigned char *)data;
+  uint64_t crc = 0xFFFFFFFFu;
+  for (; len >= 8; len -= 8, p += 8)
+    crc = _mm_crc32_u64(crc, tlbt_hash_read64(p));
+  uint32_t crc32 = (uint32_t)crc;
+  if (len >= 4) {
+    crc32 = _mm_crc32_u32(crc32, tlbt_hash_read32(p));
+    len -= 4;
+    p += 4;
+  }
+  for (; len > 0; --len, ++p)
+    crc32 = _mm_crc32_u8(crc32, *p);
+  // crc is linear and leaves the upper bits badly mixed for short keys. the finalizer fixes that
+  return tlbt_hash_mix32(crc32);
+#else
+  return tlbt_hash_bytes(data, len);
+#endif
+}
+
+#undef TLBT_HASH_SSE42
+#undef TLBT_XXH_PRIME1
+#undef TLBT_XXH_PRIME2
+#undef TLBT_XXH_PRIME3
+#undef TLBT_XXH_PRIME4
+#undef TLBT_XXH_PRIME5
+
+#endif
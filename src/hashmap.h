@@ -3,14 +3,43 @@ types:
 - tlbt_map_KEY_VALUE           map type KEY and VALUE depend on your definitions
 - tlbt_map_KEY_VALUE_key       key type wrapping KEY type. required for open addressing collision resolution
 - tlbt_map_iterator_KEY_VALUE  iterator type
+- tlbt_map_frozen_KEY_VALUE    immutable map built by freeze. only with TLBT_MAP_FREEZE
+- tlbt_map_KEY_VALUE_visitor   callback of for_each. receives the key, the value and the userdata. returning false stops
+- tlbt_map_stats_KEY_VALUE     filled in by stats
+- tlbt_map_sharded_KEY_VALUE   one private map per thread and partition for aggregating. only with TLBT_MAP_SHARDED
+- tlbt_map_KEY_VALUE_combine   callback of the sharded map. folds a value into the value of the same key
+- tlbt_map_rcu_KEY_VALUE       published snapshots of a read-mostly map. only with TLBT_MAP_RCU
 
 functions (_ph variants require you to provide the hash):
 - tlbt_map_KEY_VALUE_get(_ph)             tries retrieving the value with a key
 - tlbt_map_KEY_VALUE_remove(_ph)          tries removing the entry with a key
 - tlbt_map_KEY_VALUE_insert(_ph)          tries inserting the entry with key and value
 - tlbt_map_KEY_VALUE_contains(_ph)        checks if a value exists with its key
-- tlbt_map_KEY_VALUE_clear                resets the map
+- tlbt_map_KEY_VALUE_clear                resets the map. O(1) with TLBT_MAP_EPOCH
 - tlbt_map_KEY_VALUE_copy                 tries copying the entries from one map to another
+- tlbt_map_KEY_VALUE_rehash               purges deleted slots in place without allocating
+- tlbt_map_KEY_VALUE_get_batch(_ph)       looks up an array of keys and returns how many were found. the home slots of
+                                          upcoming keys are prefetched while resolving the current ones
+- tlbt_map_KEY_VALUE_contains_batch(_ph)  same as get_batch but only checks for existence
+- tlbt_map_KEY_VALUE_insert_many(_ph)     inserts arrays of keys and values and returns how many were inserted. grows
+                                          the map once for all of them and prefetches like get_batch. stops once a
+                                          map without TLBT_DYNAMIC_MEMORY is full
+- tlbt_map_KEY_VALUE_get_or_insert(_ph)   returns a pointer to the value of a key, inserting the key if it's missing.
+                                          the value of a new key is uninitialized. NULL if the map is full.
+                                          the pointer is valid until the map gets modified
+- tlbt_map_KEY_VALUE_insert_or_assign(_ph) inserts the entry or overwrites the value of an existing key
+- tlbt_map_KEY_VALUE_for_each             calls the visitor for every entry in slot order without an iterator. the
+                                          visitor may modify values but must not insert or remove
+- tlbt_map_KEY_VALUE_stats                counts tombstones and probe lengths of every entry. reads every slot
+- tlbt_set_KEY_union_into                 clears out and fills it with the keys of a and b. out must be another set
+- tlbt_set_KEY_intersect_into             clears out and fills it with the keys which are in both a and b
+- tlbt_set_KEY_difference_into            clears out and fills it with the keys of a which aren't in b
+- tlbt_set_KEY_intersection_count         counts the keys which are in both a and b
+                                          the set functions only exist without TLBT_VALUE_T. they walk the smaller set
+                                          (a for the difference) in chunks, reuse its stored hashes with
+                                          TLBT_MAP_STORE_HASH and prefetch like the batch functions. with
+                                          TLBT_DYNAMIC_MEMORY out is grown once to the biggest possible result,
+                                          otherwise they return false once out is full
 - tlbt_map_iterator_KEY_VALUE_init        initializes the iterator
 - tlbt_map_iterator_KEY_VALUE_reset       resets the iterator
 - tlbt_map_iterator_KEY_VALUE_iterate     iterates the map and returns a copy
@@ -20,8 +49,55 @@ if TLBT_DYNAMIC_MEMORY is not defined
 if TLBT_DYNAMIC_MEMORY is defined
 - tlbt_map_KEY_VALUE_create           creates the map type (with allocations)
 - tlbt_map_KEY_VALUE_destroy          destroys the map type (with deallocations)
-- tlbt_map_KEY_VALUE_adjust_capacity  basically reallocates to the new capacity. downsizing doesn't work yet
+- tlbt_map_KEY_VALUE_adjust_capacity  basically reallocates to the new capacity. has to be bigger than the count
 - tlbt_map_KEY_VALUE_ensure_capacity  checks if adjusting is necessary and resizes by factor 2 if it is
+- tlbt_map_KEY_VALUE_reserve          grows to the smallest capacity which holds n entries without resizing (the next
+                                      power of 2 with TLBT_BASE2_CAPACITY). never shrinks
+- tlbt_map_KEY_VALUE_shrink_to_fit    shrinks to the smallest capacity which is at most half full. if that isn't at
+                                      least half of the current capacity it only rehashes in place
+if TLBT_MAP_PARALLEL_BUILD is defined
+- tlbt_map_KEY_VALUE_build_parallel   same as insert_many but splits the work between the calling thread and
+                                      threads - 1 new ones. no other thread may use the map in the meantime
+if TLBT_MAP_SHARDED is defined
+- tlbt_map_sharded_KEY_VALUE_create     creates a map for threads * partitions private shards
+- tlbt_map_sharded_KEY_VALUE_destroy    destroys all shards
+- tlbt_map_sharded_KEY_VALUE_add(_ph)   adds the entry to the shard of the thread and the partition of the key. an
+                                        existing value of the key is combined with it. each thread only ever passes
+                                        its own index, so no locks are needed
+- tlbt_map_sharded_KEY_VALUE_merge      combines the shards of every partition into one map on all threads. no
+                                        thread may add in the meantime. afterwards the shards of the other threads
+                                        are empty and adding can continue on top of the merged maps
+- tlbt_map_sharded_KEY_VALUE_partition  the merged map of a partition. use it to iterate over the result
+- tlbt_map_sharded_KEY_VALUE_get(_ph)   tries retrieving the merged value with a key
+if TLBT_MAP_RCU is defined (reader is the index of the calling reader thread, writer functions must not run at the
+same time)
+- tlbt_map_rcu_KEY_VALUE_create         creates an empty snapshot and room for readers reader threads
+- tlbt_map_rcu_KEY_VALUE_destroy        destroys all snapshots. no reader may be reading anymore
+- tlbt_map_rcu_KEY_VALUE_read_begin     returns the current snapshot. it stays valid until read_end, no matter how
+                                        often the writer publishes in the meantime. it must not be modified
+- tlbt_map_rcu_KEY_VALUE_read_end       marks the reader as done with its snapshot
+- tlbt_map_rcu_KEY_VALUE_get(_ph)       read_begin, get on the snapshot and read_end
+- tlbt_map_rcu_KEY_VALUE_contains(_ph)  read_begin, contains on the snapshot and read_end
+- tlbt_map_rcu_KEY_VALUE_prepare        returns a new empty map with the capacity of the current snapshot for the
+                                        writer to fill
+- tlbt_map_rcu_KEY_VALUE_prepare_copy   same as prepare but with a copy of the entries of the current snapshot
+- tlbt_map_rcu_KEY_VALUE_publish        makes a prepared map the current snapshot. the replaced one is freed once no
+                                        reader can use it anymore
+- tlbt_map_rcu_KEY_VALUE_reclaim        frees the replaced snapshots no reader uses anymore without waiting. returns
+                                        how many are left. publish calls it as well
+- tlbt_map_rcu_KEY_VALUE_synchronize    waits until every replaced snapshot could be freed
+if TLBT_MAP_FREEZE is defined
+- tlbt_map_KEY_VALUE_freeze               builds an immutable copy of the map with a minimal perfect hash function
+                                          (CHD). every slot holds an entry and a lookup reads exactly one slot.
+                                          false if no perfect hash function was found, which is extremely unlikely
+- tlbt_map_frozen_KEY_VALUE_get(_ph)      tries retrieving the value with a key
+- tlbt_map_frozen_KEY_VALUE_contains(_ph) checks if a value exists with its key
+- tlbt_map_frozen_KEY_VALUE_destroy       frees the frozen map
+if TLBT_MAP_SERIALIZE is defined
+- tlbt_map_KEY_VALUE_save                 writes the map to a file. finishes a resize in progress first
+- tlbt_map_KEY_VALUE_view                 uses a saved map in place (e.g. mmapped) without copying or rehashing.
+                                          false if it wasn't saved with the same layout and hash version
+- tlbt_map_KEY_VALUE_load                 reads a saved map into new allocations. only with TLBT_DYNAMIC_MEMORY
 
 TLBT_DEFINITION      if you want to define the types and functions in a header file
 TLBT_IMPLEMENTATION  for the corresponding implementation of the definitions in a separate source file
@@ -39,18 +115,120 @@ TLBT_VALUE_T_NAME      default is TLBT_VALUE_T
 TLBT_ASSERT            default is assert from <assert.h>
 TLBT_MEMSET            default is memset from <string.h>
 TLBT_BASE2_CAPACITY    will use bit operations instead of modulo
+TLBT_FAST_RANGE        for capacities which aren't a power of 2. maps hashes onto slots with a multiplication and a
+                       shift (hash * capacity >> 32) instead of modulo and wraps probe positions with a compare and
+                       subtract, so no division is left in lookups. the slot depends on the upper bits of the hash,
+                       which therefore have to be well mixed (not the identity of small integers). TLBT_MAP_LARGE
+                       requires 128 bit integers (__int128). no effect with TLBT_BASE2_CAPACITY
 TLBT_MAX_LOAD_FACTOR   float ]0,1[, lower means less time spent on collision resolution but more space wasted.
                        default is 0.7
 TLBT_SIZE_T            default is size_t from <stddef.h>
 TLBT_UINT32_T          default is uint32_t from <stdint.h>
+TLBT_UINT64_T          default is uint64_t from <stdint.h>. only used with TLBT_MAP_LARGE, TLBT_MAP_FREEZE,
+                       TLBT_MAP_SERIALIZE, TLBT_MAP_OCCUPANCY_BITMAP, TLBT_MAP_COUNTERS, TLBT_MAP_INTEGER_KEY,
+                       TLBT_FAST_RANGE, TLBT_MAP_SHARDED, TLBT_MAP_RCU and TLBT_MAP_SIMD_PROBE without SSE2
 TLBT_MAP_NO_ITERATOR   don't define an iterator struct and functions
+TLBT_MAP_LARGE         64 bit hashes and slot metadata for tables beyond 2^30 slots. TLBT_HASH and the hashes passed to
+                       the _ph functions have to be 64 bit wide and should be well mixed in all bits
+                       (e.g. tlbt_hash_mix64 or tlbt_hash_bytes64 from hash.h)
+TLBT_MAP_SIMD_PROBE    keeps the slot states in a separate array of control bytes (empty/deleted or 7 bits of the hash)
+                       and probes 16 slots at once. most mismatching keys are rejected without TLBT_EQUALS
+TLBT_MAP_NO_SSE2       use the portable SWAR fallback for TLBT_MAP_SIMD_PROBE even if SSE2 is available
+TLBT_UINT8_T           default is uint8_t from <stdint.h>. only used with TLBT_MAP_SIMD_PROBE
+TLBT_MAP_ROBIN_HOOD    robin hood insertion. the probe distance is stored in the index field so lookups can stop
+                       early and removing shifts the following entries back instead of leaving tombstones behind.
+                       can't be combined with TLBT_MAP_SIMD_PROBE
+TLBT_MAP_STORE_HASH    stores the full hash next to every key. resizing reuses it instead of hashing again and keys
+                       are only compared with TLBT_EQUALS if the hashes match
+TLBT_MAP_INCREMENTAL_RESIZE  only with TLBT_DYNAMIC_MEMORY. growing keeps the old table alive and moves
+                       TLBT_MAP_MIGRATE_STEP slots of it into the new table on every insert, get, contains and remove.
+                       lookups check both tables until the migration is done, which bounds the worst case latency.
+                       while a migration is in progress all of these calls invalidate iterators
+TLBT_MAP_MIGRATE_STEP  default is 16. has to be at least 2 to finish migrating before the new table has to grow again
+TLBT_MAP_AUTO_SHRINK   only with TLBT_DYNAMIC_MEMORY. removing shrinks like shrink_to_fit once the load drops below
+                       TLBT_MIN_LOAD_FACTOR but never only rehashes in place
+TLBT_MIN_LOAD_FACTOR   default is TLBT_MAX_LOAD_FACTOR / 4. together with shrinking to at most half the max load factor
+                       this keeps a map from shrinking and growing back and forth
+TLBT_MAP_MIN_CAPACITY  default is 16. shrinking never goes below it. has to be a power of 2 with TLBT_BASE2_CAPACITY
+TLBT_PREFETCH          default is __builtin_prefetch with GCC and clang and nothing otherwise
+TLBT_MAP_PREFETCH_DISTANCE  default is 8. how many keys the batch functions prefetch ahead. the further the memory,
+                       the higher it should be
+TLBT_MAP_BATCH_CHUNK   default is 64. the batch functions without precomputed hashes hash this many keys at once
+TLBT_MAP_FREEZE        only with TLBT_DYNAMIC_MEMORY. defines the frozen map type and the freeze function. meant for
+                       maps which are built once and only read afterwards. keys which share their full hash with
+                       another key can't be told apart by any hash function and end up in a small overflow area after
+                       the slots. with n keys and 32 bit hashes that are about n^2 / 2^33 keys. it is sorted and only
+                       searched by keys which share their hash with the key in their slot
+TLBT_MAP_FREEZE_BUCKET_SIZE  default is 3. average number of keys sharing one 4 byte seed of the perfect hash function.
+                       bigger buckets need less memory but take longer to freeze
+TLBT_MAP_SERIALIZE     defines save, view and load. only for keys and values which don't point to other memory. the
+                       file holds a header and the raw arrays in native byte order, each aligned to 64 bytes
+TLBT_MAP_HASH_VERSION  default is 0. stored in saved maps. change it whenever TLBT_HASH changes so old files get
+                       rejected instead of being probed with different hashes
+TLBT_MAP_OCCUPANCY_BITMAP  only with TLBT_DYNAMIC_MEMORY. keeps one bit per slot for whether it holds an entry, so
+                       iterating and for_each skip 64 free slots at a time. costs 1 bit per slot and a write to it on
+                       every insert and remove. worth it for maps which got big once and are mostly empty now
+TLBT_MAP_EPOCH         clear only bumps a generation of the map instead of resetting every slot. the slots keep the
+                       generation they were written in, in the otherwise unused lower bits of their index, and slots
+                       of an older generation count as empty. every 2^30 clears (2^62 with TLBT_MAP_LARGE) the
+                       generation wraps around and clear resets the slots once. can't be combined with
+                       TLBT_MAP_SIMD_PROBE and TLBT_MAP_ROBIN_HOOD which have no spare bits in their slot metadata
+TLBT_MAP_LAYOUT_INTERLEAVED  stores every value next to its key and slot metadata instead of in a separate array,
+                       so a lookup hit touches one cache line instead of two. good for small values. big values spread
+                       the keys out and make every probe step more expensive, so misses get slower
+TLBT_MAP_STATS_BUCKETS default is 16. size of the probe length histogram of stats. the last bucket also counts every
+                       longer probe length
+TLBT_MAP_PARALLEL_BUILD  only with TLBT_DYNAMIC_MEMORY and pthreads. defines build_parallel. the table is split into
+                       one region per thread and every thread inserts the keys whose home slot is in its region.
+                       keys which would probe past the end of their region are inserted afterwards by the calling
+                       thread. can't be combined with TLBT_MAP_SIMD_PROBE and TLBT_MAP_ROBIN_HOOD whose inserts
+                       write outside of the probed slots
+TLBT_MAP_SHARDED       only with TLBT_VALUE_T, TLBT_DYNAMIC_MEMORY and pthreads. defines the sharded map for
+                       aggregating (e.g. counting words) on many threads. every thread adds to private maps and merge
+                       combines them per partition, so there is no contention even on hot keys. the partition of a
+                       key is taken from its hash mixed once more, so the keys of a partition still use all slots
+TLBT_MAP_RCU           only with TLBT_DYNAMIC_MEMORY, GCC or clang (__atomic builtins). defines the rcu map for
+                       read-mostly maps with a single writer. readers look up keys in a published snapshot without a
+                       lock, the writer fills a new map and publishes it with an atomic swap. every reader announces
+                       the epoch it started reading in, and replaced snapshots are freed once no reader is still in
+                       an epoch they were published in. a lookup costs a plain get and one store and one fence of
+                       announcing, which read_begin and read_end can share between many lookups. can't be combined
+                       with TLBT_MAP_INCREMENTAL_RESIZE and TLBT_MAP_COUNTERS whose lookups write to the map
+TLBT_MAP_INTEGER_KEY   for integer keys. two key values mark empty and deleted slots instead of the index field, which
+                       halves the slots of 4 byte keys. TLBT_HASH and TLBT_EQUALS become optional and default to a
+                       built-in integer mixer and ==. the sentinel keys can't be inserted. can't be combined with
+                       TLBT_MAP_SIMD_PROBE, TLBT_MAP_ROBIN_HOOD and TLBT_MAP_EPOCH which need the index field or have
+                       their own slot states
+TLBT_MAP_EMPTY_KEY     default is (TLBT_KEY_T)-1. the key of empty slots with TLBT_MAP_INTEGER_KEY. saved maps don't
+                       record it, so change TLBT_MAP_HASH_VERSION along with it
+TLBT_MAP_DELETED_KEY   default is (TLBT_KEY_T)-2. the key of deleted slots with TLBT_MAP_INTEGER_KEY
+TLBT_MAP_COUNTERS      adds a counters member to the map which counts probed slots (groups with TLBT_MAP_SIMD_PROBE),
+                       TLBT_EQUALS calls, resizes including rehashing in place and the bytes of entries moved by them.
+                       without it nothing is counted. the counters are never reset, only read them
 
 === memory ===
 if TLBT_DYNAMIC_MEMORY is not defined, you have to provide the buffers to the init function. resizing won't work
 if TLBT_DYNAMIC_MEMORY is defined, then memory is managed by the implementation
+if TLBT_MAP_SIMD_PROBE is defined, the init function also requires a control byte buffer with capacity + 16 bytes
+if TLBT_MAP_LAYOUT_INTERLEAVED is defined, the values are part of the key buffer and init takes no value buffer
 
 TLBT_MALLOC  if TLBT_DYNAMIC_MEMORY is defined. default is malloc from <stdlib.h>
 TLBT_FREE    if TLBT_DYNAMIC_MEMORY is defined. default is free from <stdlib.h>
+TLBT_CALLOC  if TLBT_DYNAMIC_MEMORY is defined. default is calloc from <stdlib.h> unless TLBT_MALLOC is defined. used
+             for the slots whenever zeroed memory is what an empty table looks like, which is everything except
+             TLBT_MAP_SIMD_PROBE and sentinel keys other than 0. calloc can hand out fresh pages of the OS which are
+             zeroed lazily, so creating a big table doesn't touch all of its memory up front. without it the slots
+             are allocated with TLBT_MALLOC and then cleared
+TLBT_MAP_MMAP              allocates the arrays of tables with at least TLBT_MAP_MMAP_THRESHOLD bytes with an anonymous
+                           mmap instead. their pages are only committed once they get written to. requires
+                           <sys/mman.h> and MAP_ANONYMOUS (e.g. _DEFAULT_SOURCE with -std=c99 and glibc)
+TLBT_MAP_MMAP_THRESHOLD    default is 2 MiB
+TLBT_MAP_HUGE_PAGES        advises transparent huge pages for the mmapped arrays where MADV_HUGEPAGE exists. fewer
+                           TLB misses for lookups in big tables but memory gets committed 2 MiB at a time
+
+a viewed map points into the buffer given to view and doesn't own it. modifying it requires writable memory (e.g.
+MAP_PRIVATE for copy on write) and the count is only written back by save. with TLBT_DYNAMIC_MEMORY it must only be
+read because growing or destroying it would free the buffer
 
 === notes ===
 when omitting the TLBT_VALUE_T definition all types and functions have the prefix tlbt_set_KEY instead of
@@ -82,10 +260,156 @@ for usage examples please check the test files in the test directory
 #define TLBT_MOD(a, b) ((a) % (b))
 #endif
 
+// TLBT_MAP_HOME maps a hash onto its home slot. TLBT_MAP_WRAP wraps slot indices below twice the capacity
+#if defined(TLBT_FAST_RANGE) && !defined(TLBT_BASE2_CAPACITY)
+#ifdef TLBT_MAP_LARGE
+#ifndef __SIZEOF_INT128__
+#error "TLBT_FAST_RANGE with TLBT_MAP_LARGE requires 128 bit integers"
+#endif
+#define TLBT_MAP_HOME(hash, capacity) ((TLBT_SIZE_T)(((unsigned __int128)(hash) * (capacity)) >> 64))
+#else
+#define TLBT_MAP_HOME(hash, capacity) ((TLBT_SIZE_T)(((TLBT_UINT64_T)(hash) * (TLBT_UINT64_T)(capacity)) >> 32))
+#endif
+#define TLBT_MAP_WRAP(i, capacity) ((i) < (capacity) ? (i) : (i) - (capacity))
+#else
+#define TLBT_MAP_HOME(hash, capacity) TLBT_MOD(hash, capacity)
+#define TLBT_MAP_WRAP(i, capacity) TLBT_MOD(i, capacity)
+#endif
+
 #ifndef TLBT_MAX_LOAD_FACTOR
 #define TLBT_MAX_LOAD_FACTOR (0.70)
 #endif
 
+#if defined(TLBT_MAP_ROBIN_HOOD) && defined(TLBT_MAP_SIMD_PROBE)
+#error "TLBT_MAP_ROBIN_HOOD can't be combined with TLBT_MAP_SIMD_PROBE"
+#endif
+
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_INCREMENTAL_RESIZE requires TLBT_DYNAMIC_MEMORY"
+#endif
+#ifndef TLBT_MAP_MIGRATE_STEP
+#define TLBT_MAP_MIGRATE_STEP 16
+#endif
+#endif
+
+#ifdef TLBT_MAP_AUTO_SHRINK
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_AUTO_SHRINK requires TLBT_DYNAMIC_MEMORY"
+#endif
+#ifndef TLBT_MIN_LOAD_FACTOR
+#define TLBT_MIN_LOAD_FACTOR (TLBT_MAX_LOAD_FACTOR / 4)
+#endif
+#endif
+
+#ifndef TLBT_MAP_MIN_CAPACITY
+#define TLBT_MAP_MIN_CAPACITY 16
+#endif
+
+#ifndef TLBT_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define TLBT_PREFETCH(addr) __builtin_prefetch((addr))
+#else
+#define TLBT_PREFETCH(addr) ((void)(addr))
+#endif
+#endif
+
+#ifndef TLBT_MAP_PREFETCH_DISTANCE
+#define TLBT_MAP_PREFETCH_DISTANCE 8
+#endif
+
+#ifndef TLBT_MAP_BATCH_CHUNK
+#define TLBT_MAP_BATCH_CHUNK 64
+#endif
+
+#ifdef TLBT_MAP_FREEZE
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_FREEZE requires TLBT_DYNAMIC_MEMORY"
+#endif
+#ifndef TLBT_MAP_FREEZE_BUCKET_SIZE
+#define TLBT_MAP_FREEZE_BUCKET_SIZE 3
+#endif
+#endif
+
+#if defined(TLBT_MAP_EPOCH) && (defined(TLBT_MAP_SIMD_PROBE) || defined(TLBT_MAP_ROBIN_HOOD))
+#error "TLBT_MAP_EPOCH can't be combined with TLBT_MAP_SIMD_PROBE or TLBT_MAP_ROBIN_HOOD"
+#endif
+
+#ifdef TLBT_MAP_INTEGER_KEY
+#if defined(TLBT_MAP_SIMD_PROBE) || defined(TLBT_MAP_ROBIN_HOOD) || defined(TLBT_MAP_EPOCH)
+#error "TLBT_MAP_INTEGER_KEY can't be combined with TLBT_MAP_SIMD_PROBE, TLBT_MAP_ROBIN_HOOD or TLBT_MAP_EPOCH"
+#endif
+#ifndef TLBT_MAP_EMPTY_KEY
+#define TLBT_MAP_EMPTY_KEY ((TLBT_KEY_T)-1)
+#endif
+#ifndef TLBT_MAP_DELETED_KEY
+#define TLBT_MAP_DELETED_KEY ((TLBT_KEY_T)-2)
+#endif
+#endif
+
+#if defined(TLBT_MAP_OCCUPANCY_BITMAP) && !defined(TLBT_DYNAMIC_MEMORY)
+#error "TLBT_MAP_OCCUPANCY_BITMAP requires TLBT_DYNAMIC_MEMORY"
+#endif
+
+#ifdef TLBT_MAP_MMAP
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_MMAP requires TLBT_DYNAMIC_MEMORY"
+#endif
+#include <sys/mman.h>
+#ifndef TLBT_MAP_MMAP_THRESHOLD
+#define TLBT_MAP_MMAP_THRESHOLD ((TLBT_SIZE_T)2 << 20)
+#endif
+#endif
+
+#ifdef TLBT_MAP_PARALLEL_BUILD
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_PARALLEL_BUILD requires TLBT_DYNAMIC_MEMORY"
+#endif
+#if defined(TLBT_MAP_SIMD_PROBE) || defined(TLBT_MAP_ROBIN_HOOD)
+#error "TLBT_MAP_PARALLEL_BUILD can't be combined with TLBT_MAP_SIMD_PROBE or TLBT_MAP_ROBIN_HOOD"
+#endif
+#include <pthread.h>
+#endif
+
+#ifdef TLBT_MAP_SHARDED
+#if !defined(TLBT_DYNAMIC_MEMORY) || !defined(TLBT_VALUE_T)
+#error "TLBT_MAP_SHARDED requires TLBT_DYNAMIC_MEMORY and TLBT_VALUE_T"
+#endif
+#include <pthread.h>
+#endif
+
+#ifdef TLBT_MAP_RCU
+#ifndef TLBT_DYNAMIC_MEMORY
+#error "TLBT_MAP_RCU requires TLBT_DYNAMIC_MEMORY"
+#endif
+#if defined(TLBT_MAP_INCREMENTAL_RESIZE) || defined(TLBT_MAP_COUNTERS)
+#error "TLBT_MAP_RCU can't be combined with TLBT_MAP_INCREMENTAL_RESIZE or TLBT_MAP_COUNTERS"
+#endif
+#include <sched.h>
+#endif
+
+#ifndef TLBT_MAP_STATS_BUCKETS
+#define TLBT_MAP_STATS_BUCKETS 16
+#endif
+
+#ifdef TLBT_MAP_SERIALIZE
+#include <stdio.h>
+#ifndef TLBT_MAP_HASH_VERSION
+#define TLBT_MAP_HASH_VERSION 0
+#endif
+#endif
+
+// values live in their own array unless they are interleaved with the keys
+#if defined(TLBT_VALUE_T) && !defined(TLBT_MAP_LAYOUT_INTERLEAVED)
+#define TLBT_MAP_SPLIT_VALUES
+#endif
+
+#ifdef TLBT_MAP_SPLIT_VALUES
+#define TLBT_MAP_VALUE(m, i) ((m)->values[(i)])
+#else
+#define TLBT_MAP_VALUE(m, i) ((m)->keys[(i)].value)
+#endif
+
 #ifdef TLBT_DYNAMIC_MEMORY
 #ifndef TLBT_MALLOC
 #include <stdlib.h>
@@ -93,6 +417,8 @@ for usage examples please check the test files in the test directory
 // memory is managed by this implementation so redefine free just in case
 #undef TLBT_FREE
 #define TLBT_FREE free
+#undef TLBT_CALLOC
+#define TLBT_CALLOC calloc
 #endif
 // if malloc is defined but free is not, then do nothing because it's in the
 // responsibility of the user. it could be an arena allocator
@@ -112,6 +438,25 @@ for usage examples please check the test files in the test directory
 _Static_assert(sizeof(TLBT_UINT32_T) == 4, "TLBT_UINT32_T has to have 4 bytes");
 #endif
 
+#if defined(TLBT_MAP_LARGE) || defined(TLBT_MAP_FREEZE) || defined(TLBT_MAP_SERIALIZE) ||                              \
+    defined(TLBT_MAP_OCCUPANCY_BITMAP) || defined(TLBT_MAP_COUNTERS) || defined(TLBT_MAP_INTEGER_KEY) ||               \
+    defined(TLBT_FAST_RANGE) || defined(TLBT_MAP_SHARDED) || defined(TLBT_MAP_RCU) || defined(TLBT_MAP_SIMD_PROBE)
+#ifndef TLBT_UINT64_T
+#include <stdint.h>
+#define TLBT_UINT64_T uint64_t
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)
+_Static_assert(sizeof(TLBT_UINT64_T) == 8, "TLBT_UINT64_T has to have 8 bytes");
+#endif
+#endif
+
+#ifdef TLBT_MAP_LARGE
+#define TLBT_MAP_HASH_T TLBT_UINT64_T
+#define TLBT_MAP_INDEX_T TLBT_UINT64_T
+#else
+#define TLBT_MAP_HASH_T TLBT_UINT32_T
+#define TLBT_MAP_INDEX_T TLBT_UINT32_T
+#endif
+
 #ifndef TLBT_SIZE_T
 #include <stddef.h>
 #define TLBT_SIZE_T size_t
@@ -144,12 +489,144 @@ _Static_assert(sizeof(TLBT_UINT32_T) == 4, "TLBT_UINT32_T has to have 4 bytes");
 #define TLBT_MAP_ITERATOR_FUNC(name) TLBT_COMBINE2(TLBT_MAP_ITERATOR_TYPE, TLBT_COMBINE2(_, name))
 #endif
 
-#define TLBT_OCCUPIED_BIT (1U << 31)
-#define TLBT_DELETED_BIT (1U << 30)
+#ifdef TLBT_VALUE_T
+#define TLBT_MAP_STATS_TYPE                                                                                            \
+  TLBT_COMBINE2(tlbt_map_stats_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#else
+#define TLBT_MAP_STATS_TYPE TLBT_COMBINE2(tlbt_set_stats_, TLBT_KEY_T_NAME)
+#endif
+
+#ifdef TLBT_MAP_FREEZE
+#ifdef TLBT_VALUE_T
+#define TLBT_MAP_FROZEN_TYPE                                                                                           \
+  TLBT_COMBINE2(tlbt_map_frozen_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#else
+#define TLBT_MAP_FROZEN_TYPE TLBT_COMBINE2(tlbt_set_frozen_, TLBT_KEY_T_NAME)
+#endif
+
+#define TLBT_MAP_FROZEN_ENTRY_TYPE TLBT_COMBINE2(TLBT_MAP_FROZEN_TYPE, TLBT_COMBINE2(_, entry))
+#define TLBT_MAP_FROZEN_FUNC(name) TLBT_COMBINE2(TLBT_MAP_FROZEN_TYPE, TLBT_COMBINE2(_, name))
+#endif
+
+#ifdef TLBT_MAP_SHARDED
+#define TLBT_MAP_SHARDED_TYPE                                                                                          \
+  TLBT_COMBINE2(tlbt_map_sharded_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#define TLBT_MAP_SHARDED_FUNC(name) TLBT_COMBINE2(TLBT_MAP_SHARDED_TYPE, TLBT_COMBINE2(_, name))
+#define TLBT_MAP_SHARDED_TASK_TYPE TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_MAP_SHARDED_TYPE, _task))
+#endif
+
+#ifdef TLBT_MAP_RCU
+#ifdef TLBT_VALUE_T
+#define TLBT_MAP_RCU_TYPE                                                                                              \
+  TLBT_COMBINE2(tlbt_map_rcu_, TLBT_COMBINE2(TLBT_KEY_T_NAME, TLBT_COMBINE2(_, TLBT_VALUE_T_NAME)))
+#else
+#define TLBT_MAP_RCU_TYPE TLBT_COMBINE2(tlbt_set_rcu_, TLBT_KEY_T_NAME)
+#endif
+#define TLBT_MAP_RCU_FUNC(name) TLBT_COMBINE2(TLBT_MAP_RCU_TYPE, TLBT_COMBINE2(_, name))
+#define TLBT_MAP_RCU_READER_TYPE TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_MAP_RCU_TYPE, _reader))
+#define TLBT_MAP_RCU_SNAPSHOT_TYPE TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_MAP_RCU_TYPE, _snapshot))
+#endif
+
+// the two highest bits of the index type
+#define TLBT_OCCUPIED_BIT ((TLBT_MAP_INDEX_T)1 << (sizeof(TLBT_MAP_INDEX_T) * 8 - 1))
+#define TLBT_DELETED_BIT ((TLBT_MAP_INDEX_T)1 << (sizeof(TLBT_MAP_INDEX_T) * 8 - 2))
 #define TLBT_INDEX_MASK (TLBT_DELETED_BIT - 1)
 #define TLBT_IS_DELETED(flags) (((flags) & (TLBT_DELETED_BIT)) != 0)
 #define TLBT_IS_OCCUPIED(flags) (((flags) & (TLBT_OCCUPIED_BIT)) != 0)
 
+#ifdef TLBT_MAP_SIMD_PROBE
+
+#ifndef TLBT_UINT8_T
+#include <stdint.h>
+#define TLBT_UINT8_T uint8_t
+#endif
+
+#if !defined(TLBT_MAP_NO_SSE2) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define TLBT_MAP_SSE2
+#endif
+
+// empty and deleted have the high bit set. occupied slots store the upper 7 bits of the hash (h2)
+// the lower bits are already used for the slot position. TLBT_FAST_RANGE takes the slot from the upper bits, so h2 is
+// the lower 7 bits there
+#define TLBT_CTRL_EMPTY ((TLBT_UINT8_T)0x80)
+#define TLBT_CTRL_DELETED ((TLBT_UINT8_T)0xFE)
+#if defined(TLBT_FAST_RANGE) && !defined(TLBT_BASE2_CAPACITY)
+#define TLBT_CTRL_H2(hash) ((TLBT_UINT8_T)((hash) & 0x7F))
+#else
+#define TLBT_CTRL_H2(hash) ((TLBT_UINT8_T)(((hash) >> (sizeof(TLBT_MAP_HASH_T) * 8 - 7)) & 0x7F))
+#endif
+#define TLBT_GROUP_WIDTH 16
+// group positions run up to TLBT_GROUP_WIDTH past the end, which wraps more than once in tables smaller than a group
+#define TLBT_MAP_WRAP_GROUP(i, capacity)                                                                               \
+  ((capacity) < TLBT_GROUP_WIDTH ? TLBT_MOD(i, capacity) : TLBT_MAP_WRAP(i, capacity))
+#define TLBT_MAP_SLOT_OCCUPIED(m, i) (((m)->ctrl[(i)] & TLBT_CTRL_EMPTY) == 0)
+
+#elif defined(TLBT_MAP_INTEGER_KEY)
+
+// the key itself tells if a slot is empty or deleted
+#define TLBT_MAP_SLOT_OCCUPIED(m, i)                                                                                   \
+  ((m)->keys[(i)].key != TLBT_MAP_EMPTY_KEY && (m)->keys[(i)].key != TLBT_MAP_DELETED_KEY)
+
+#else
+
+// the state bits of an entry. slots of an older generation are empty
+#ifdef TLBT_MAP_EPOCH
+#define TLBT_MAP_FLAGS(m, entry) (((entry)->index & TLBT_INDEX_MASK) == (m)->epoch ? (entry)->index : 0)
+#else
+#define TLBT_MAP_FLAGS(m, entry) ((entry)->index)
+#endif
+
+// the lower bits of a linear probing index aren't needed for probing so they hold the generation if there is one
+#ifdef TLBT_MAP_EPOCH
+#define TLBT_MAP_GENERATION(m) ((m)->epoch)
+#else
+#define TLBT_MAP_GENERATION(m) ((TLBT_MAP_INDEX_T)0)
+#endif
+
+// robin hood entries of an old table can be flagged as deleted while still being occupied during incremental resizing
+#define TLBT_MAP_SLOT_OCCUPIED(m, i)                                                                                   \
+  ((TLBT_MAP_FLAGS(m, &(m)->keys[(i)]) & (TLBT_OCCUPIED_BIT | TLBT_DELETED_BIT)) == TLBT_OCCUPIED_BIT)
+
+#endif
+
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_BITMAP_WORDS(capacity) (((capacity) + 63) / 64)
+#define TLBT_MAP_MARK_OCCUPIED(m, i) ((m)->occupancy[(i) / 64] |= (TLBT_UINT64_T)1 << ((i) % 64))
+#define TLBT_MAP_MARK_FREE(m, i) ((m)->occupancy[(i) / 64] &= ~((TLBT_UINT64_T)1 << ((i) % 64)))
+#else
+#define TLBT_MAP_MARK_OCCUPIED(m, i) ((void)0)
+#define TLBT_MAP_MARK_FREE(m, i) ((void)0)
+#endif
+
+// whether a table of zero bytes has only empty slots
+#ifdef TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_ZEROED_SLOTS 0
+#elif defined(TLBT_MAP_INTEGER_KEY)
+#define TLBT_MAP_ZEROED_SLOTS (TLBT_MAP_EMPTY_KEY == 0)
+#else
+#define TLBT_MAP_ZEROED_SLOTS 1
+#endif
+
+// lookups only get a const map so the counters are written through a cast
+#ifdef TLBT_MAP_COUNTERS
+#define TLBT_MAP_COUNT(m, counter, n) ((void)(((TLBT_MAP_TYPE *)(m))->counters.counter += (n)))
+#else
+#define TLBT_MAP_COUNT(m, counter, n) ((void)0)
+#endif
+
+#ifdef TLBT_MAP_SPLIT_VALUES
+#define TLBT_MAP_ENTRY_BYTES (sizeof(TLBT_MAP_KEY_TYPE) + sizeof(TLBT_VALUE_T))
+#else
+#define TLBT_MAP_ENTRY_BYTES sizeof(TLBT_MAP_KEY_TYPE)
+#endif
+
+#ifdef TLBT_MAP_STORE_HASH
+#define TLBT_MAP_HASH_MATCHES(entry, h) ((entry)->hash == (h))
+#else
+#define TLBT_MAP_HASH_MATCHES(entry, h) 1
+#endif
+
 #ifdef TLBT_STATIC
 #undef TLBT_DEFINITION
 #define TLBT_DEFINITION
@@ -166,16 +643,45 @@ _Static_assert(sizeof(TLBT_UINT32_T) == 4, "TLBT_UINT32_T has to have 4 bytes");
 
 typedef struct TLBT_MAP_KEY_TYPE {
   TLBT_KEY_T key;
-  TLBT_UINT32_T index; // upper two bits are used for occupied and deleted states
+#if !defined(TLBT_MAP_SIMD_PROBE) && !defined(TLBT_MAP_INTEGER_KEY)
+  TLBT_MAP_INDEX_T index; // upper two bits are used for occupied and deleted states. the probe distance with robin hood
+#endif
+#ifdef TLBT_MAP_STORE_HASH
+  TLBT_MAP_HASH_T hash;
+#endif
+#if defined(TLBT_VALUE_T) && !defined(TLBT_MAP_SPLIT_VALUES)
+  TLBT_VALUE_T value;
+#endif
 } TLBT_MAP_KEY_TYPE;
 
 typedef struct TLBT_MAP_TYPE {
   TLBT_MAP_KEY_TYPE *keys;
-#ifdef TLBT_VALUE_T
+#ifdef TLBT_MAP_SPLIT_VALUES
   TLBT_VALUE_T *values;
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  TLBT_UINT8_T *ctrl; // capacity + TLBT_GROUP_WIDTH bytes. the first group is mirrored at the end
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_UINT64_T *occupancy; // bit i % 64 of word i / 64 is set if slot i holds an entry. NULL for viewed maps
 #endif
   TLBT_SIZE_T capacity;
   TLBT_SIZE_T count;
+#ifdef TLBT_MAP_EPOCH
+  TLBT_MAP_INDEX_T epoch; // the generation of the live slots. starts at 1 so zeroed slots are never part of it
+#endif
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  struct TLBT_MAP_TYPE *old; // the previous table while a resize is in progress. NULL otherwise
+  TLBT_SIZE_T migrated;      // slots of the old table which have already been moved
+#endif
+#ifdef TLBT_MAP_COUNTERS
+  struct {
+    TLBT_UINT64_T probes;         // slots looked at by lookups and inserts. groups with TLBT_MAP_SIMD_PROBE
+    TLBT_UINT64_T equals;         // TLBT_EQUALS calls
+    TLBT_UINT64_T resizes;        // growing, shrinking and rehashing in place
+    TLBT_UINT64_T bytes_rehashed; // keys and values moved into another slot by resizes
+  } counters;
+#endif
 } TLBT_MAP_TYPE;
 
 #ifndef TLBT_MAP_NO_ITERATOR
@@ -185,34 +691,68 @@ typedef struct TLBT_MAP_ITERATOR_TYPE {
 } TLBT_MAP_ITERATOR_TYPE;
 #endif
 
+// the probe length of an entry is the number of slots a lookup reads to find it, 1 if it's in its home slot.
+// entries and tombstones of an old table during incremental resizing are included
+typedef struct TLBT_MAP_STATS_TYPE {
+  TLBT_SIZE_T count;
+  TLBT_SIZE_T capacity;
+  TLBT_SIZE_T tombstones; // deleted slots which probing has to skip. robin hood only has them in an old table
+  float load_factor;
+  float mean_probe_length;
+  TLBT_SIZE_T max_probe_length;
+  TLBT_SIZE_T histogram[TLBT_MAP_STATS_BUCKETS]; // entries with probe length i + 1 in bucket i
+} TLBT_MAP_STATS_TYPE;
+
 #ifdef TLBT_DYNAMIC_MEMORY
 TLBT_INLINE void TLBT_MAP_FUNC(create)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity);
 TLBT_INLINE void TLBT_MAP_FUNC(destroy)(TLBT_MAP_TYPE *const m);
 TLBT_INLINE void TLBT_MAP_FUNC(ensure_capacity)(TLBT_MAP_TYPE *const m);
 TLBT_INLINE void TLBT_MAP_FUNC(adjust_capacity)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity);
+TLBT_INLINE void TLBT_MAP_FUNC(shrink_to_fit)(TLBT_MAP_TYPE *const m);
+TLBT_INLINE void TLBT_MAP_FUNC(reserve)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T n);
+#ifdef TLBT_MAP_PARALLEL_BUILD
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(build_parallel)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_VALUE_T *values, TLBT_SIZE_T n, TLBT_SIZE_T threads);
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(build_parallel)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                      TLBT_SIZE_T threads);
+#endif
+#endif
 #else
 
-#ifdef TLBT_VALUE_T
+#ifdef TLBT_MAP_SIMD_PROBE
+#ifdef TLBT_MAP_SPLIT_VALUES
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
+                                     TLBT_VALUE_T *value_buffer, TLBT_UINT8_T *ctrl_buffer);
+#else
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
+                                     TLBT_UINT8_T *ctrl_buffer);
+#endif
+#else
+#ifdef TLBT_MAP_SPLIT_VALUES
 TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
                                      TLBT_VALUE_T *value_buffer);
 #else
 TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer);
 #endif
+#endif
 
 #endif
 
 #ifdef TLBT_VALUE_T
 TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
-                                          TLBT_UINT32_T hash);
+                                          TLBT_MAP_HASH_T hash);
 #else
-TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash);
 #endif
 
-TLBT_INLINE bool TLBT_MAP_FUNC(remove_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
-TLBT_INLINE bool TLBT_MAP_FUNC(contains_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(remove_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(contains_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash);
 
 #ifdef TLBT_VALUE_T
-TLBT_INLINE bool TLBT_MAP_FUNC(get_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out, TLBT_UINT32_T hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(get_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                       TLBT_MAP_HASH_T hash);
 #endif
 
 #ifdef TLBT_VALUE_T
@@ -228,8 +768,211 @@ TLBT_INLINE bool TLBT_MAP_FUNC(contains)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key)
 TLBT_INLINE bool TLBT_MAP_FUNC(get)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out);
 #endif
 
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_VALUE_T *TLBT_MAP_FUNC(get_or_insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                          bool *out_inserted);
+TLBT_INLINE TLBT_VALUE_T *TLBT_MAP_FUNC(get_or_insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, bool *out_inserted);
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_or_assign_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                    TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_or_assign)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value);
+#endif
+
+// out_found receives whether each key was found. out_values is left untouched for keys which were not found
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(get_batch_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                    const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n,
+                                                    TLBT_VALUE_T *out_values, bool *out_found);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(get_batch)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                 TLBT_VALUE_T *out_values, bool *out_found);
+#endif
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(contains_batch_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                         const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n,
+                                                         bool *out_found);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(contains_batch)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                      bool *out_found);
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_VALUE_T *values, const TLBT_MAP_HASH_T *hashes,
+                                                      TLBT_SIZE_T n);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                   const TLBT_VALUE_T *values, TLBT_SIZE_T n);
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n);
+#endif
+
+#ifdef TLBT_VALUE_T
+typedef bool (*TLBT_MAP_FUNC(visitor))(const TLBT_KEY_T *key, TLBT_VALUE_T *value, void *userdata);
+#else
+typedef bool (*TLBT_MAP_FUNC(visitor))(const TLBT_KEY_T *key, void *userdata);
+#endif
+
+TLBT_INLINE void TLBT_MAP_FUNC(for_each)(TLBT_MAP_TYPE *const m, TLBT_MAP_FUNC(visitor) visitor, void *userdata);
+TLBT_INLINE void TLBT_MAP_FUNC(stats)(const TLBT_MAP_TYPE *const m, TLBT_MAP_STATS_TYPE *const out);
 TLBT_INLINE void TLBT_MAP_FUNC(clear)(TLBT_MAP_TYPE *const m);
 TLBT_INLINE bool TLBT_MAP_FUNC(copy)(TLBT_MAP_TYPE *const dest, const TLBT_MAP_TYPE *const src);
+TLBT_INLINE void TLBT_MAP_FUNC(rehash)(TLBT_MAP_TYPE *const m);
+
+#ifndef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FUNC(union_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                           const TLBT_MAP_TYPE *const b);
+TLBT_INLINE bool TLBT_MAP_FUNC(intersect_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                               const TLBT_MAP_TYPE *const b);
+TLBT_INLINE bool TLBT_MAP_FUNC(difference_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                                const TLBT_MAP_TYPE *const b);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(intersection_count)(const TLBT_MAP_TYPE *const a, const TLBT_MAP_TYPE *const b);
+#endif
+
+#ifdef TLBT_MAP_FREEZE
+// key and value next to each other so a lookup touches a single cache line
+typedef struct TLBT_MAP_FROZEN_ENTRY_TYPE {
+  TLBT_MAP_HASH_T hash; // lookups only compare keys with the same hash
+  TLBT_KEY_T key;
+#ifdef TLBT_VALUE_T
+  TLBT_VALUE_T value;
+#endif
+} TLBT_MAP_FROZEN_ENTRY_TYPE;
+
+typedef struct TLBT_MAP_FROZEN_TYPE {
+  TLBT_MAP_FROZEN_ENTRY_TYPE *entries;
+  TLBT_UINT32_T *seeds; // one per bucket. selects the hash function which places the keys of the bucket
+  TLBT_SIZE_T buckets;
+  TLBT_SIZE_T slots; // entries placed by the perfect hash function
+  TLBT_SIZE_T count; // the slots followed by the overflow
+} TLBT_MAP_FROZEN_TYPE;
+
+TLBT_INLINE bool TLBT_MAP_FUNC(freeze)(const TLBT_MAP_TYPE *const m, TLBT_MAP_FROZEN_TYPE *const out);
+TLBT_INLINE void TLBT_MAP_FROZEN_FUNC(destroy)(TLBT_MAP_FROZEN_TYPE *const f);
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(get_ph)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                              TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(get)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key, TLBT_VALUE_T *out);
+#endif
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(contains_ph)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key,
+                                                   TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(contains)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key);
+#endif
+
+#ifdef TLBT_MAP_SHARDED
+typedef void (*TLBT_MAP_FUNC(combine))(TLBT_VALUE_T *into, TLBT_VALUE_T value, void *userdata);
+
+typedef struct TLBT_MAP_SHARDED_TYPE {
+  TLBT_MAP_TYPE *shards; // shard p of thread t is at t * stride + p. after merging the first row holds the result
+  TLBT_MAP_FUNC(combine) combine;
+  void *userdata;
+  TLBT_SIZE_T threads;
+  TLBT_SIZE_T partitions;
+  TLBT_SIZE_T stride; // partitions and a cache line, so no two threads write to the same one
+} TLBT_MAP_SHARDED_TYPE;
+
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(create)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T threads,
+                                               TLBT_SIZE_T partitions, TLBT_MAP_FUNC(combine) combine, void *userdata);
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(destroy)(TLBT_MAP_SHARDED_TYPE *const s);
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(add_ph)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T thread, TLBT_KEY_T key,
+                                               TLBT_VALUE_T value, TLBT_MAP_HASH_T hash);
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(add)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T thread, TLBT_KEY_T key,
+                                            TLBT_VALUE_T value);
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(merge)(TLBT_MAP_SHARDED_TYPE *const s);
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_SHARDED_FUNC(partition)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T partition);
+TLBT_INLINE bool TLBT_MAP_SHARDED_FUNC(get_ph)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                               TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_SHARDED_FUNC(get)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_KEY_T key, TLBT_VALUE_T *out);
+#endif
+
+#ifdef TLBT_MAP_RCU
+typedef struct TLBT_MAP_RCU_READER_TYPE {
+  TLBT_UINT64_T epoch; // the epoch the reader started reading in. 0 while it isn't reading
+  char padding[64];    // readers only write their own cache line
+} TLBT_MAP_RCU_READER_TYPE;
+
+// the map comes first so the maps handed out by prepare can be turned back into their snapshot
+typedef struct TLBT_MAP_RCU_SNAPSHOT_TYPE {
+  TLBT_MAP_TYPE map;
+  TLBT_UINT64_T epoch; // the last epoch in which it was the current snapshot
+  struct TLBT_MAP_RCU_SNAPSHOT_TYPE *next;
+} TLBT_MAP_RCU_SNAPSHOT_TYPE;
+
+typedef struct TLBT_MAP_RCU_TYPE {
+  TLBT_MAP_RCU_SNAPSHOT_TYPE *current;
+  TLBT_MAP_RCU_SNAPSHOT_TYPE *retired; // replaced snapshots which might still be read. only touched by the writer
+  TLBT_MAP_RCU_READER_TYPE *readers;
+  TLBT_SIZE_T reader_count;
+  TLBT_UINT64_T epoch; // starts at 1 and counts up with every publish
+} TLBT_MAP_RCU_TYPE;
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(create)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T readers);
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(destroy)(TLBT_MAP_RCU_TYPE *const r);
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(read_begin)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader);
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(read_end)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader);
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(get_ph)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                           TLBT_VALUE_T *out, TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(get)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                        TLBT_VALUE_T *out);
+#endif
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(contains_ph)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                                TLBT_MAP_HASH_T hash);
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(contains)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key);
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(prepare)(TLBT_MAP_RCU_TYPE *const r);
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(prepare_copy)(TLBT_MAP_RCU_TYPE *const r);
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(publish)(TLBT_MAP_RCU_TYPE *const r, TLBT_MAP_TYPE *next);
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_RCU_FUNC(reclaim)(TLBT_MAP_RCU_TYPE *const r);
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(synchronize)(TLBT_MAP_RCU_TYPE *const r);
+#endif
+
+#ifdef TLBT_MAP_SERIALIZE
+TLBT_INLINE bool TLBT_MAP_FUNC(save)(TLBT_MAP_TYPE *const m, FILE *file);
+TLBT_INLINE bool TLBT_MAP_FUNC(view)(TLBT_MAP_TYPE *const m, void *data, TLBT_SIZE_T size);
+#ifdef TLBT_DYNAMIC_MEMORY
+TLBT_INLINE bool TLBT_MAP_FUNC(load)(TLBT_MAP_TYPE *const m, FILE *file);
+#endif
+#endif
+
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_OLD_TABLE(m) ((m)->old)
+#else
+#define TLBT_MAP_OLD_TABLE(m) ((TLBT_MAP_TYPE *)0)
+#endif
+
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(ctz64)(TLBT_UINT64_T bits) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (TLBT_SIZE_T)__builtin_ctzll(bits);
+#else
+  TLBT_SIZE_T n = 0;
+  while (!(bits & 1)) {
+    bits >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+#endif
+
+// the first occupied slot at or after slot i. capacity if there is none and i itself if it is past the capacity,
+// which the iterator relies on to keep its position in an old table
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(next_occupied)(const TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  if (m->occupancy) {
+    if (i >= m->capacity)
+      return i;
+    const TLBT_SIZE_T words = TLBT_MAP_BITMAP_WORDS(m->capacity);
+    TLBT_SIZE_T word = i / 64;
+    // the bits past the capacity in the last word are never set
+    TLBT_UINT64_T bits = m->occupancy[word] & (~(TLBT_UINT64_T)0 << (i % 64));
+    while (bits == 0) {
+      if (++word == words)
+        return m->capacity;
+      bits = m->occupancy[word];
+    }
+    return word * 64 + TLBT_MAP_FUNC_INTERNAL(ctz64)(bits);
+  }
+#endif
+  while (i < m->capacity && !TLBT_MAP_SLOT_OCCUPIED(m, i))
+    ++i;
+  return i;
+}
 
 #ifndef TLBT_MAP_NO_ITERATOR
 
@@ -242,59 +985,69 @@ static inline void TLBT_MAP_ITERATOR_FUNC(reset)(TLBT_MAP_ITERATOR_TYPE *const i
   iter->i = 0;
 }
 
+// advances the iterator to the next occupied slot and returns the table it belongs to (or NULL at the end).
+// the slots of an old table during incremental resizing follow the slots of the current one
+static inline TLBT_MAP_TYPE *TLBT_MAP_FUNC_INTERNAL(iterator_next)(TLBT_MAP_ITERATOR_TYPE *const iter,
+                                                                  TLBT_SIZE_T *out_slot) {
+  TLBT_SIZE_T offset = 0;
+  for (TLBT_MAP_TYPE *m = iter->map; m; m = TLBT_MAP_OLD_TABLE(m)) {
+    const TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(m, iter->i - offset);
+    iter->i = offset + i;
+    if (i < m->capacity) {
+      *out_slot = i;
+      ++iter->i;
+      return m;
+    }
+    offset += m->capacity;
+  }
+  return 0;
+}
+
 #ifdef TLBT_VALUE_T
 static inline bool TLBT_MAP_ITERATOR_FUNC(iterate)(TLBT_MAP_ITERATOR_TYPE *const iter, TLBT_KEY_T *out_key,
                                                    TLBT_VALUE_T *out_value) {
 #else
 static inline bool TLBT_MAP_ITERATOR_FUNC(iterate)(TLBT_MAP_ITERATOR_TYPE *const iter, TLBT_KEY_T *out_key) {
 #endif
-  TLBT_MAP_TYPE *m = iter->map;
-
-  while (iter->i < m->capacity && !(m->keys[iter->i].index & TLBT_OCCUPIED_BIT))
-    ++iter->i;
-
-  if (iter->i >= m->capacity)
+  TLBT_SIZE_T i = 0;
+  TLBT_MAP_TYPE *m = TLBT_MAP_FUNC_INTERNAL(iterator_next)(iter, &i);
+  if (!m)
     return false;
 
-  *out_key = m->keys[iter->i].key;
+  *out_key = m->keys[i].key;
 #ifdef TLBT_VALUE_T
-  *out_value = m->values[iter->i];
+  *out_value = TLBT_MAP_VALUE(m, i);
 #endif
-  ++iter->i;
 
   return true;
 }
 
-#endif
-
 #ifdef TLBT_VALUE_T
 static inline bool TLBT_MAP_ITERATOR_FUNC(iterate_ref)(TLBT_MAP_ITERATOR_TYPE *const iter, const TLBT_KEY_T **out_key,
                                                        TLBT_VALUE_T **out_value) {
 #else
 static inline bool TLBT_MAP_ITERATOR_FUNC(iterate_ref)(TLBT_MAP_ITERATOR_TYPE *const iter, const TLBT_KEY_T **out_key) {
 #endif
-  TLBT_MAP_TYPE *m = iter->map;
-
-  while (iter->i < m->capacity && !(m->keys[iter->i].index & TLBT_OCCUPIED_BIT))
-    ++iter->i;
-
-  if (iter->i >= m->capacity)
+  TLBT_SIZE_T i = 0;
+  TLBT_MAP_TYPE *m = TLBT_MAP_FUNC_INTERNAL(iterator_next)(iter, &i);
+  if (!m)
     return false;
 
-  *out_key = &m->keys[iter->i].key;
+  *out_key = &m->keys[i].key;
 #ifdef TLBT_VALUE_T
-  *out_value = &m->values[iter->i];
+  *out_value = &TLBT_MAP_VALUE(m, i);
 #endif
-  ++iter->i;
 
   return true;
 }
 
 #endif
 
+#endif
+
 #ifdef TLBT_IMPLEMENTATION
 
-#if !defined(TLBT_HASH) && !defined(TLBT_HASH_REF)
+#if !defined(TLBT_HASH) && !defined(TLBT_HASH_REF) && !defined(TLBT_MAP_INTEGER_KEY)
 #error "TLBT_HASH or TLBT_HASH_REF must be defined"
 #endif
 
@@ -306,7 +1059,30 @@ static inline bool TLBT_MAP_ITERATOR_FUNC(iterate_ref)(TLBT_MAP_ITERATOR_TYPE *c
 #define TLBT_HASH_FUNC(x) TLBT_HASH_REF(&(x))
 #endif
 
-#if !defined(TLBT_EQUALS) && !defined(TLBT_EQUALS_REF)
+#if !defined(TLBT_HASH) && !defined(TLBT_HASH_REF)
+// murmur3 finalizers like tlbt_hash_mix32 and tlbt_hash_mix64 from hash.h. wider keys are folded to the hash width
+static inline TLBT_MAP_HASH_T TLBT_MAP_FUNC_INTERNAL(mix)(TLBT_KEY_T key) {
+  TLBT_UINT64_T x = (TLBT_UINT64_T)key;
+  if (sizeof(TLBT_KEY_T) <= 4 && sizeof(TLBT_MAP_HASH_T) == 4) {
+    TLBT_UINT32_T h = (TLBT_UINT32_T)x;
+    h ^= h >> 16;
+    h *= 0x85EBCA6BU;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35U;
+    h ^= h >> 16;
+    return (TLBT_MAP_HASH_T)h;
+  }
+  x ^= x >> 33;
+  x *= 0xFF51AFD7ED558CCDULL;
+  x ^= x >> 33;
+  x *= 0xC4CEB9FE1A85EC53ULL;
+  x ^= x >> 33;
+  return (TLBT_MAP_HASH_T)(sizeof(TLBT_MAP_HASH_T) == 4 ? x ^ (x >> 32) : x);
+}
+#define TLBT_HASH_FUNC(x) TLBT_MAP_FUNC_INTERNAL(mix)((x))
+#endif
+
+#if !defined(TLBT_EQUALS) && !defined(TLBT_EQUALS_REF) && !defined(TLBT_MAP_INTEGER_KEY)
 #error "TLBT_EQUALS or TLBT_EQUALS_REF must be defined"
 #endif
 
@@ -317,256 +1093,2474 @@ static inline bool TLBT_MAP_ITERATOR_FUNC(iterate_ref)(TLBT_MAP_ITERATOR_TYPE *c
 #ifdef TLBT_EQUALS_REF
 #define TLBT_EQUALS_FUNC(a, b) TLBT_EQUALS_REF(&(a), &(b))
 #endif
+#if !defined(TLBT_EQUALS) && !defined(TLBT_EQUALS_REF)
+#define TLBT_EQUALS_FUNC(a, b) ((a) == (b))
+#endif
 
-TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_entry)(TLBT_MAP_KEY_TYPE *keys, TLBT_SIZE_T capacity, TLBT_KEY_T key,
-                                                    TLBT_UINT32_T hash, TLBT_SIZE_T *out_index) {
-  TLBT_SIZE_T i = TLBT_MOD(hash, capacity);
-  const TLBT_SIZE_T start = i;
-  for (;;) {
-    TLBT_MAP_KEY_TYPE *entry = &keys[i];
-    if (!TLBT_IS_OCCUPIED(entry->index) && !TLBT_IS_DELETED(entry->index)) {
-      return false;
-    } else if (TLBT_EQUALS_FUNC(entry->key, key)) {
-      *out_index = i;
-      return true;
-    } else {
-      // deleted or occupied and not the same
-      // if an entry was deleted we still have to continue searching because it might have been inserted after that
-      i = TLBT_MOD(i + 1, capacity);
-      if (i == start)
-        return false;
-    }
-  }
-  // should never reach
-  return false;
-}
+#define TLBT_MAP_KEYS_EQUAL(m, a, b) (TLBT_MAP_COUNT(m, equals, 1), TLBT_EQUALS_FUNC(a, b))
 
-TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(find_empty)(TLBT_MAP_KEY_TYPE *keys, TLBT_SIZE_T capacity,
-                                                           TLBT_UINT32_T hash) {
-  TLBT_SIZE_T i = TLBT_MOD(hash, capacity);
-  for (;;) {
-    TLBT_MAP_KEY_TYPE *entry = &keys[i];
-    if (!TLBT_IS_OCCUPIED(entry->index) || TLBT_IS_DELETED(entry->index)) {
-      return i;
-    }
-    i = TLBT_MOD(i + 1, capacity);
+#undef TLBT_MAP_ENTRY_HASH
+#ifdef TLBT_MAP_STORE_HASH
+#define TLBT_MAP_ENTRY_HASH(m, i) ((m)->keys[(i)].hash)
+#else
+#define TLBT_MAP_ENTRY_HASH(m, i) TLBT_HASH_FUNC((m)->keys[(i)].key)
+#endif
+
+#ifdef TLBT_MAP_SIMD_PROBE
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(ctz)(TLBT_UINT32_T mask) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (TLBT_UINT32_T)__builtin_ctz(mask);
+#else
+  TLBT_UINT32_T n = 0;
+  while (!(mask & 1)) {
+    mask >>= 1;
+    ++n;
   }
-  // should never reach
-  return 0;
+  return n;
+#endif
 }
 
-#ifdef TLBT_DYNAMIC_MEMORY
+#ifdef TLBT_MAP_SSE2
 
-TLBT_INLINE void TLBT_MAP_FUNC(create)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity) {
-  m->capacity = capacity;
-#ifdef TLBT_BASE2_CAPACITY
-  TLBT_ASSERT((capacity != 0 && (capacity & (capacity - 1)) == 0));
-#endif
-  m->keys = TLBT_MALLOC(sizeof(TLBT_MAP_KEY_TYPE) * capacity);
-  TLBT_MEMSET(m->keys, 0, sizeof(TLBT_MAP_KEY_TYPE) * capacity);
-#ifdef TLBT_VALUE_T
-  m->values = TLBT_MALLOC(sizeof(TLBT_VALUE_T) * capacity);
-#endif
-  m->count = 0;
+// bit i of the returned masks corresponds to control byte i of the group
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match)(const TLBT_UINT8_T *group, TLBT_UINT8_T h2) {
+  const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (TLBT_UINT32_T)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)h2)));
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match_empty)(const TLBT_UINT8_T *group) {
+  const __m128i ctrl = _mm_loadu_si128((const __m128i *)group);
+  return (TLBT_UINT32_T)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)TLBT_CTRL_EMPTY)));
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match_available)(const TLBT_UINT8_T *group) {
+  // empty and deleted are the only states with the high bit set
+  return (TLBT_UINT32_T)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+
+#else
+
+// SWAR fallback working on two 64 bit words per group.
+// the words are assembled byte by byte so byte i always ends up in bits [8i, 8i + 8) regardless of endianness
+#define TLBT_SWAR_LSB 0x0101010101010101ULL
+#define TLBT_SWAR_MSB 0x8080808080808080ULL
+
+static inline TLBT_UINT64_T TLBT_MAP_FUNC_INTERNAL(swar_load)(const TLBT_UINT8_T *p) {
+  TLBT_UINT64_T word = 0;
+  for (int i = 7; i >= 0; --i)
+    word = (word << 8) | p[i];
+  return word;
+}
+
+// moves the high bit of byte i to bit i
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(swar_pack)(TLBT_UINT64_T word) {
+  return (TLBT_UINT32_T)((((word >> 7) & TLBT_SWAR_LSB) * 0x0102040810204080ULL) >> 56);
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(swar_match)(TLBT_UINT64_T word, TLBT_UINT8_T h2) {
+  // zero byte detection. can have false positives which is fine because the keys get compared anyway
+  const TLBT_UINT64_T x = word ^ (TLBT_SWAR_LSB * h2);
+  return TLBT_MAP_FUNC_INTERNAL(swar_pack)((x - TLBT_SWAR_LSB) & ~x & TLBT_SWAR_MSB);
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match)(const TLBT_UINT8_T *group, TLBT_UINT8_T h2) {
+  return TLBT_MAP_FUNC_INTERNAL(swar_match)(TLBT_MAP_FUNC_INTERNAL(swar_load)(group), h2) |
+         (TLBT_MAP_FUNC_INTERNAL(swar_match)(TLBT_MAP_FUNC_INTERNAL(swar_load)(group + 8), h2) << 8);
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match_empty)(const TLBT_UINT8_T *group) {
+  // empty is the only state with the high bit set and bit 1 cleared
+  const TLBT_UINT64_T lo = TLBT_MAP_FUNC_INTERNAL(swar_load)(group);
+  const TLBT_UINT64_T hi = TLBT_MAP_FUNC_INTERNAL(swar_load)(group + 8);
+  return TLBT_MAP_FUNC_INTERNAL(swar_pack)(lo & (~lo << 6) & TLBT_SWAR_MSB) |
+         (TLBT_MAP_FUNC_INTERNAL(swar_pack)(hi & (~hi << 6) & TLBT_SWAR_MSB) << 8);
+}
+
+static inline TLBT_UINT32_T TLBT_MAP_FUNC_INTERNAL(group_match_available)(const TLBT_UINT8_T *group) {
+  return TLBT_MAP_FUNC_INTERNAL(swar_pack)(TLBT_MAP_FUNC_INTERNAL(swar_load)(group) & TLBT_SWAR_MSB) |
+         (TLBT_MAP_FUNC_INTERNAL(swar_pack)(TLBT_MAP_FUNC_INTERNAL(swar_load)(group + 8) & TLBT_SWAR_MSB) << 8);
+}
+
+#endif
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_ctrl)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_UINT8_T ctrl) {
+  m->ctrl[i] = ctrl;
+  // the first group is mirrored behind the last slot so groups never have to wrap around.
+  // capacities smaller than a group are mirrored multiple times
+  for (; i < TLBT_GROUP_WIDTH; i += m->capacity)
+    m->ctrl[m->capacity + i] = ctrl;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_entry)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                    TLBT_SIZE_T *out_index) {
+  const TLBT_UINT8_T h2 = TLBT_CTRL_H2(hash);
+  TLBT_SIZE_T pos = TLBT_MAP_HOME(hash, m->capacity);
+  for (TLBT_SIZE_T probed = 0; probed < m->capacity; probed += TLBT_GROUP_WIDTH) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_UINT8_T *group = &m->ctrl[pos];
+    for (TLBT_UINT32_T mask = TLBT_MAP_FUNC_INTERNAL(group_match)(group, h2); mask != 0; mask &= mask - 1) {
+      const TLBT_SIZE_T i = TLBT_MAP_WRAP_GROUP(pos + TLBT_MAP_FUNC_INTERNAL(ctz)(mask), m->capacity);
+      if (TLBT_MAP_HASH_MATCHES(&m->keys[i], hash) && TLBT_MAP_KEYS_EQUAL(m, m->keys[i].key, key)) {
+        *out_index = i;
+        return true;
+      }
+    }
+    // deleted slots don't stop the search but empty ones do. the key would have been inserted there
+    if (TLBT_MAP_FUNC_INTERNAL(group_match_empty)(group))
+      return false;
+    pos = TLBT_MAP_WRAP_GROUP(pos + TLBT_GROUP_WIDTH, m->capacity);
+  }
+  return false;
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(find_empty)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T pos = TLBT_MAP_HOME(hash, m->capacity);
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_UINT32_T mask = TLBT_MAP_FUNC_INTERNAL(group_match_available)(&m->ctrl[pos]);
+    if (mask != 0)
+      return TLBT_MAP_WRAP_GROUP(pos + TLBT_MAP_FUNC_INTERNAL(ctz)(mask), m->capacity);
+    pos = TLBT_MAP_WRAP_GROUP(pos + TLBT_GROUP_WIDTH, m->capacity);
+  }
+  // should never reach
+  return 0;
+}
+
+// find_entry and find_empty in one probe sequence. if the key doesn't exist out_index is the slot to insert it into
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_slot)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                   TLBT_SIZE_T *out_index) {
+  const TLBT_UINT8_T h2 = TLBT_CTRL_H2(hash);
+  TLBT_SIZE_T pos = TLBT_MAP_HOME(hash, m->capacity);
+  TLBT_SIZE_T slot = m->capacity;
+  for (TLBT_SIZE_T probed = 0; probed < m->capacity; probed += TLBT_GROUP_WIDTH) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_UINT8_T *group = &m->ctrl[pos];
+    for (TLBT_UINT32_T mask = TLBT_MAP_FUNC_INTERNAL(group_match)(group, h2); mask != 0; mask &= mask - 1) {
+      const TLBT_SIZE_T i = TLBT_MAP_WRAP_GROUP(pos + TLBT_MAP_FUNC_INTERNAL(ctz)(mask), m->capacity);
+      if (TLBT_MAP_HASH_MATCHES(&m->keys[i], hash) && TLBT_MAP_KEYS_EQUAL(m, m->keys[i].key, key)) {
+        *out_index = i;
+        return true;
+      }
+    }
+    if (slot == m->capacity) {
+      const TLBT_UINT32_T available = TLBT_MAP_FUNC_INTERNAL(group_match_available)(group);
+      if (available != 0)
+        slot = TLBT_MAP_WRAP_GROUP(pos + TLBT_MAP_FUNC_INTERNAL(ctz)(available), m->capacity);
+    }
+    if (TLBT_MAP_FUNC_INTERNAL(group_match_empty)(group))
+      break;
+    pos = TLBT_MAP_WRAP_GROUP(pos + TLBT_GROUP_WIDTH, m->capacity);
+  }
+  *out_index = slot;
+  return false;
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_occupied)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_MAP_HASH_T hash) {
+  TLBT_MAP_FUNC_INTERNAL(set_ctrl)(m, i, TLBT_CTRL_H2(hash));
+  TLBT_MAP_MARK_OCCUPIED(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(erase)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  TLBT_MAP_FUNC_INTERNAL(set_ctrl)(m, i, TLBT_CTRL_DELETED);
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(reset_slots)(TLBT_MAP_TYPE *const m) {
+  TLBT_MEMSET(m->ctrl, TLBT_CTRL_EMPTY, m->capacity + TLBT_GROUP_WIDTH);
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+}
+
+// rehash helpers. entries waiting to be placed are marked as deleted so find_empty treats their slots as available
+static inline void TLBT_MAP_FUNC_INTERNAL(mark_pending)(TLBT_MAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i)
+    m->ctrl[i] = (m->ctrl[i] & TLBT_CTRL_EMPTY) ? TLBT_CTRL_EMPTY : TLBT_CTRL_DELETED;
+  for (TLBT_SIZE_T i = 0; i < TLBT_GROUP_WIDTH; ++i)
+    m->ctrl[m->capacity + i] = m->ctrl[i % m->capacity];
+}
+
+static inline bool TLBT_MAP_FUNC_INTERNAL(is_pending)(const TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  return m->ctrl[i] == TLBT_CTRL_DELETED;
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_empty)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  TLBT_MAP_FUNC_INTERNAL(set_ctrl)(m, i, TLBT_CTRL_EMPTY);
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+// lookups check whole groups so an entry can stay where it is if it's in the same group as the first free slot
+static inline bool TLBT_MAP_FUNC_INTERNAL(same_probe_group)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash,
+                                                            TLBT_SIZE_T a, TLBT_SIZE_T b) {
+  const TLBT_SIZE_T pos = TLBT_MAP_HOME(hash, m->capacity);
+  return TLBT_MAP_WRAP(a + m->capacity - pos, m->capacity) / TLBT_GROUP_WIDTH ==
+         TLBT_MAP_WRAP(b + m->capacity - pos, m->capacity) / TLBT_GROUP_WIDTH;
+}
+
+#elif defined(TLBT_MAP_ROBIN_HOOD)
+
+#define TLBT_DISTANCE(flags) ((flags) & TLBT_INDEX_MASK)
+
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_entry)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                    TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  for (TLBT_MAP_INDEX_T dist = 0; dist < m->capacity; ++dist) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    // an entry closer to its home slot than we are to ours means the key would have displaced it on insertion
+    if (!TLBT_IS_OCCUPIED(entry->index) || TLBT_DISTANCE(entry->index) < dist)
+      return false;
+    // equal keys have the same home slot and therefore the same distance
+    if (TLBT_DISTANCE(entry->index) == dist && !TLBT_IS_DELETED(entry->index) && TLBT_MAP_HASH_MATCHES(entry, hash) &&
+        TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      *out_index = i;
+      return true;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+  return false;
+}
+
+// places the carried entry at slot i or further down the probe sequence. carry.index holds its distance at slot i.
+// returns the slot of the carried entry. entries further down the probe sequence might have been displaced
+#ifdef TLBT_VALUE_T
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(displace)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i,
+                                                           TLBT_MAP_KEY_TYPE carry, TLBT_VALUE_T value) {
+#else
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(displace)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i,
+                                                           TLBT_MAP_KEY_TYPE carry) {
+#endif
+  TLBT_SIZE_T result = m->capacity;
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    if (!TLBT_IS_OCCUPIED(entry->index)) {
+      *entry = carry;
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_VALUE(m, i) = value;
+#endif
+      TLBT_MAP_MARK_OCCUPIED(m, i);
+      return result == m->capacity ? i : result;
+    }
+    if (TLBT_DISTANCE(entry->index) < TLBT_DISTANCE(carry.index)) {
+      // the resident is closer to its home slot, so it has to make room and continues probing instead
+#ifdef TLBT_VALUE_T
+      // read before the entry is overwritten because interleaved values are part of it
+      TLBT_VALUE_T tmp_value = TLBT_MAP_VALUE(m, i);
+#endif
+      TLBT_MAP_KEY_TYPE tmp = *entry;
+      *entry = carry;
+      carry = tmp;
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_VALUE(m, i) = value;
+      value = tmp_value;
+#endif
+      if (result == m->capacity)
+        result = i;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+    ++carry.index;
+  }
+  // should never reach
+  return 0;
+}
+
+// returns the slot of the inserted key
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(emplace)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                        TLBT_MAP_HASH_T hash) {
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(emplace)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash) {
+#endif
+  // the entry which still needs a slot. incrementing the index increments the distance
+  TLBT_MAP_KEY_TYPE carry;
+  carry.key = key;
+  carry.index = TLBT_OCCUPIED_BIT;
+#ifdef TLBT_MAP_STORE_HASH
+  carry.hash = hash;
+#endif
+#ifdef TLBT_VALUE_T
+  return TLBT_MAP_FUNC_INTERNAL(displace)(m, TLBT_MAP_HOME(hash, m->capacity), carry, value);
+#else
+  return TLBT_MAP_FUNC_INTERNAL(displace)(m, TLBT_MAP_HOME(hash, m->capacity), carry);
+#endif
+}
+
+// find_entry and finding the insert position in one probe sequence. if the key doesn't exist out_index is the slot
+// where it has to be inserted with place
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_slot)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                   TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  for (TLBT_MAP_INDEX_T dist = 0;; ++dist) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    if (!TLBT_IS_OCCUPIED(entry->index) || TLBT_DISTANCE(entry->index) < dist) {
+      *out_index = i;
+      return false;
+    }
+    if (TLBT_DISTANCE(entry->index) == dist && TLBT_MAP_HASH_MATCHES(entry, hash) &&
+        TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      *out_index = i;
+      return true;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+  // should never reach
+  return false;
+}
+
+// stores the key in the slot returned by find_slot. the resident entry moves further down the probe sequence
+static inline void TLBT_MAP_FUNC_INTERNAL(place)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_KEY_T key,
+                                                 TLBT_MAP_HASH_T hash) {
+  const TLBT_SIZE_T dist = TLBT_MAP_WRAP(i + m->capacity - TLBT_MAP_HOME(hash, m->capacity), m->capacity);
+  if (TLBT_IS_OCCUPIED(m->keys[i].index)) {
+    TLBT_MAP_KEY_TYPE resident = m->keys[i];
+    ++resident.index;
+#ifdef TLBT_VALUE_T
+    TLBT_MAP_FUNC_INTERNAL(displace)(m, TLBT_MAP_WRAP(i + 1, m->capacity), resident, TLBT_MAP_VALUE(m, i));
+#else
+    TLBT_MAP_FUNC_INTERNAL(displace)(m, TLBT_MAP_WRAP(i + 1, m->capacity), resident);
+#endif
+  }
+  m->keys[i].key = key;
+  m->keys[i].index = TLBT_OCCUPIED_BIT | (TLBT_MAP_INDEX_T)dist;
+#ifdef TLBT_MAP_STORE_HASH
+  m->keys[i].hash = hash;
+#endif
+  TLBT_MAP_MARK_OCCUPIED(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(erase)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  // backward shift: move the following entries one slot closer to their home until reaching an empty slot or an entry
+  // which already is in its home slot. this leaves the table as if the removed key was never inserted
+  TLBT_SIZE_T next = TLBT_MAP_WRAP(i + 1, m->capacity);
+  while (TLBT_IS_OCCUPIED(m->keys[next].index) && TLBT_DISTANCE(m->keys[next].index) != 0) {
+    m->keys[i] = m->keys[next];
+    --m->keys[i].index;
+#ifdef TLBT_MAP_SPLIT_VALUES
+    m->values[i] = m->values[next];
+#endif
+    i = next;
+    next = TLBT_MAP_WRAP(next + 1, m->capacity);
+  }
+  m->keys[i].index = 0;
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(reset_slots)(TLBT_MAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i)
+    m->keys[i].index = 0;
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+}
+
+#elif defined(TLBT_MAP_INTEGER_KEY)
+
+// same probing as without TLBT_MAP_INTEGER_KEY. the slot state is the key, so the loaded key is compared right away
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_entry)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                    TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  const TLBT_SIZE_T start = i;
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    if (entry->key == TLBT_MAP_EMPTY_KEY)
+      return false;
+    if (entry->key != TLBT_MAP_DELETED_KEY && TLBT_MAP_HASH_MATCHES(entry, hash) &&
+        TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      *out_index = i;
+      return true;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+    if (i == start)
+      return false;
+  }
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(find_empty)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    if (!TLBT_MAP_SLOT_OCCUPIED(m, i))
+      return i;
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+}
+
+// find_entry and find_empty in one probe sequence. if the key doesn't exist out_index is the first tombstone or empty
+// slot to insert it into
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_slot)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                   TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  TLBT_SIZE_T slot = m->capacity;
+  for (TLBT_SIZE_T probed = 0; probed < m->capacity; ++probed) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    if (entry->key == TLBT_MAP_EMPTY_KEY) {
+      if (slot == m->capacity)
+        slot = i;
+      break;
+    } else if (entry->key == TLBT_MAP_DELETED_KEY) {
+      if (slot == m->capacity)
+        slot = i;
+    } else if (TLBT_MAP_HASH_MATCHES(entry, hash) && TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      *out_index = i;
+      return true;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+  *out_index = slot;
+  return false;
+}
+
+// place already wrote the key which marks the slot as occupied, unless it's one of the sentinels
+static inline void TLBT_MAP_FUNC_INTERNAL(set_occupied)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_MAP_HASH_T hash) {
+  (void)m;
+  (void)i;
+  (void)hash;
+  TLBT_ASSERT(TLBT_MAP_SLOT_OCCUPIED(m, i) && "The empty and deleted keys can't be inserted");
+  TLBT_MAP_MARK_OCCUPIED(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(erase)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  m->keys[i].key = TLBT_MAP_DELETED_KEY;
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_empty)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  m->keys[i].key = TLBT_MAP_EMPTY_KEY;
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(reset_slots)(TLBT_MAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i)
+    m->keys[i].key = TLBT_MAP_EMPTY_KEY;
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+}
+
+#else
+
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_entry)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                    TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  const TLBT_SIZE_T start = i;
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    const TLBT_MAP_INDEX_T flags = TLBT_MAP_FLAGS(m, entry);
+    if (!TLBT_IS_OCCUPIED(flags) && !TLBT_IS_DELETED(flags)) {
+      return false;
+    } else if (TLBT_IS_OCCUPIED(flags) && TLBT_MAP_HASH_MATCHES(entry, hash) &&
+               TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      // deleted entries still hold their old key so they must not be compared
+      *out_index = i;
+      return true;
+    } else {
+      // deleted or occupied and not the same
+      // if an entry was deleted we still have to continue searching because it might have been inserted after that
+      i = TLBT_MAP_WRAP(i + 1, m->capacity);
+      if (i == start)
+        return false;
+    }
+  }
+  // should never reach
+  return false;
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(find_empty)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  for (;;) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_MAP_INDEX_T flags = TLBT_MAP_FLAGS(m, &m->keys[i]);
+    if (!TLBT_IS_OCCUPIED(flags) || TLBT_IS_DELETED(flags)) {
+      return i;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+  // should never reach
+  return 0;
+}
+
+// find_entry and find_empty in one probe sequence. if the key doesn't exist out_index is the first tombstone or empty
+// slot to insert it into
+TLBT_INLINE bool TLBT_MAP_FUNC_INTERNAL(find_slot)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                   TLBT_SIZE_T *out_index) {
+  TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+  TLBT_SIZE_T slot = m->capacity;
+  for (TLBT_SIZE_T probed = 0; probed < m->capacity; ++probed) {
+    TLBT_MAP_COUNT(m, probes, 1);
+    const TLBT_MAP_KEY_TYPE *entry = &m->keys[i];
+    const TLBT_MAP_INDEX_T flags = TLBT_MAP_FLAGS(m, entry);
+    if (!TLBT_IS_OCCUPIED(flags)) {
+      if (slot == m->capacity)
+        slot = i;
+      if (!TLBT_IS_DELETED(flags))
+        break;
+    } else if (TLBT_MAP_HASH_MATCHES(entry, hash) && TLBT_MAP_KEYS_EQUAL(m, entry->key, key)) {
+      *out_index = i;
+      return true;
+    }
+    i = TLBT_MAP_WRAP(i + 1, m->capacity);
+  }
+  *out_index = slot;
+  return false;
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_occupied)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_MAP_HASH_T hash) {
+  (void)hash;
+  m->keys[i].index = TLBT_MAP_GENERATION(m) | TLBT_OCCUPIED_BIT;
+  TLBT_MAP_MARK_OCCUPIED(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(erase)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  m->keys[i].index = TLBT_MAP_GENERATION(m) | TLBT_DELETED_BIT;
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(reset_slots)(TLBT_MAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i)
+    m->keys[i].index = 0;
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+}
+
+// rehash helpers. entries waiting to be placed have both bits set so find_empty treats their slots as available
+static inline void TLBT_MAP_FUNC_INTERNAL(mark_pending)(TLBT_MAP_TYPE *const m) {
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i) {
+    m->keys[i].index = TLBT_IS_OCCUPIED(TLBT_MAP_FLAGS(m, &m->keys[i]))
+                           ? (TLBT_MAP_GENERATION(m) | TLBT_OCCUPIED_BIT | TLBT_DELETED_BIT)
+                           : 0;
+  }
+}
+
+static inline bool TLBT_MAP_FUNC_INTERNAL(is_pending)(const TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  return TLBT_MAP_FLAGS(m, &m->keys[i]) == (TLBT_MAP_GENERATION(m) | TLBT_OCCUPIED_BIT | TLBT_DELETED_BIT);
+}
+
+static inline void TLBT_MAP_FUNC_INTERNAL(set_empty)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+  m->keys[i].index = 0;
+  TLBT_MAP_MARK_FREE(m, i);
+}
+
+static inline bool TLBT_MAP_FUNC_INTERNAL(same_probe_group)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash,
+                                                            TLBT_SIZE_T a, TLBT_SIZE_T b) {
+  (void)m;
+  (void)hash;
+  return a == b;
+}
+
+#endif
+
+#ifndef TLBT_MAP_ROBIN_HOOD
+// stores the key in a free slot returned by find_empty or find_slot
+static inline void TLBT_MAP_FUNC_INTERNAL(place)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i, TLBT_KEY_T key,
+                                                 TLBT_MAP_HASH_T hash) {
+  m->keys[i].key = key;
+#ifdef TLBT_MAP_STORE_HASH
+  m->keys[i].hash = hash;
+#endif
+  TLBT_MAP_FUNC_INTERNAL(set_occupied)(m, i, hash);
+}
+
+// returns the slot of the inserted key
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(emplace)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                        TLBT_MAP_HASH_T hash) {
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(emplace)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash) {
+#endif
+  const TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(find_empty)(m, hash);
+  TLBT_MAP_FUNC_INTERNAL(place)(m, i, key, hash);
+#ifdef TLBT_VALUE_T
+  TLBT_MAP_VALUE(m, i) = value;
+#endif
+  return i;
+}
+#endif
+
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+// removes an entry of an old table during a resize. old tables never get new entries so robin hood entries are only
+// flagged instead of shifting the following entries back, which might move already migrated slots
+static inline void TLBT_MAP_FUNC_INTERNAL(retire)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T i) {
+#ifdef TLBT_MAP_ROBIN_HOOD
+  m->keys[i].index |= TLBT_DELETED_BIT;
+  TLBT_MAP_MARK_FREE(m, i);
+#else
+  TLBT_MAP_FUNC_INTERNAL(erase)(m, i);
+#endif
+  --m->count;
+}
+#endif
+
+#ifdef TLBT_DYNAMIC_MEMORY
+
+// allocates an array of a table. zero asks for zeroed memory. mmapped and calloced memory can come straight from the
+// OS, which zeroes its pages on their first write instead of up front
+static inline void *TLBT_MAP_FUNC_INTERNAL(alloc)(TLBT_SIZE_T bytes, bool zero) {
+#ifdef TLBT_MAP_MMAP
+  if (bytes >= TLBT_MAP_MMAP_THRESHOLD) {
+#ifdef MAP_ANONYMOUS
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#else
+    void *p = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+#endif
+    if (p == MAP_FAILED)
+      return NULL;
+#if defined(TLBT_MAP_HUGE_PAGES) && defined(MADV_HUGEPAGE)
+    madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    return p;
+  }
+#endif
+  if (!zero)
+    return TLBT_MALLOC(bytes);
+#ifdef TLBT_CALLOC
+  return TLBT_CALLOC(1, bytes);
+#else
+  void *p = TLBT_MALLOC(bytes);
+  TLBT_MEMSET(p, 0, bytes);
+  return p;
+#endif
+}
+
+// frees an array of alloc with the same size
+static inline void TLBT_MAP_FUNC_INTERNAL(release)(void *p, TLBT_SIZE_T bytes) {
+#ifdef TLBT_MAP_MMAP
+  if (bytes >= TLBT_MAP_MMAP_THRESHOLD) {
+    munmap(p, bytes);
+    return;
+  }
+#else
+  (void)bytes;
+#endif
+  TLBT_FREE(p);
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(create)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity) {
+  m->capacity = capacity;
+#ifdef TLBT_BASE2_CAPACITY
+  TLBT_ASSERT((capacity != 0 && (capacity & (capacity - 1)) == 0));
+#endif
+  // nothing gets written to zeroed slots, so their pages are only committed once entries get inserted
+  m->keys = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_MAP_KEY_TYPE) * capacity, TLBT_MAP_ZEROED_SLOTS);
+#ifdef TLBT_MAP_SIMD_PROBE
+  m->ctrl = TLBT_MAP_FUNC_INTERNAL(alloc)(capacity + TLBT_GROUP_WIDTH, false);
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  m->occupancy = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(capacity), true);
+#endif
+  if (!TLBT_MAP_ZEROED_SLOTS)
+    TLBT_MAP_FUNC_INTERNAL(reset_slots)(m);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  m->values = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_VALUE_T) * capacity, false);
+#endif
+  m->count = 0;
+#ifdef TLBT_MAP_EPOCH
+  m->epoch = 1;
+#endif
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  m->old = NULL;
+  m->migrated = 0;
+#endif
+#ifdef TLBT_MAP_COUNTERS
+  TLBT_MEMSET(&m->counters, 0, sizeof(m->counters));
+#endif
 }
 
 TLBT_INLINE void TLBT_MAP_FUNC(destroy)(TLBT_MAP_TYPE *const m) {
-  TLBT_FREE(m->keys);
+  TLBT_MAP_FUNC_INTERNAL(release)(m->keys, sizeof(TLBT_MAP_KEY_TYPE) * m->capacity);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  TLBT_MAP_FUNC_INTERNAL(release)(m->values, sizeof(TLBT_VALUE_T) * m->capacity);
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  TLBT_MAP_FUNC_INTERNAL(release)(m->ctrl, m->capacity + TLBT_GROUP_WIDTH);
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MAP_FUNC_INTERNAL(release)(m->occupancy, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  if (m->old) {
+    TLBT_MAP_FUNC(destroy)(m->old);
+    TLBT_FREE(m->old);
+    m->old = NULL;
+  }
+#endif
+}
+
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+// moves up to `slots` slots of the old table into the current one and frees the old table once it's empty
+static inline void TLBT_MAP_FUNC_INTERNAL(migrate)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T slots) {
+  TLBT_MAP_TYPE *old = m->old;
+  if (!old)
+    return;
+
+  const TLBT_SIZE_T end = old->capacity - m->migrated <= slots ? old->capacity : m->migrated + slots;
+  for (; m->migrated < end && old->count > 0; ++m->migrated) {
+    const TLBT_SIZE_T i = m->migrated;
+    if (TLBT_MAP_SLOT_OCCUPIED(old, i)) {
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_FUNC_INTERNAL(emplace)(m, old->keys[i].key, TLBT_MAP_VALUE(old, i), TLBT_MAP_ENTRY_HASH(old, i));
+#else
+      TLBT_MAP_FUNC_INTERNAL(emplace)(m, old->keys[i].key, TLBT_MAP_ENTRY_HASH(old, i));
+#endif
+      TLBT_MAP_COUNT(m, bytes_rehashed, TLBT_MAP_ENTRY_BYTES);
+      // otherwise a lookup could still find it in the old table after it got removed from the new one
+      TLBT_MAP_FUNC_INTERNAL(retire)(old, i);
+    }
+  }
+
+  if (old->count == 0) {
+#ifdef TLBT_MAP_COUNTERS
+    m->counters.probes += old->counters.probes;
+    m->counters.equals += old->counters.equals;
+#endif
+    TLBT_MAP_FUNC(destroy)(old);
+    TLBT_FREE(old);
+    m->old = NULL;
+  }
+}
+#endif
+
+TLBT_INLINE void TLBT_MAP_FUNC(ensure_capacity)(TLBT_MAP_TYPE *const m) {
+  if (m->count + 1 > (float)m->capacity * TLBT_MAX_LOAD_FACTOR) {
+    const TLBT_SIZE_T capacity = m->capacity * 2;
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+    // a previous migration only is still going on if TLBT_MAP_MIGRATE_STEP is too small
+    TLBT_MAP_FUNC_INTERNAL(migrate)(m, (TLBT_SIZE_T)-1);
+    TLBT_MAP_TYPE *old = TLBT_MALLOC(sizeof(TLBT_MAP_TYPE));
+    *old = *m;
+    TLBT_MAP_FUNC(create)(m, capacity);
+    m->count = old->count;
+    m->old = old;
+#ifdef TLBT_MAP_COUNTERS
+    // lookups in the old table count there until the migration is done and they get added back
+    m->counters = old->counters;
+    TLBT_MEMSET(&old->counters, 0, sizeof(old->counters));
+    ++m->counters.resizes;
+#endif
+#else
+    TLBT_MAP_FUNC(adjust_capacity)(m, capacity);
+#endif
+  }
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(adjust_capacity)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, (TLBT_SIZE_T)-1);
+#endif
+  TLBT_ASSERT(m->count < capacity);
+  TLBT_MAP_TYPE n = {0};
+  TLBT_MAP_FUNC(create)(&n, capacity);
+#ifdef TLBT_MAP_COUNTERS
+  n.counters = m->counters;
+  ++n.counters.resizes;
+#endif
+
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i) {
+    if (TLBT_MAP_SLOT_OCCUPIED(m, i)) {
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_FUNC_INTERNAL(emplace)(&n, m->keys[i].key, TLBT_MAP_VALUE(m, i), TLBT_MAP_ENTRY_HASH(m, i));
+#else
+      TLBT_MAP_FUNC_INTERNAL(emplace)(&n, m->keys[i].key, TLBT_MAP_ENTRY_HASH(m, i));
+#endif
+      TLBT_MAP_COUNT(&n, bytes_rehashed, TLBT_MAP_ENTRY_BYTES);
+    }
+  }
+
+  n.count = m->count;
+  TLBT_MAP_FUNC(destroy)(m);
+  *m = n;
+}
+
+// the smallest capacity which is at most half of the max load factor full. that leaves room to grow again before the
+// next resize. capacities which aren't a power of 2 are computed directly like in reserve
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(shrink_target)(const TLBT_MAP_TYPE *const m) {
+#ifdef TLBT_BASE2_CAPACITY
+  TLBT_SIZE_T capacity = TLBT_MAP_MIN_CAPACITY;
+  while (m->count > (float)capacity * (TLBT_MAX_LOAD_FACTOR / 2))
+    capacity *= 2;
+#else
+  TLBT_SIZE_T capacity = (TLBT_SIZE_T)((double)m->count / (TLBT_MAX_LOAD_FACTOR / 2));
+  while (m->count > (float)capacity * (TLBT_MAX_LOAD_FACTOR / 2))
+    ++capacity;
+  if (capacity < TLBT_MAP_MIN_CAPACITY)
+    capacity = TLBT_MAP_MIN_CAPACITY;
+#endif
+  return capacity;
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(shrink_to_fit)(TLBT_MAP_TYPE *const m) {
+  const TLBT_SIZE_T capacity = TLBT_MAP_FUNC_INTERNAL(shrink_target)(m);
+  if (capacity * 2 <= m->capacity)
+    TLBT_MAP_FUNC(adjust_capacity)(m, capacity);
+  else
+    TLBT_MAP_FUNC(rehash)(m);
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(reserve)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T n) {
+  // the same check as ensure_capacity so inserting the nth entry doesn't grow the map
+  if (n <= (float)m->capacity * TLBT_MAX_LOAD_FACTOR)
+    return;
+#ifdef TLBT_BASE2_CAPACITY
+  TLBT_SIZE_T capacity = m->capacity;
+  while (n > (float)capacity * TLBT_MAX_LOAD_FACTOR)
+    capacity *= 2;
+#else
+  TLBT_SIZE_T capacity = (TLBT_SIZE_T)((double)n / TLBT_MAX_LOAD_FACTOR);
+  while (n > (float)capacity * TLBT_MAX_LOAD_FACTOR)
+    ++capacity;
+#endif
+  TLBT_MAP_FUNC(adjust_capacity)(m, capacity);
+}
+
+#else
+
+#ifdef TLBT_MAP_SIMD_PROBE
+#ifdef TLBT_MAP_SPLIT_VALUES
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
+                                     TLBT_VALUE_T *value_buffer, TLBT_UINT8_T *ctrl_buffer) {
+  m->values = value_buffer;
+#else
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
+                                     TLBT_UINT8_T *ctrl_buffer) {
+#endif
+  m->ctrl = ctrl_buffer;
+#else
+#ifdef TLBT_MAP_SPLIT_VALUES
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
+                                     TLBT_VALUE_T *value_buffer) {
+  m->values = value_buffer;
+#else
+TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer) {
+#endif
+#endif
+  m->keys = key_buffer;
+  m->capacity = capacity;
+#if defined(TLBT_MAP_SIMD_PROBE) || defined(TLBT_MAP_INTEGER_KEY)
+  TLBT_MAP_FUNC_INTERNAL(reset_slots)(m);
+#else
+  TLBT_MEMSET(m->keys, 0, sizeof(TLBT_MAP_KEY_TYPE) * capacity);
+#endif
+#ifdef TLBT_BASE2_CAPACITY
+  TLBT_ASSERT((capacity != 0 && (capacity & (capacity - 1)) == 0));
+#endif
+  m->count = 0;
+#ifdef TLBT_MAP_EPOCH
+  m->epoch = 1;
+#endif
+#ifdef TLBT_MAP_COUNTERS
+  TLBT_MEMSET(&m->counters, 0, sizeof(m->counters));
+#endif
+}
+#endif
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                          TLBT_MAP_HASH_T hash) {
+#else
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash) {
+#endif
+#ifdef TLBT_DYNAMIC_MEMORY
+  TLBT_MAP_FUNC(ensure_capacity)(m);
+#else
+  if (m->count + 1 > (float)m->capacity * TLBT_MAX_LOAD_FACTOR)
+    return false;
+#endif
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+
+  // not finding an empty slot will not happen because the function will either auto resize
+  // once the load factor is reached or it will return false before that happens
+  // depending on the memory mode
+#ifdef TLBT_VALUE_T
+  TLBT_MAP_FUNC_INTERNAL(emplace)(m, key, value, hash);
+#else
+  TLBT_MAP_FUNC_INTERNAL(emplace)(m, key, hash);
+#endif
+  ++m->count;
+  return true;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(remove_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  if (m->count == 0)
+    return false;
+
+  TLBT_SIZE_T i = 0;
+  if (TLBT_MAP_FUNC_INTERNAL(find_entry)(m, key, hash, &i)) {
+    TLBT_MAP_FUNC_INTERNAL(erase)(m, i);
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  } else if (m->old && TLBT_MAP_FUNC_INTERNAL(find_entry)(m->old, key, hash, &i)) {
+    TLBT_MAP_FUNC_INTERNAL(retire)(m->old, i);
+#endif
+  } else {
+    return false;
+  }
+
+  --m->count;
+#ifdef TLBT_MAP_AUTO_SHRINK
+  // only shrinks. rehashing the tombstones away in place would cost a pass over the table on every remove of a map
+  // which can't shrink any further
+  if (m->capacity > TLBT_MAP_MIN_CAPACITY && m->count < (float)m->capacity * TLBT_MIN_LOAD_FACTOR) {
+    const TLBT_SIZE_T capacity = TLBT_MAP_FUNC_INTERNAL(shrink_target)(m);
+    if (capacity * 2 <= m->capacity)
+      TLBT_MAP_FUNC(adjust_capacity)(m, capacity);
+  }
+#endif
+  return true;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(contains_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  if (m->count == 0)
+    return false;
+  TLBT_SIZE_T i = 0;
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  if (m->old && TLBT_MAP_FUNC_INTERNAL(find_entry)(m->old, key, hash, &i))
+    return true;
+#endif
+  return TLBT_MAP_FUNC_INTERNAL(find_entry)(m, key, hash, &i);
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FUNC(get_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                       TLBT_MAP_HASH_T hash) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  if (m->count == 0)
+    return false;
+
+  TLBT_SIZE_T i = 0;
+  if (TLBT_MAP_FUNC_INTERNAL(find_entry)(m, key, hash, &i)) {
+    *out = TLBT_MAP_VALUE(m, i);
+    return true;
+  }
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  if (m->old && TLBT_MAP_FUNC_INTERNAL(find_entry)(m->old, key, hash, &i)) {
+    *out = TLBT_MAP_VALUE(m->old, i);
+    return true;
+  }
+#endif
+  return false;
+}
+#endif
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FUNC(insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_MAP_FUNC(insert_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+#else
+TLBT_INLINE bool TLBT_MAP_FUNC(insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_MAP_FUNC(insert_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+#endif
+
+TLBT_INLINE bool TLBT_MAP_FUNC(remove)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_MAP_FUNC(remove_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(contains)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
+  return TLBT_MAP_FUNC(contains_ph)(m, key, TLBT_HASH_FUNC(key));
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE bool TLBT_MAP_FUNC(get)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out) {
+  return TLBT_MAP_FUNC(get_ph)(m, key, out, TLBT_HASH_FUNC(key));
+}
+
+TLBT_INLINE TLBT_VALUE_T *TLBT_MAP_FUNC(get_or_insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_MAP_HASH_T hash,
+                                                          bool *out_inserted) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  *out_inserted = false;
+  TLBT_SIZE_T i = 0;
+  if (TLBT_MAP_FUNC_INTERNAL(find_slot)(m, key, hash, &i))
+    return &TLBT_MAP_VALUE(m, i);
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_SIZE_T old_index = 0;
+  if (m->old && TLBT_MAP_FUNC_INTERNAL(find_entry)(m->old, key, hash, &old_index))
+    return &TLBT_MAP_VALUE(m->old, old_index);
+#endif
+
+  if (m->count + 1 > (float)m->capacity * TLBT_MAX_LOAD_FACTOR) {
+#ifdef TLBT_DYNAMIC_MEMORY
+    // the slot is gone after resizing. only happens once per resize so probing again is fine
+    TLBT_MAP_FUNC(ensure_capacity)(m);
+    TLBT_MAP_FUNC_INTERNAL(find_slot)(m, key, hash, &i);
+#else
+    return 0;
+#endif
+  }
+
+  TLBT_MAP_FUNC_INTERNAL(place)(m, i, key, hash);
+  ++m->count;
+  *out_inserted = true;
+  return &TLBT_MAP_VALUE(m, i);
+}
+
+TLBT_INLINE TLBT_VALUE_T *TLBT_MAP_FUNC(get_or_insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, bool *out_inserted) {
+  return TLBT_MAP_FUNC(get_or_insert_ph)(m, key, TLBT_HASH_FUNC(key), out_inserted);
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_or_assign_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
+                                                    TLBT_MAP_HASH_T hash) {
+  bool inserted = false;
+  TLBT_VALUE_T *slot = TLBT_MAP_FUNC(get_or_insert_ph)(m, key, hash, &inserted);
+  if (!slot)
+    return false;
+  *slot = value;
+  return true;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(insert_or_assign)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
+  return TLBT_MAP_FUNC(insert_or_assign_ph)(m, key, value, TLBT_HASH_FUNC(key));
+}
+#endif
+
+// prefetches everything a lookup touches first. the old table of an incremental resize is not worth it
+static inline void TLBT_MAP_FUNC_INTERNAL(prefetch)(const TLBT_MAP_TYPE *const m, TLBT_MAP_HASH_T hash) {
+  const TLBT_SIZE_T i = TLBT_MAP_HOME(hash, m->capacity);
+#ifdef TLBT_MAP_SIMD_PROBE
+  TLBT_PREFETCH(&m->ctrl[i]);
+#endif
+  TLBT_PREFETCH(&m->keys[i]);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  TLBT_PREFETCH(&m->values[i]);
+#endif
+}
+
+// returns the table containing the key or NULL
+static inline TLBT_MAP_TYPE *TLBT_MAP_FUNC_INTERNAL(lookup)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key,
+                                                            TLBT_MAP_HASH_T hash, TLBT_SIZE_T *out_index) {
+  if (m->count == 0)
+    return 0;
+  if (TLBT_MAP_FUNC_INTERNAL(find_entry)(m, key, hash, out_index))
+    return m;
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  if (m->old && TLBT_MAP_FUNC_INTERNAL(find_entry)(m->old, key, hash, out_index))
+    return m->old;
+#endif
+  return 0;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(get_batch_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                    const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n,
+                                                    TLBT_VALUE_T *out_values, bool *out_found) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  for (TLBT_SIZE_T i = 0; i < n && i < TLBT_MAP_PREFETCH_DISTANCE; ++i)
+    TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i]);
+
+  TLBT_SIZE_T found = 0;
+  for (TLBT_SIZE_T i = 0; i < n; ++i) {
+    if (i + TLBT_MAP_PREFETCH_DISTANCE < n)
+      TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i + TLBT_MAP_PREFETCH_DISTANCE]);
+    TLBT_SIZE_T slot = 0;
+    const TLBT_MAP_TYPE *table = TLBT_MAP_FUNC_INTERNAL(lookup)(m, keys[i], hashes[i], &slot);
+    out_found[i] = table != 0;
+    if (table) {
+      out_values[i] = TLBT_MAP_VALUE(table, slot);
+      ++found;
+    }
+  }
+  return found;
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(get_batch)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                 TLBT_VALUE_T *out_values, bool *out_found) {
+  TLBT_MAP_HASH_T hashes[TLBT_MAP_BATCH_CHUNK];
+  TLBT_SIZE_T found = 0;
+  for (TLBT_SIZE_T start = 0; start < n; start += TLBT_MAP_BATCH_CHUNK) {
+    const TLBT_SIZE_T chunk = n - start < TLBT_MAP_BATCH_CHUNK ? n - start : TLBT_MAP_BATCH_CHUNK;
+    for (TLBT_SIZE_T i = 0; i < chunk; ++i)
+      hashes[i] = TLBT_HASH_FUNC(keys[start + i]);
+    found += TLBT_MAP_FUNC(get_batch_ph)(m, keys + start, hashes, chunk, out_values + start, out_found + start);
+  }
+  return found;
+}
+#endif
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(contains_batch_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                         const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n,
+                                                         bool *out_found) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, TLBT_MAP_MIGRATE_STEP);
+#endif
+  for (TLBT_SIZE_T i = 0; i < n && i < TLBT_MAP_PREFETCH_DISTANCE; ++i)
+    TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i]);
+
+  TLBT_SIZE_T found = 0;
+  for (TLBT_SIZE_T i = 0; i < n; ++i) {
+    if (i + TLBT_MAP_PREFETCH_DISTANCE < n)
+      TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i + TLBT_MAP_PREFETCH_DISTANCE]);
+    TLBT_SIZE_T slot = 0;
+    out_found[i] = TLBT_MAP_FUNC_INTERNAL(lookup)(m, keys[i], hashes[i], &slot) != 0;
+    found += out_found[i];
+  }
+  return found;
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(contains_batch)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                      bool *out_found) {
+  TLBT_MAP_HASH_T hashes[TLBT_MAP_BATCH_CHUNK];
+  TLBT_SIZE_T found = 0;
+  for (TLBT_SIZE_T start = 0; start < n; start += TLBT_MAP_BATCH_CHUNK) {
+    const TLBT_SIZE_T chunk = n - start < TLBT_MAP_BATCH_CHUNK ? n - start : TLBT_MAP_BATCH_CHUNK;
+    for (TLBT_SIZE_T i = 0; i < chunk; ++i)
+      hashes[i] = TLBT_HASH_FUNC(keys[start + i]);
+    found += TLBT_MAP_FUNC(contains_batch_ph)(m, keys + start, hashes, chunk, out_found + start);
+  }
+  return found;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_VALUE_T *values, const TLBT_MAP_HASH_T *hashes,
+                                                      TLBT_SIZE_T n) {
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many_ph)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_MAP_HASH_T *hashes, TLBT_SIZE_T n) {
+#endif
+#ifdef TLBT_DYNAMIC_MEMORY
+  // otherwise inserting grows the map again and again
+  TLBT_MAP_FUNC(reserve)(m, m->count + n);
+#endif
+  for (TLBT_SIZE_T i = 0; i < n && i < TLBT_MAP_PREFETCH_DISTANCE; ++i)
+    TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i]);
+
+  for (TLBT_SIZE_T i = 0; i < n; ++i) {
+    if (i + TLBT_MAP_PREFETCH_DISTANCE < n)
+      TLBT_MAP_FUNC_INTERNAL(prefetch)(m, hashes[i + TLBT_MAP_PREFETCH_DISTANCE]);
+#ifdef TLBT_VALUE_T
+    if (!TLBT_MAP_FUNC(insert_ph)(m, keys[i], values[i], hashes[i]))
+#else
+    if (!TLBT_MAP_FUNC(insert_ph)(m, keys[i], hashes[i]))
+#endif
+      return i;
+  }
+  return n;
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                   const TLBT_VALUE_T *values, TLBT_SIZE_T n) {
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(insert_many)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n) {
+#endif
+#ifdef TLBT_DYNAMIC_MEMORY
+  // the chunks would only reserve space for themselves
+  TLBT_MAP_FUNC(reserve)(m, m->count + n);
+#endif
+  TLBT_MAP_HASH_T hashes[TLBT_MAP_BATCH_CHUNK];
+  TLBT_SIZE_T inserted = 0;
+  for (TLBT_SIZE_T start = 0; start < n; start += TLBT_MAP_BATCH_CHUNK) {
+    const TLBT_SIZE_T chunk = n - start < TLBT_MAP_BATCH_CHUNK ? n - start : TLBT_MAP_BATCH_CHUNK;
+    for (TLBT_SIZE_T i = 0; i < chunk; ++i)
+      hashes[i] = TLBT_HASH_FUNC(keys[start + i]);
+#ifdef TLBT_VALUE_T
+    const TLBT_SIZE_T done = TLBT_MAP_FUNC(insert_many_ph)(m, keys + start, values + start, hashes, chunk);
+#else
+    const TLBT_SIZE_T done = TLBT_MAP_FUNC(insert_many_ph)(m, keys + start, hashes, chunk);
+#endif
+    inserted += done;
+    if (done < chunk)
+      break;
+  }
+  return inserted;
+}
+
+#ifdef TLBT_MAP_PARALLEL_BUILD
+
+#define TLBT_MAP_BUILD_TYPE TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_MAP_TYPE, _build))
+#define TLBT_MAP_BUILD_TASK_TYPE TLBT_COMBINE2(_, TLBT_COMBINE2(TLBT_MAP_TYPE, _build_task))
+
+// shared by all threads of build_parallel. every thread only writes its own part of the arrays and its own region
+// of the table, so nothing needs a lock
+typedef struct TLBT_MAP_BUILD_TYPE {
+  TLBT_MAP_TYPE *map;
+  const TLBT_KEY_T *keys;
+#ifdef TLBT_VALUE_T
+  const TLBT_VALUE_T *values;
+#endif
+  TLBT_MAP_HASH_T *hashes;
+  TLBT_SIZE_T *order;   // input indices sorted by the region of their home slot
+  TLBT_SIZE_T *offsets; // threads * threads. where the keys of input part t for region r go in order
+  TLBT_SIZE_T *starts;  // threads + 1. the part of order belonging to each region
+  TLBT_SIZE_T *left;    // keys of each region which didn't fit. they are moved to the front of its part of order
+  TLBT_SIZE_T n;
+  TLBT_SIZE_T threads;
+  TLBT_SIZE_T region_size;
+  int phase;
+} TLBT_MAP_BUILD_TYPE;
+
+typedef struct TLBT_MAP_BUILD_TASK_TYPE {
+  TLBT_MAP_BUILD_TYPE *build;
+  TLBT_SIZE_T t;
+} TLBT_MAP_BUILD_TASK_TYPE;
+
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(build_region)(const TLBT_MAP_BUILD_TYPE *const b, TLBT_SIZE_T i) {
+  return TLBT_MAP_HOME(b->hashes[i], b->map->capacity) / b->region_size;
+}
+
+static inline void *TLBT_MAP_FUNC_INTERNAL(build_worker)(void *arg) {
+  const TLBT_MAP_BUILD_TASK_TYPE *task = (const TLBT_MAP_BUILD_TASK_TYPE *)arg;
+  TLBT_MAP_BUILD_TYPE *const b = task->build;
+  const TLBT_SIZE_T t = task->t;
+  const TLBT_SIZE_T first = b->n * t / b->threads;
+  const TLBT_SIZE_T last = b->n * (t + 1) / b->threads;
+  TLBT_SIZE_T *const offsets = b->offsets + t * b->threads;
+
+  if (b->phase == 0) {
+    // hashes input part t and counts how many of its keys belong to each region
+    for (TLBT_SIZE_T i = first; i < last; ++i) {
+      b->hashes[i] = TLBT_HASH_FUNC(b->keys[i]);
+      ++offsets[TLBT_MAP_FUNC_INTERNAL(build_region)(b, i)];
+    }
+  } else if (b->phase == 1) {
+    for (TLBT_SIZE_T i = first; i < last; ++i)
+      b->order[offsets[TLBT_MAP_FUNC_INTERNAL(build_region)(b, i)]++] = i;
+  } else {
+    // inserts the keys of region t. probing never leaves the region, the keys which would have to are left over
+    TLBT_MAP_TYPE *const m = b->map;
+    const TLBT_SIZE_T end = (t + 1) * b->region_size < m->capacity ? (t + 1) * b->region_size : m->capacity;
+    TLBT_SIZE_T left = 0;
+    for (TLBT_SIZE_T k = b->starts[t]; k < b->starts[t + 1]; ++k) {
+      const TLBT_SIZE_T i = b->order[k];
+      TLBT_SIZE_T slot = TLBT_MAP_HOME(b->hashes[i], m->capacity);
+      while (slot < end && TLBT_MAP_SLOT_OCCUPIED(m, slot))
+        ++slot;
+      if (slot == end) {
+        b->order[b->starts[t] + left++] = i;
+        continue;
+      }
+      TLBT_MAP_FUNC_INTERNAL(place)(m, slot, b->keys[i], b->hashes[i]);
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_VALUE(m, slot) = b->values[i];
+#endif
+    }
+    b->left[t] = left;
+  }
+  return NULL;
+}
+
+// runs a phase on all threads. the calling thread takes the first part and the parts of threads which couldn't be
+// created
+static inline void TLBT_MAP_FUNC_INTERNAL(build_run)(TLBT_MAP_BUILD_TYPE *const b, int phase, pthread_t *handles,
+                                                      TLBT_MAP_BUILD_TASK_TYPE *tasks) {
+  b->phase = phase;
+  TLBT_SIZE_T started = 1;
+  while (started < b->threads &&
+         pthread_create(&handles[started], NULL, TLBT_MAP_FUNC_INTERNAL(build_worker), &tasks[started]) == 0)
+    ++started;
+  TLBT_MAP_FUNC_INTERNAL(build_worker)(&tasks[0]);
+  for (TLBT_SIZE_T t = started; t < b->threads; ++t)
+    TLBT_MAP_FUNC_INTERNAL(build_worker)(&tasks[t]);
+  for (TLBT_SIZE_T t = 1; t < started; ++t)
+    pthread_join(handles[t], NULL);
+}
+
+#ifdef TLBT_VALUE_T
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(build_parallel)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys,
+                                                      const TLBT_VALUE_T *values, TLBT_SIZE_T n, TLBT_SIZE_T threads) {
+#else
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(build_parallel)(TLBT_MAP_TYPE *const m, const TLBT_KEY_T *keys, TLBT_SIZE_T n,
+                                                      TLBT_SIZE_T threads) {
+#endif
+  if (threads < 2 || n == 0) {
+#ifdef TLBT_VALUE_T
+    return TLBT_MAP_FUNC(insert_many)(m, keys, values, n);
+#else
+    return TLBT_MAP_FUNC(insert_many)(m, keys, n);
+#endif
+  }
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  // the workers only know the current table
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, (TLBT_SIZE_T)-1);
+#endif
+  TLBT_MAP_FUNC(reserve)(m, m->count + n);
+
+  TLBT_MAP_BUILD_TYPE b;
+  b.map = m;
+  b.keys = keys;
+#ifdef TLBT_VALUE_T
+  b.values = values;
+#endif
+  b.n = n;
+  b.threads = threads;
+  // whole words of the occupancy bitmap so no two threads write the same one
+  b.region_size = ((m->capacity + threads - 1) / threads + 63) / 64 * 64;
+  b.hashes = (TLBT_MAP_HASH_T *)TLBT_MALLOC(sizeof(TLBT_MAP_HASH_T) * n);
+  b.order = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * n);
+  b.offsets = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * threads * threads);
+  b.starts = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (threads + 1));
+  b.left = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * threads);
+  pthread_t *handles = (pthread_t *)TLBT_MALLOC(sizeof(pthread_t) * threads);
+  TLBT_MAP_BUILD_TASK_TYPE *tasks = (TLBT_MAP_BUILD_TASK_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_BUILD_TASK_TYPE) * threads);
+  TLBT_ASSERT(b.hashes && b.order && b.offsets && b.starts && b.left && handles && tasks &&
+              "Failed to allocate memory for building");
+  TLBT_MEMSET(b.offsets, 0, sizeof(TLBT_SIZE_T) * threads * threads);
+  for (TLBT_SIZE_T t = 0; t < threads; ++t) {
+    tasks[t].build = &b;
+    tasks[t].t = t;
+  }
+
+  TLBT_MAP_FUNC_INTERNAL(build_run)(&b, 0, handles, tasks);
+  // the counts become offsets. region by region and within a region input part by input part
+  TLBT_SIZE_T offset = 0;
+  for (TLBT_SIZE_T r = 0; r < threads; ++r) {
+    b.starts[r] = offset;
+    for (TLBT_SIZE_T t = 0; t < threads; ++t) {
+      const TLBT_SIZE_T count = b.offsets[t * threads + r];
+      b.offsets[t * threads + r] = offset;
+      offset += count;
+    }
+  }
+  b.starts[threads] = offset;
+  TLBT_MAP_FUNC_INTERNAL(build_run)(&b, 1, handles, tasks);
+  TLBT_MAP_FUNC_INTERNAL(build_run)(&b, 2, handles, tasks);
+
+  for (TLBT_SIZE_T r = 0; r < threads; ++r) {
+    for (TLBT_SIZE_T k = b.starts[r]; k < b.starts[r] + b.left[r]; ++k) {
+      const TLBT_SIZE_T i = b.order[k];
+#ifdef TLBT_VALUE_T
+      TLBT_MAP_FUNC_INTERNAL(emplace)(m, keys[i], values[i], b.hashes[i]);
+#else
+      TLBT_MAP_FUNC_INTERNAL(emplace)(m, keys[i], b.hashes[i]);
+#endif
+    }
+  }
+  m->count += n;
+
+  TLBT_FREE(b.hashes);
+  TLBT_FREE(b.order);
+  TLBT_FREE(b.offsets);
+  TLBT_FREE(b.starts);
+  TLBT_FREE(b.left);
+  TLBT_FREE(handles);
+  TLBT_FREE(tasks);
+  return n;
+}
+
+#endif
+
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+// for tables whose slots were filled in without going through the slot functions
+static inline void TLBT_MAP_FUNC_INTERNAL(occupancy_rebuild)(TLBT_MAP_TYPE *const m) {
+  TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i) {
+    if (TLBT_MAP_SLOT_OCCUPIED(m, i))
+      TLBT_MAP_MARK_OCCUPIED(m, i);
+  }
+}
+#endif
+
+TLBT_INLINE void TLBT_MAP_FUNC(for_each)(TLBT_MAP_TYPE *const m, TLBT_MAP_FUNC(visitor) visitor, void *userdata) {
+  for (TLBT_MAP_TYPE *table = m; table; table = TLBT_MAP_OLD_TABLE(table)) {
+    for (TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, 0); i < table->capacity;
+         i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, i + 1)) {
+#ifdef TLBT_VALUE_T
+      if (!visitor(&table->keys[i].key, &TLBT_MAP_VALUE(table, i), userdata))
+#else
+      if (!visitor(&table->keys[i].key, userdata))
+#endif
+        return;
+    }
+  }
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(stats)(const TLBT_MAP_TYPE *const m, TLBT_MAP_STATS_TYPE *const out) {
+  TLBT_MEMSET(out, 0, sizeof(*out));
+  out->count = m->count;
+  out->capacity = m->capacity;
+  out->load_factor = m->capacity ? (float)m->count / (float)m->capacity : 0.0f;
+
+  TLBT_SIZE_T entries = 0;
+  TLBT_SIZE_T total = 0;
+  for (const TLBT_MAP_TYPE *table = m; table; table = TLBT_MAP_OLD_TABLE(table)) {
+    for (TLBT_SIZE_T i = 0; i < table->capacity; ++i) {
+      if (!TLBT_MAP_SLOT_OCCUPIED(table, i)) {
+#ifdef TLBT_MAP_SIMD_PROBE
+        out->tombstones += table->ctrl[i] == TLBT_CTRL_DELETED;
+#elif defined(TLBT_MAP_INTEGER_KEY)
+        out->tombstones += table->keys[i].key == TLBT_MAP_DELETED_KEY;
+#else
+        // retired robin hood entries of an old table are flagged as deleted as well
+        out->tombstones += TLBT_IS_DELETED(TLBT_MAP_FLAGS(table, &table->keys[i]));
+#endif
+        continue;
+      }
+      const TLBT_SIZE_T home = TLBT_MAP_HOME(TLBT_MAP_ENTRY_HASH(table, i), table->capacity);
+      const TLBT_SIZE_T length = TLBT_MAP_WRAP(i + table->capacity - home, table->capacity) + 1;
+      ++out->histogram[length < TLBT_MAP_STATS_BUCKETS ? length - 1 : TLBT_MAP_STATS_BUCKETS - 1];
+      out->max_probe_length = length > out->max_probe_length ? length : out->max_probe_length;
+      total += length;
+      ++entries;
+    }
+  }
+  out->mean_probe_length = entries ? (float)total / (float)entries : 0.0f;
+}
+
+TLBT_INLINE void TLBT_MAP_FUNC(clear)(TLBT_MAP_TYPE *const m) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  if (m->old) {
+#ifdef TLBT_MAP_COUNTERS
+    m->counters.probes += m->old->counters.probes;
+    m->counters.equals += m->old->counters.equals;
+#endif
+    TLBT_MAP_FUNC(destroy)(m->old);
+    TLBT_FREE(m->old);
+    m->old = NULL;
+  }
+#endif
+  m->count = 0;
+#ifdef TLBT_MAP_EPOCH
+  // reset_slots zeroes every index which belongs to no generation
+  if (m->epoch == TLBT_INDEX_MASK) {
+    m->epoch = 1;
+    TLBT_MAP_FUNC_INTERNAL(reset_slots)(m);
+  } else {
+    ++m->epoch;
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+    TLBT_MEMSET(m->occupancy, 0, sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(m->capacity));
+#endif
+  }
+#else
+  TLBT_MAP_FUNC_INTERNAL(reset_slots)(m);
+#endif
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(copy)(TLBT_MAP_TYPE *const dest, const TLBT_MAP_TYPE *const src) {
+  // a resize in progress spreads the entries over two tables which can't be copied as they are
+  if (dest->capacity != src->capacity || TLBT_MAP_OLD_TABLE(src)) {
+    if ((dest->capacity * TLBT_MAX_LOAD_FACTOR) <= src->count)
+      return false;
+
+    TLBT_MAP_FUNC(clear)(dest);
+    for (const TLBT_MAP_TYPE *table = src; table; table = TLBT_MAP_OLD_TABLE(table)) {
+      for (TLBT_SIZE_T i = 0; i < table->capacity; ++i) {
+        if (TLBT_MAP_SLOT_OCCUPIED(table, i)) {
+#ifdef TLBT_VALUE_T
+          TLBT_MAP_FUNC(insert_ph)(dest, table->keys[i].key, TLBT_MAP_VALUE(table, i), TLBT_MAP_ENTRY_HASH(table, i));
+#else
+          TLBT_MAP_FUNC(insert_ph)(dest, table->keys[i].key, TLBT_MAP_ENTRY_HASH(table, i));
+#endif
+        }
+      }
+    }
+  } else {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+    // drops an old table of dest which would otherwise still be looked into
+    TLBT_MAP_FUNC(clear)(dest);
+#endif
+#ifdef TLBT_MAP_EPOCH
+    dest->epoch = src->epoch;
+#endif
+    for (TLBT_SIZE_T i = 0; i < src->capacity; ++i) {
+      dest->keys[i] = src->keys[i];
+#ifdef TLBT_MAP_SPLIT_VALUES
+      dest->values[i] = src->values[i];
+#endif
+    }
+#ifdef TLBT_MAP_SIMD_PROBE
+    for (TLBT_SIZE_T i = 0; i < src->capacity + TLBT_GROUP_WIDTH; ++i)
+      dest->ctrl[i] = src->ctrl[i];
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+    TLBT_MAP_FUNC_INTERNAL(occupancy_rebuild)(dest);
+#endif
+  }
+  dest->count = src->count;
+  return true;
+}
+
+#ifndef TLBT_VALUE_T
+
+// contains without migrating, so it works on const sets
+static inline bool TLBT_MAP_FUNC_INTERNAL(set_contains)(const TLBT_MAP_TYPE *const m, TLBT_KEY_T key,
+                                                        TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T i = 0;
+  for (const TLBT_MAP_TYPE *table = m; table; table = TLBT_MAP_OLD_TABLE(table)) {
+    if (table->count > 0 && TLBT_MAP_FUNC_INTERNAL(find_entry)(table, key, hash, &i))
+      return true;
+  }
+  return false;
+}
+
+// looks up the keys of src in other and counts the ones which are found (or missing if found is false). they are
+// inserted into out unless it's NULL. no other means every key is missing. false if out is full
+static inline bool TLBT_MAP_FUNC_INTERNAL(set_filter)(const TLBT_MAP_TYPE *const src, const TLBT_MAP_TYPE *const other,
+                                                      bool found, TLBT_MAP_TYPE *const out, TLBT_SIZE_T *count) {
+  TLBT_KEY_T keys[TLBT_MAP_BATCH_CHUNK];
+  TLBT_MAP_HASH_T hashes[TLBT_MAP_BATCH_CHUNK];
+  const TLBT_MAP_TYPE *table = src;
+  TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, 0);
+  while (table) {
+    // gathers a chunk of keys and their hashes first so their slots in other can be prefetched
+    TLBT_SIZE_T n = 0;
+    while (table && n < TLBT_MAP_BATCH_CHUNK) {
+      if (i < table->capacity) {
+        keys[n] = table->keys[i].key;
+        hashes[n++] = TLBT_MAP_ENTRY_HASH(table, i);
+        i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, i + 1);
+      } else {
+        table = TLBT_MAP_OLD_TABLE(table);
+        i = table ? TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, 0) : 0;
+      }
+    }
+
+    for (TLBT_SIZE_T k = 0; other && k < n && k < TLBT_MAP_PREFETCH_DISTANCE; ++k)
+      TLBT_MAP_FUNC_INTERNAL(prefetch)(other, hashes[k]);
+    for (TLBT_SIZE_T k = 0; k < n; ++k) {
+      if (other && k + TLBT_MAP_PREFETCH_DISTANCE < n)
+        TLBT_MAP_FUNC_INTERNAL(prefetch)(other, hashes[k + TLBT_MAP_PREFETCH_DISTANCE]);
+      if ((other && TLBT_MAP_FUNC_INTERNAL(set_contains)(other, keys[k], hashes[k])) != found)
+        continue;
+      ++*count;
+      if (out && !TLBT_MAP_FUNC(insert_ph)(out, keys[k], hashes[k]))
+        return false;
+    }
+  }
+  return true;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(union_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                           const TLBT_MAP_TYPE *const b) {
+  const TLBT_MAP_TYPE *large = a->count >= b->count ? a : b;
+  const TLBT_MAP_TYPE *small = a->count >= b->count ? b : a;
+  TLBT_MAP_FUNC(clear)(out);
+#ifdef TLBT_DYNAMIC_MEMORY
+  TLBT_MAP_FUNC(reserve)(out, a->count + b->count);
+#endif
+  // the keys of the larger set don't have to be looked up anywhere
+  TLBT_SIZE_T count = 0;
+  return TLBT_MAP_FUNC_INTERNAL(set_filter)(large, NULL, false, out, &count) &&
+         TLBT_MAP_FUNC_INTERNAL(set_filter)(small, large, false, out, &count);
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(intersect_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                               const TLBT_MAP_TYPE *const b) {
+  const TLBT_MAP_TYPE *large = a->count >= b->count ? a : b;
+  const TLBT_MAP_TYPE *small = a->count >= b->count ? b : a;
+  TLBT_MAP_FUNC(clear)(out);
+#ifdef TLBT_DYNAMIC_MEMORY
+  TLBT_MAP_FUNC(reserve)(out, small->count);
+#endif
+  TLBT_SIZE_T count = 0;
+  return TLBT_MAP_FUNC_INTERNAL(set_filter)(small, large, true, out, &count);
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(difference_into)(TLBT_MAP_TYPE *const out, const TLBT_MAP_TYPE *const a,
+                                                const TLBT_MAP_TYPE *const b) {
+  TLBT_MAP_FUNC(clear)(out);
+#ifdef TLBT_DYNAMIC_MEMORY
+  TLBT_MAP_FUNC(reserve)(out, a->count);
+#endif
+  TLBT_SIZE_T count = 0;
+  return TLBT_MAP_FUNC_INTERNAL(set_filter)(a, b, false, out, &count);
+}
+
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_FUNC(intersection_count)(const TLBT_MAP_TYPE *const a, const TLBT_MAP_TYPE *const b) {
+  TLBT_SIZE_T count = 0;
+  if (a->count >= b->count)
+    TLBT_MAP_FUNC_INTERNAL(set_filter)(b, a, true, NULL, &count);
+  else
+    TLBT_MAP_FUNC_INTERNAL(set_filter)(a, b, true, NULL, &count);
+  return count;
+}
+
+#endif
+
+#ifdef TLBT_MAP_FREEZE
+
+// splitmix64 finalizer. the bucket and the slot of a key are both derived from its hash
+static inline TLBT_UINT64_T TLBT_MAP_FUNC_INTERNAL(frozen_mix)(TLBT_UINT64_T x) {
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  return x;
+}
+
+// maps x onto [0, n). without TLBT_MAP_LARGE n fits into 32 bits and a multiplication replaces the division
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(frozen_range)(TLBT_UINT64_T x, TLBT_SIZE_T n) {
+#ifdef TLBT_MAP_LARGE
+  return (TLBT_SIZE_T)(x % n);
+#else
+  return (TLBT_SIZE_T)(((x >> 32) * (TLBT_UINT64_T)n) >> 32);
+#endif
+}
+
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(frozen_bucket)(TLBT_MAP_HASH_T hash, TLBT_SIZE_T buckets) {
+  return TLBT_MAP_FUNC_INTERNAL(frozen_range)(TLBT_MAP_FUNC_INTERNAL(frozen_mix)(hash), buckets);
+}
+
+// seeds with the highest bit set are no seeds but the slot of the only key in their bucket
+#define TLBT_MAP_FROZEN_DIRECT ((TLBT_UINT32_T)1 << 31)
+
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(frozen_slot)(TLBT_MAP_HASH_T hash, TLBT_UINT32_T seed,
+                                                              TLBT_SIZE_T slots) {
+  if (seed & TLBT_MAP_FROZEN_DIRECT)
+    return (TLBT_SIZE_T)(seed & ~TLBT_MAP_FROZEN_DIRECT);
+  const TLBT_UINT64_T x = (TLBT_UINT64_T)hash ^ (((TLBT_UINT64_T)seed + 1) * 0x9E3779B97F4A7C15ULL);
+  return TLBT_MAP_FUNC_INTERNAL(frozen_range)(TLBT_MAP_FUNC_INTERNAL(frozen_mix)(x), slots);
+}
+
+// tries one seed after another until all keys of a bucket land in distinct free slots
+static inline bool TLBT_MAP_FUNC_INTERNAL(frozen_search)(TLBT_SIZE_T slots, const TLBT_MAP_HASH_T *hashes,
+                                                         const TLBT_SIZE_T *members, TLBT_SIZE_T size,
+                                                         const bool *taken, TLBT_SIZE_T *positions,
+                                                         TLBT_UINT32_T *out_seed) {
+  for (TLBT_UINT32_T seed = 0; seed < TLBT_MAP_FROZEN_DIRECT; ++seed) {
+    TLBT_SIZE_T placed = 0;
+    for (; placed < size; ++placed) {
+      const TLBT_SIZE_T p = TLBT_MAP_FUNC_INTERNAL(frozen_slot)(hashes[members[placed]], seed, slots);
+      TLBT_SIZE_T k = 0;
+      while (k < placed && positions[k] != p)
+        ++k;
+      if (taken[p] || k < placed)
+        break;
+      positions[placed] = p;
+    }
+    if (placed == size) {
+      *out_seed = seed;
+      return true;
+    }
+  }
+  return false;
+}
+
+// searches a seed for every bucket which moves all of its keys into free slots. on success target receives the
+// final position of every entry in the order they were gathered from the map
+static inline bool TLBT_MAP_FUNC_INTERNAL(frozen_place)(TLBT_MAP_FROZEN_TYPE *const f, const TLBT_MAP_HASH_T *hashes,
+                                                        TLBT_SIZE_T *target) {
+  const TLBT_SIZE_T count = f->count;
+  const TLBT_SIZE_T buckets = f->buckets;
+  TLBT_SIZE_T *const order = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (count + 1));
+  TLBT_SIZE_T *const start = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (buckets + 1));
+  TLBT_SIZE_T *const sizes = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * buckets);
+  TLBT_SIZE_T *const by_size = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * buckets);
+  bool *const taken = (bool *)TLBT_MALLOC(sizeof(bool) * (count + 1));
+  TLBT_ASSERT(order && start && sizes && by_size && taken && "Failed to allocate memory for freezing");
+
+  // sorts the entries by bucket. start[b + 1] counts the entries of bucket b first and becomes its offset afterwards
+  TLBT_MEMSET(start, 0, sizeof(TLBT_SIZE_T) * (buckets + 1));
+  for (TLBT_SIZE_T e = 0; e < count; ++e)
+    ++start[TLBT_MAP_FUNC_INTERNAL(frozen_bucket)(hashes[e], buckets) + 1];
+  for (TLBT_SIZE_T b = 0; b < buckets; ++b)
+    start[b + 1] += start[b];
+  for (TLBT_SIZE_T e = 0; e < count; ++e)
+    order[start[TLBT_MAP_FUNC_INTERNAL(frozen_bucket)(hashes[e], buckets)]++] = e;
+  for (TLBT_SIZE_T b = buckets; b > 0; --b)
+    start[b] = start[b - 1];
+  start[0] = 0;
+
+  // no seed separates keys with the same hash. all but the first of them move to the end of their bucket and from
+  // there into the overflow
+  TLBT_SIZE_T overflow = 0;
+  TLBT_SIZE_T max_size = 0;
+  for (TLBT_SIZE_T b = 0; b < buckets; ++b) {
+    TLBT_SIZE_T end = start[b + 1];
+    for (TLBT_SIZE_T j = start[b] + 1; j < end;) {
+      TLBT_SIZE_T k = start[b];
+      while (k < j && hashes[order[k]] != hashes[order[j]])
+        ++k;
+      if (k == j) {
+        ++j;
+        continue;
+      }
+      const TLBT_SIZE_T tmp = order[j];
+      order[j] = order[--end];
+      order[end] = tmp;
+      ++overflow;
+    }
+    sizes[b] = end - start[b];
+    max_size = sizes[b] > max_size ? sizes[b] : max_size;
+  }
+  f->slots = count - overflow;
+
+  // big buckets are the hardest to place so they go first while most slots are still free. single keys are placed
+  // last and take whatever slot is left without searching a seed
+  TLBT_SIZE_T *const size_start = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (max_size + 2));
+  TLBT_SIZE_T *const positions = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (max_size + 1));
+  TLBT_ASSERT(size_start && positions && "Failed to allocate memory for freezing");
+  TLBT_MEMSET(size_start, 0, sizeof(TLBT_SIZE_T) * (max_size + 2));
+  for (TLBT_SIZE_T b = 0; b < buckets; ++b)
+    ++size_start[max_size - sizes[b] + 1];
+  for (TLBT_SIZE_T i = 0; i <= max_size; ++i)
+    size_start[i + 1] += size_start[i];
+  for (TLBT_SIZE_T b = 0; b < buckets; ++b)
+    by_size[size_start[max_size - sizes[b]]++] = b;
+
+  bool success = true;
+  TLBT_SIZE_T next_free = 0;
+  TLBT_MEMSET(taken, 0, sizeof(bool) * (count + 1));
+  for (TLBT_SIZE_T o = 0; o < buckets && success; ++o) {
+    const TLBT_SIZE_T b = by_size[o];
+    const TLBT_SIZE_T *const members = order + start[b];
+    TLBT_UINT32_T seed = 0;
+    if (sizes[b] == 1) {
+      while (taken[next_free])
+        ++next_free;
+    }
+    if (sizes[b] == 1 && next_free < TLBT_MAP_FROZEN_DIRECT) {
+      seed = (TLBT_UINT32_T)next_free | TLBT_MAP_FROZEN_DIRECT;
+      positions[0] = next_free;
+    } else if (!TLBT_MAP_FUNC_INTERNAL(frozen_search)(f->slots, hashes, members, sizes[b], taken, positions, &seed)) {
+      success = false;
+      break;
+    }
+
+    f->seeds[b] = seed;
+    for (TLBT_SIZE_T k = 0; k < sizes[b]; ++k) {
+      taken[positions[k]] = true;
+      target[members[k]] = positions[k];
+    }
+  }
+
+  // the overflow is ordered by bucket and hash so lookups can binary search it. the overflowing keys of a bucket are
+  // few or share a single hash, which keeps insertion sort cheap
+  TLBT_SIZE_T next_overflow = f->slots;
+  for (TLBT_SIZE_T b = 0; b < buckets && success; ++b) {
+    TLBT_SIZE_T *const extra = order + start[b] + sizes[b];
+    const TLBT_SIZE_T n = start[b + 1] - start[b] - sizes[b];
+    for (TLBT_SIZE_T j = 1; j < n; ++j) {
+      const TLBT_SIZE_T e = extra[j];
+      TLBT_SIZE_T k = j;
+      for (; k > 0 && hashes[extra[k - 1]] > hashes[e]; --k)
+        extra[k] = extra[k - 1];
+      extra[k] = e;
+    }
+    for (TLBT_SIZE_T k = 0; k < n; ++k)
+      target[extra[k]] = next_overflow++;
+  }
+
+  TLBT_FREE(order);
+  TLBT_FREE(start);
+  TLBT_FREE(sizes);
+  TLBT_FREE(by_size);
+  TLBT_FREE(taken);
+  TLBT_FREE(size_start);
+  TLBT_FREE(positions);
+  return success;
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(freeze)(const TLBT_MAP_TYPE *const m, TLBT_MAP_FROZEN_TYPE *const out) {
+  const TLBT_SIZE_T count = m->count;
+  out->count = count;
+  out->buckets = count / TLBT_MAP_FREEZE_BUCKET_SIZE + 1;
+  out->slots = 0;
+  out->entries = (TLBT_MAP_FROZEN_ENTRY_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_FROZEN_ENTRY_TYPE) * (count + 1));
+  out->seeds = (TLBT_UINT32_T *)TLBT_MALLOC(sizeof(TLBT_UINT32_T) * out->buckets);
+  TLBT_MAP_HASH_T *const hashes = (TLBT_MAP_HASH_T *)TLBT_MALLOC(sizeof(TLBT_MAP_HASH_T) * (count + 1));
+  TLBT_SIZE_T *const target = (TLBT_SIZE_T *)TLBT_MALLOC(sizeof(TLBT_SIZE_T) * (count + 1));
+  TLBT_ASSERT(out->entries && out->seeds && hashes && target && "Failed to allocate memory for freezing");
+
+  TLBT_SIZE_T n = 0;
+  for (const TLBT_MAP_TYPE *table = m; table; table = TLBT_MAP_OLD_TABLE(table)) {
+    for (TLBT_SIZE_T i = 0; i < table->capacity; ++i) {
+      if (TLBT_MAP_SLOT_OCCUPIED(table, i))
+        hashes[n++] = TLBT_MAP_ENTRY_HASH(table, i);
+    }
+  }
+  TLBT_ASSERT(n == count);
+
+  const bool success = TLBT_MAP_FUNC_INTERNAL(frozen_place)(out, hashes, target);
+  if (success) {
+    // same traversal as above so the nth entry goes to target[n]
+    n = 0;
+    for (const TLBT_MAP_TYPE *table = m; table; table = TLBT_MAP_OLD_TABLE(table)) {
+      for (TLBT_SIZE_T i = 0; i < table->capacity; ++i) {
+        if (!TLBT_MAP_SLOT_OCCUPIED(table, i))
+          continue;
+        out->entries[target[n]].hash = hashes[n];
+        out->entries[target[n]].key = table->keys[i].key;
 #ifdef TLBT_VALUE_T
-  TLBT_FREE(m->values);
+        out->entries[target[n]].value = TLBT_MAP_VALUE(table, i);
 #endif
+        ++n;
+      }
+    }
+  } else {
+    TLBT_MAP_FROZEN_FUNC(destroy)(out);
+  }
+
+  TLBT_FREE(hashes);
+  TLBT_FREE(target);
+  return success;
 }
 
-TLBT_INLINE void TLBT_MAP_FUNC(ensure_capacity)(TLBT_MAP_TYPE *const m) {
-  if (m->count + 1 > (float)m->capacity * TLBT_MAX_LOAD_FACTOR) {
-    const TLBT_SIZE_T capacity = m->capacity * 2;
-    TLBT_MAP_FUNC(adjust_capacity)(m, capacity);
+TLBT_INLINE void TLBT_MAP_FROZEN_FUNC(destroy)(TLBT_MAP_FROZEN_TYPE *const f) {
+  TLBT_FREE(f->entries);
+  TLBT_FREE(f->seeds);
+  f->entries = NULL;
+  f->seeds = NULL;
+  f->buckets = 0;
+  f->slots = 0;
+  f->count = 0;
+}
+
+// one seed and one slot. every overflowing key shares its hash with the key in its slot, so only keys with that same
+// hash need a second look, a binary search for their bucket and hash in the overflow
+static inline bool TLBT_MAP_FUNC_INTERNAL(frozen_find)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key,
+                                                       TLBT_MAP_HASH_T hash, TLBT_SIZE_T *out_slot) {
+  if (f->slots == 0)
+    return false;
+
+  const TLBT_SIZE_T bucket = TLBT_MAP_FUNC_INTERNAL(frozen_bucket)(hash, f->buckets);
+  TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(frozen_slot)(hash, f->seeds[bucket], f->slots);
+  if (f->entries[i].hash != hash)
+    return false;
+  if (TLBT_EQUALS_FUNC(f->entries[i].key, key)) {
+    *out_slot = i;
+    return true;
+  }
+
+  TLBT_SIZE_T low = f->slots;
+  TLBT_SIZE_T high = f->count;
+  while (low < high) {
+    const TLBT_SIZE_T mid = low + (high - low) / 2;
+    const TLBT_MAP_HASH_T h = f->entries[mid].hash;
+    const TLBT_SIZE_T b = TLBT_MAP_FUNC_INTERNAL(frozen_bucket)(h, f->buckets);
+    if (b < bucket || (b == bucket && h < hash))
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  for (i = low; i < f->count && f->entries[i].hash == hash; ++i) {
+    if (TLBT_EQUALS_FUNC(f->entries[i].key, key)) {
+      *out_slot = i;
+      return true;
+    }
   }
+  return false;
 }
 
-TLBT_INLINE void TLBT_MAP_FUNC(adjust_capacity)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity) {
-  TLBT_MAP_KEY_TYPE *keys = (TLBT_MAP_KEY_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_KEY_TYPE) * capacity);
 #ifdef TLBT_VALUE_T
-  TLBT_VALUE_T *values = (TLBT_VALUE_T *)TLBT_MALLOC(sizeof(TLBT_VALUE_T) * capacity);
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(get_ph)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                              TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T i = 0;
+  if (!TLBT_MAP_FUNC_INTERNAL(frozen_find)(f, key, hash, &i))
+    return false;
+  *out = f->entries[i].value;
+  return true;
+}
+
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(get)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key, TLBT_VALUE_T *out) {
+  return TLBT_MAP_FROZEN_FUNC(get_ph)(f, key, out, TLBT_HASH_FUNC(key));
+}
 #endif
 
-  for (TLBT_SIZE_T i = 0; i < capacity; ++i)
-    keys[i].index = 0;
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(contains_ph)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key,
+                                                   TLBT_MAP_HASH_T hash) {
+  TLBT_SIZE_T i = 0;
+  return TLBT_MAP_FUNC_INTERNAL(frozen_find)(f, key, hash, &i);
+}
+
+TLBT_INLINE bool TLBT_MAP_FROZEN_FUNC(contains)(const TLBT_MAP_FROZEN_TYPE *const f, TLBT_KEY_T key) {
+  return TLBT_MAP_FROZEN_FUNC(contains_ph)(f, key, TLBT_HASH_FUNC(key));
+}
+
+#endif
 
-  TLBT_UINT32_T hash = 0;
-  TLBT_SIZE_T j = 0;
+TLBT_INLINE void TLBT_MAP_FUNC(rehash)(TLBT_MAP_TYPE *const m) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  // the old table goes away completely which leaves no tombstones behind
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, (TLBT_SIZE_T)-1);
+#endif
+  TLBT_MAP_COUNT(m, resizes, 1);
+#ifdef TLBT_MAP_ROBIN_HOOD
+  // backward shift deletion never leaves tombstones behind
+  (void)m;
+#elif defined(TLBT_MAP_INTEGER_KEY)
+  // there is no slot state left to mark entries as pending. tombstones become empty slots and every entry is taken out
+  // and put back into the first free slot of its probe sequence instead, which never moves it away from its home.
+  // no probe sequence crosses a slot which was empty before, so one pass starting behind one is enough. if there is
+  // none the passes are repeated until no entry moves anymore
+  TLBT_SIZE_T start = m->capacity;
   for (TLBT_SIZE_T i = 0; i < m->capacity; ++i) {
-    if (TLBT_IS_OCCUPIED(m->keys[i].index)) {
-      hash = TLBT_HASH_FUNC(m->keys[i].key);
-      j = TLBT_MAP_FUNC_INTERNAL(find_empty)(keys, capacity, hash);
-      keys[j].key = m->keys[i].key;
-      keys[j].index = (m->keys[i].index & TLBT_INDEX_MASK) | TLBT_OCCUPIED_BIT;
-#ifdef TLBT_VALUE_T
-      values[j] = m->values[i];
+    if (start == m->capacity && m->keys[i].key == TLBT_MAP_EMPTY_KEY)
+      start = i;
+    else if (m->keys[i].key == TLBT_MAP_DELETED_KEY)
+      TLBT_MAP_FUNC_INTERNAL(set_empty)(m, i);
+  }
+  const bool settled = start != m->capacity;
+  start = settled ? start : 0;
+  for (bool moved = true; moved;) {
+    moved = false;
+    for (TLBT_SIZE_T k = 1; k <= m->capacity; ++k) {
+      const TLBT_SIZE_T i = TLBT_MAP_WRAP(start + k, m->capacity);
+      if (!TLBT_MAP_SLOT_OCCUPIED(m, i))
+        continue;
+      const TLBT_MAP_HASH_T hash = TLBT_MAP_ENTRY_HASH(m, i);
+      const TLBT_MAP_KEY_TYPE entry = m->keys[i];
+      m->keys[i].key = TLBT_MAP_EMPTY_KEY;
+      const TLBT_SIZE_T target = TLBT_MAP_FUNC_INTERNAL(find_empty)(m, hash);
+      m->keys[target] = entry;
+      if (target == i)
+        continue;
+#ifdef TLBT_MAP_SPLIT_VALUES
+      m->values[target] = m->values[i];
 #endif
+      TLBT_MAP_FUNC_INTERNAL(set_empty)(m, i);
+      TLBT_MAP_MARK_OCCUPIED(m, target);
+      TLBT_MAP_COUNT(m, bytes_rehashed, TLBT_MAP_ENTRY_BYTES);
+      moved = !settled;
     }
   }
+#else
+  // same approach as abseil's drop_deletes_without_resize: tombstones become empty slots and every entry is pending.
+  // pending entries are then moved to the first free slot of their probe sequence. if that one is pending as well,
+  // the two entries get swapped and the swapped in entry is processed next
+  TLBT_MAP_FUNC_INTERNAL(mark_pending)(m);
+  for (TLBT_SIZE_T i = 0; i < m->capacity;) {
+    if (!TLBT_MAP_FUNC_INTERNAL(is_pending)(m, i)) {
+      ++i;
+      continue;
+    }
 
-  TLBT_FREE(m->keys);
-  m->keys = keys;
-#ifdef TLBT_VALUE_T
-  TLBT_FREE(m->values);
-  m->values = values;
+    const TLBT_MAP_HASH_T hash = TLBT_MAP_ENTRY_HASH(m, i);
+    const TLBT_SIZE_T target = TLBT_MAP_FUNC_INTERNAL(find_empty)(m, hash);
+    if (TLBT_MAP_FUNC_INTERNAL(same_probe_group)(m, hash, i, target)) {
+      TLBT_MAP_FUNC_INTERNAL(set_occupied)(m, i, hash);
+      ++i;
+      continue;
+    }
+
+    const bool swap = TLBT_MAP_FUNC_INTERNAL(is_pending)(m, target);
+    TLBT_MAP_KEY_TYPE tmp_key = m->keys[target];
+    m->keys[target] = m->keys[i];
+    m->keys[i] = tmp_key;
+#ifdef TLBT_MAP_SPLIT_VALUES
+    TLBT_VALUE_T tmp_value = m->values[target];
+    m->values[target] = m->values[i];
+    m->values[i] = tmp_value;
+#endif
+    TLBT_MAP_FUNC_INTERNAL(set_occupied)(m, target, hash);
+    TLBT_MAP_COUNT(m, bytes_rehashed, TLBT_MAP_ENTRY_BYTES);
+    if (!swap) {
+      TLBT_MAP_FUNC_INTERNAL(set_empty)(m, i);
+      ++i;
+    }
+  }
 #endif
-  m->capacity = capacity;
 }
 
+#ifdef TLBT_MAP_SERIALIZE
+
+// "TLBTMAP" followed by the format version. a file from a machine with a different byte order doesn't match it
+#define TLBT_MAP_SERIAL_MAGIC 0x0150414D54424C54ULL
+#define TLBT_MAP_SERIAL_ALIGN 64
+#define TLBT_MAP_SERIAL_HEADER 8
+#define TLBT_MAP_SERIAL_PAD(x) (((x) + TLBT_MAP_SERIAL_ALIGN - 1) & ~(TLBT_SIZE_T)(TLBT_MAP_SERIAL_ALIGN - 1))
+#ifdef TLBT_MAP_SPLIT_VALUES
+#define TLBT_MAP_SERIAL_VALUE_SIZE sizeof(TLBT_VALUE_T)
 #else
+#define TLBT_MAP_SERIAL_VALUE_SIZE 0
+#endif
 
+// everything which changes the meaning of the saved bytes
+static inline TLBT_UINT64_T TLBT_MAP_FUNC_INTERNAL(serial_layout)(void) {
+  TLBT_UINT64_T layout = 0;
+#ifdef TLBT_MAP_SIMD_PROBE
+  layout |= 1 << 0;
+#endif
+#ifdef TLBT_MAP_ROBIN_HOOD
+  layout |= 1 << 1;
+#endif
+#ifdef TLBT_MAP_STORE_HASH
+  layout |= 1 << 2;
+#endif
+#ifdef TLBT_MAP_LARGE
+  layout |= 1 << 3;
+#endif
+#ifdef TLBT_BASE2_CAPACITY
+  layout |= 1 << 4;
+#endif
 #ifdef TLBT_VALUE_T
-TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer,
-                                     TLBT_VALUE_T *value_buffer) {
-  m->values = value_buffer;
+  layout |= 1 << 5;
+#endif
+#ifdef TLBT_MAP_LAYOUT_INTERLEAVED
+  layout |= 1 << 6;
+#endif
+#ifdef TLBT_MAP_EPOCH
+  layout |= 1 << 7;
+#endif
+#ifdef TLBT_MAP_INTEGER_KEY
+  // out of flag bits. no key type comes close to 2^23 bytes, so the top bit of its size is free
+  layout |= (TLBT_UINT64_T)1 << 31;
+#endif
+#if defined(TLBT_FAST_RANGE) && !defined(TLBT_BASE2_CAPACITY)
+  // entries sit in other slots
+  layout |= (TLBT_UINT64_T)1 << 30;
+#endif
+  layout |= (TLBT_UINT64_T)sizeof(TLBT_MAP_KEY_TYPE) << 8;
+  layout |= (TLBT_UINT64_T)TLBT_MAP_SERIAL_VALUE_SIZE << 32;
+  return layout;
+}
+
+// byte offsets of the keys, values and control bytes. returns the size of the whole file
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(serial_offsets)(TLBT_SIZE_T capacity, TLBT_SIZE_T offsets[3]) {
+  offsets[0] = TLBT_MAP_SERIAL_PAD(sizeof(TLBT_UINT64_T) * TLBT_MAP_SERIAL_HEADER);
+  offsets[1] = offsets[0] + TLBT_MAP_SERIAL_PAD(sizeof(TLBT_MAP_KEY_TYPE) * capacity);
+  offsets[2] = offsets[1] + TLBT_MAP_SERIAL_PAD(TLBT_MAP_SERIAL_VALUE_SIZE * capacity);
+#ifdef TLBT_MAP_SIMD_PROBE
+  return offsets[2] + TLBT_MAP_SERIAL_PAD(capacity + TLBT_GROUP_WIDTH);
 #else
-TLBT_INLINE void TLBT_MAP_FUNC(init)(TLBT_MAP_TYPE *const m, TLBT_SIZE_T capacity, TLBT_MAP_KEY_TYPE *key_buffer) {
+  return offsets[2];
+#endif
+}
+
+// the header holds the magic, hash version, layout, max load factor in millionths, capacity, count, the generation
+// with TLBT_MAP_EPOCH and a reserved word. the load factor is informational, a map with a different one is still valid
+static inline bool TLBT_MAP_FUNC_INTERNAL(serial_check)(const TLBT_UINT64_T *header) {
+  const TLBT_UINT64_T capacity = header[4];
+  // rejects capacities whose offsets would overflow
+  const TLBT_UINT64_T max_capacity =
+      ((TLBT_SIZE_T)-1) / 4 / (sizeof(TLBT_MAP_KEY_TYPE) + TLBT_MAP_SERIAL_VALUE_SIZE + 1);
+  if (header[0] != TLBT_MAP_SERIAL_MAGIC || header[1] != (TLBT_UINT64_T)TLBT_MAP_HASH_VERSION ||
+      header[2] != TLBT_MAP_FUNC_INTERNAL(serial_layout)() || capacity == 0 || capacity > max_capacity ||
+      header[5] >= capacity)
+    return false;
+#ifdef TLBT_MAP_EPOCH
+  if (header[6] == 0 || header[6] > TLBT_INDEX_MASK)
+    return false;
 #endif
-  m->keys = key_buffer;
-  TLBT_MEMSET(m->keys, 0, sizeof(TLBT_MAP_KEY_TYPE) * capacity);
-  m->capacity = capacity;
 #ifdef TLBT_BASE2_CAPACITY
-  TLBT_ASSERT((capacity != 0 && (capacity & (capacity - 1)) == 0));
+  if ((capacity & (capacity - 1)) != 0)
+    return false;
 #endif
-  m->count = 0;
+  return true;
 }
-#endif
 
-#ifdef TLBT_VALUE_T
-TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value,
-                                          TLBT_UINT32_T hash) {
+// writes an array followed by zeros up to the next array
+static inline bool TLBT_MAP_FUNC_INTERNAL(serial_write)(FILE *file, const void *data, TLBT_SIZE_T size,
+                                                       TLBT_SIZE_T padded) {
+  static const char zeros[TLBT_MAP_SERIAL_ALIGN] = {0};
+  return (size == 0 || fwrite(data, size, 1, file) == 1) &&
+         (padded == size || fwrite(zeros, padded - size, 1, file) == 1);
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(save)(TLBT_MAP_TYPE *const m, FILE *file) {
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  TLBT_MAP_FUNC_INTERNAL(migrate)(m, (TLBT_SIZE_T)-1);
+#endif
+  TLBT_SIZE_T offsets[3];
+  const TLBT_SIZE_T size = TLBT_MAP_FUNC_INTERNAL(serial_offsets)(m->capacity, offsets);
+  const TLBT_UINT64_T header[TLBT_MAP_SERIAL_HEADER] = {
+      TLBT_MAP_SERIAL_MAGIC,
+      TLBT_MAP_HASH_VERSION,
+      TLBT_MAP_FUNC_INTERNAL(serial_layout)(),
+      (TLBT_UINT64_T)(TLBT_MAX_LOAD_FACTOR * 1000000.0),
+      m->capacity,
+      m->count,
+#ifdef TLBT_MAP_EPOCH
+      m->epoch,
 #else
-TLBT_INLINE bool TLBT_MAP_FUNC(insert_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
+      0,
 #endif
-#ifdef TLBT_DYNAMIC_MEMORY
-  TLBT_MAP_FUNC(ensure_capacity)(m);
+      0,
+  };
+  bool ok = TLBT_MAP_FUNC_INTERNAL(serial_write)(file, header, sizeof(header), offsets[0]);
+  ok = ok && TLBT_MAP_FUNC_INTERNAL(serial_write)(file, m->keys, sizeof(TLBT_MAP_KEY_TYPE) * m->capacity,
+                                                  offsets[1] - offsets[0]);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  ok = ok && TLBT_MAP_FUNC_INTERNAL(serial_write)(file, m->values, sizeof(TLBT_VALUE_T) * m->capacity,
+                                                  offsets[2] - offsets[1]);
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  ok = ok && TLBT_MAP_FUNC_INTERNAL(serial_write)(file, m->ctrl, m->capacity + TLBT_GROUP_WIDTH, size - offsets[2]);
 #else
-  if (m->count + 1 > (float)m->capacity * TLBT_MAX_LOAD_FACTOR)
-    return false;
+  (void)size;
 #endif
+  return ok;
+}
 
-  // not finding an empty slot will not happen because the function will either auto resize
-  // once the load factor is reached or it will return false before that happens
-  // depending on the memory mode
-  TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(find_empty)(m->keys, m->capacity, hash);
+TLBT_INLINE bool TLBT_MAP_FUNC(view)(TLBT_MAP_TYPE *const m, void *data, TLBT_SIZE_T size) {
+  const TLBT_UINT64_T *header = (const TLBT_UINT64_T *)data;
+  if (size < sizeof(TLBT_UINT64_T) * TLBT_MAP_SERIAL_HEADER || !TLBT_MAP_FUNC_INTERNAL(serial_check)(header))
+    return false;
 
-  m->keys[i].key = key;
-  m->keys[i].index = (i & TLBT_INDEX_MASK) | TLBT_OCCUPIED_BIT;
-#ifdef TLBT_VALUE_T
-  m->values[i] = value;
+  const TLBT_SIZE_T capacity = (TLBT_SIZE_T)header[4];
+  TLBT_SIZE_T offsets[3];
+  if (size < TLBT_MAP_FUNC_INTERNAL(serial_offsets)(capacity, offsets))
+    return false;
+
+  char *bytes = (char *)data;
+  m->keys = (TLBT_MAP_KEY_TYPE *)(bytes + offsets[0]);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  m->values = (TLBT_VALUE_T *)(bytes + offsets[1]);
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  m->ctrl = (TLBT_UINT8_T *)(bytes + offsets[2]);
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  // viewed maps are read only, iterating them scans the slots
+  m->occupancy = NULL;
+#endif
+  m->capacity = capacity;
+  m->count = (TLBT_SIZE_T)header[5];
+#ifdef TLBT_MAP_EPOCH
+  m->epoch = (TLBT_MAP_INDEX_T)header[6];
+#endif
+#ifdef TLBT_MAP_INCREMENTAL_RESIZE
+  m->old = NULL;
+  m->migrated = 0;
+#endif
+#ifdef TLBT_MAP_COUNTERS
+  TLBT_MEMSET(&m->counters, 0, sizeof(m->counters));
 #endif
-  ++m->count;
   return true;
 }
 
-TLBT_INLINE bool TLBT_MAP_FUNC(remove_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
-  if (m->count == 0)
+#ifdef TLBT_DYNAMIC_MEMORY
+
+// reads an array and skips the zeros up to the next array
+static inline bool TLBT_MAP_FUNC_INTERNAL(serial_read)(FILE *file, void *data, TLBT_SIZE_T size, TLBT_SIZE_T padded) {
+  char padding[TLBT_MAP_SERIAL_ALIGN];
+  return (size == 0 || fread(data, size, 1, file) == 1) &&
+         (padded == size || fread(padding, padded - size, 1, file) == 1);
+}
+
+TLBT_INLINE bool TLBT_MAP_FUNC(load)(TLBT_MAP_TYPE *const m, FILE *file) {
+  TLBT_UINT64_T header[TLBT_MAP_SERIAL_HEADER];
+  if (fread(header, sizeof(header), 1, file) != 1 || !TLBT_MAP_FUNC_INTERNAL(serial_check)(header))
     return false;
 
-  TLBT_SIZE_T i = 0;
-  if (TLBT_MAP_FUNC_INTERNAL(find_entry)(m->keys, m->capacity, key, hash, &i)) {
-    m->keys[i].index = TLBT_DELETED_BIT;
-    --m->count;
-    return true;
+  TLBT_MAP_TYPE n = {0};
+  n.capacity = (TLBT_SIZE_T)header[4];
+  n.count = (TLBT_SIZE_T)header[5];
+#ifdef TLBT_MAP_EPOCH
+  n.epoch = (TLBT_MAP_INDEX_T)header[6];
+#endif
+  TLBT_SIZE_T offsets[3];
+  const TLBT_SIZE_T size = TLBT_MAP_FUNC_INTERNAL(serial_offsets)(n.capacity, offsets);
+  n.keys = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_MAP_KEY_TYPE) * n.capacity, false);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  n.values = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_VALUE_T) * n.capacity, false);
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  n.ctrl = TLBT_MAP_FUNC_INTERNAL(alloc)(n.capacity + TLBT_GROUP_WIDTH, false);
+#endif
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  n.occupancy = TLBT_MAP_FUNC_INTERNAL(alloc)(sizeof(TLBT_UINT64_T) * TLBT_MAP_BITMAP_WORDS(n.capacity), false);
+#endif
+
+  bool ok = TLBT_MAP_FUNC_INTERNAL(serial_read)(file, n.keys, sizeof(TLBT_MAP_KEY_TYPE) * n.capacity,
+                                                offsets[1] - offsets[0]);
+#ifdef TLBT_MAP_SPLIT_VALUES
+  ok = ok && TLBT_MAP_FUNC_INTERNAL(serial_read)(file, n.values, sizeof(TLBT_VALUE_T) * n.capacity,
+                                                 offsets[2] - offsets[1]);
+#endif
+#ifdef TLBT_MAP_SIMD_PROBE
+  ok = ok && TLBT_MAP_FUNC_INTERNAL(serial_read)(file, n.ctrl, n.capacity + TLBT_GROUP_WIDTH, size - offsets[2]);
+#else
+  (void)size;
+#endif
+
+  if (!ok) {
+    TLBT_MAP_FUNC(destroy)(&n);
+    return false;
   }
-  return false;
+#ifdef TLBT_MAP_OCCUPANCY_BITMAP
+  TLBT_MAP_FUNC_INTERNAL(occupancy_rebuild)(&n);
+#endif
+  *m = n;
+  return true;
 }
 
-TLBT_INLINE bool TLBT_MAP_FUNC(contains_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_UINT32_T hash) {
-  if (m->count == 0)
-    return false;
-  TLBT_SIZE_T i = 0;
-  return TLBT_MAP_FUNC_INTERNAL(find_entry)(m->keys, m->capacity, key, hash, &i);
+#endif
+
+#endif
+
+#ifdef TLBT_MAP_SHARDED
+
+typedef struct TLBT_MAP_SHARDED_TASK_TYPE {
+  TLBT_MAP_SHARDED_TYPE *sharded;
+  TLBT_SIZE_T t;
+} TLBT_MAP_SHARDED_TASK_TYPE;
+
+// the slot of a key in its shard comes from the same hash. taking the partition from a few bits of it would leave
+// those bits equal for all keys of a partition, so it's mixed with a multiplication first
+static inline TLBT_SIZE_T TLBT_MAP_FUNC_INTERNAL(sharded_partition)(const TLBT_MAP_SHARDED_TYPE *const s,
+                                                                     TLBT_MAP_HASH_T hash) {
+  const TLBT_UINT64_T mixed = ((TLBT_UINT64_T)hash * 0x9E3779B97F4A7C15ULL) >> 32;
+  return (TLBT_SIZE_T)((mixed * s->partitions) >> 32);
 }
 
-#ifdef TLBT_VALUE_T
-TLBT_INLINE bool TLBT_MAP_FUNC(get_ph)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out, TLBT_UINT32_T hash) {
-  if (m->count == 0)
-    return false;
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(create)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T threads,
+                                               TLBT_SIZE_T partitions, TLBT_MAP_FUNC(combine) combine, void *userdata) {
+  TLBT_ASSERT(threads > 0 && partitions > 0 && combine);
+  s->threads = threads;
+  s->partitions = partitions;
+  s->stride = partitions + (64 + sizeof(TLBT_MAP_TYPE) - 1) / sizeof(TLBT_MAP_TYPE);
+  s->combine = combine;
+  s->userdata = userdata;
+  s->shards = (TLBT_MAP_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_TYPE) * threads * s->stride);
+  TLBT_ASSERT(s->shards && "Failed to allocate memory for the shards");
+  for (TLBT_SIZE_T t = 0; t < threads; ++t) {
+    for (TLBT_SIZE_T p = 0; p < partitions; ++p)
+      TLBT_MAP_FUNC(create)(&s->shards[t * s->stride + p], TLBT_MAP_MIN_CAPACITY);
+  }
+}
 
-  TLBT_SIZE_T i = 0;
-  if (TLBT_MAP_FUNC_INTERNAL(find_entry)(m->keys, m->capacity, key, hash, &i)) {
-    *out = m->values[i];
-    return true;
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(destroy)(TLBT_MAP_SHARDED_TYPE *const s) {
+  for (TLBT_SIZE_T t = 0; t < s->threads; ++t) {
+    for (TLBT_SIZE_T p = 0; p < s->partitions; ++p)
+      TLBT_MAP_FUNC(destroy)(&s->shards[t * s->stride + p]);
   }
-  return false;
+  TLBT_FREE(s->shards);
 }
-#endif
 
-#ifdef TLBT_VALUE_T
-TLBT_INLINE bool TLBT_MAP_FUNC(insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T value) {
-  return TLBT_MAP_FUNC(insert_ph)(m, key, value, TLBT_HASH_FUNC(key));
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(add_ph)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T thread, TLBT_KEY_T key,
+                                               TLBT_VALUE_T value, TLBT_MAP_HASH_T hash) {
+  TLBT_MAP_TYPE *const m = &s->shards[thread * s->stride + TLBT_MAP_FUNC_INTERNAL(sharded_partition)(s, hash)];
+  bool inserted = false;
+  TLBT_VALUE_T *slot = TLBT_MAP_FUNC(get_or_insert_ph)(m, key, hash, &inserted);
+  if (inserted)
+    *slot = value;
+  else
+    s->combine(slot, value, s->userdata);
 }
-#else
-TLBT_INLINE bool TLBT_MAP_FUNC(insert)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
-  return TLBT_MAP_FUNC(insert_ph)(m, key, TLBT_HASH_FUNC(key));
+
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(add)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T thread, TLBT_KEY_T key,
+                                            TLBT_VALUE_T value) {
+  TLBT_MAP_SHARDED_FUNC(add_ph)(s, thread, key, value, TLBT_HASH_FUNC(key));
 }
-#endif
 
-TLBT_INLINE bool TLBT_MAP_FUNC(remove)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
-  return TLBT_MAP_FUNC(remove_ph)(m, key, TLBT_HASH_FUNC(key));
+// merges the partitions t, t + threads, t + 2 * threads and so on. the biggest shard of a partition becomes the
+// result so the fewest entries have to be moved
+static inline void *TLBT_MAP_FUNC_INTERNAL(sharded_worker)(void *arg) {
+  const TLBT_MAP_SHARDED_TASK_TYPE *task = (const TLBT_MAP_SHARDED_TASK_TYPE *)arg;
+  TLBT_MAP_SHARDED_TYPE *const s = task->sharded;
+  for (TLBT_SIZE_T p = task->t; p < s->partitions; p += s->threads) {
+    TLBT_MAP_TYPE *const out = &s->shards[p];
+    for (TLBT_SIZE_T t = 1; t < s->threads; ++t) {
+      TLBT_MAP_TYPE *const shard = &s->shards[t * s->stride + p];
+      if (shard->count > out->count) {
+        const TLBT_MAP_TYPE swap = *out;
+        *out = *shard;
+        *shard = swap;
+      }
+    }
+    for (TLBT_SIZE_T t = 1; t < s->threads; ++t) {
+      TLBT_MAP_TYPE *const shard = &s->shards[t * s->stride + p];
+      if (shard->count == 0)
+        continue;
+      for (TLBT_MAP_TYPE *table = shard; table; table = TLBT_MAP_OLD_TABLE(table)) {
+        for (TLBT_SIZE_T i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, 0); i < table->capacity;
+             i = TLBT_MAP_FUNC_INTERNAL(next_occupied)(table, i + 1)) {
+          bool inserted = false;
+          TLBT_VALUE_T *slot =
+              TLBT_MAP_FUNC(get_or_insert_ph)(out, table->keys[i].key, TLBT_MAP_ENTRY_HASH(table, i), &inserted);
+          if (inserted)
+            *slot = TLBT_MAP_VALUE(table, i);
+          else
+            s->combine(slot, TLBT_MAP_VALUE(table, i), s->userdata);
+        }
+      }
+      TLBT_MAP_FUNC(clear)(shard);
+    }
+  }
+  return NULL;
 }
 
-TLBT_INLINE bool TLBT_MAP_FUNC(contains)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key) {
-  return TLBT_MAP_FUNC(contains_ph)(m, key, TLBT_HASH_FUNC(key));
+TLBT_INLINE void TLBT_MAP_SHARDED_FUNC(merge)(TLBT_MAP_SHARDED_TYPE *const s) {
+  const TLBT_SIZE_T threads = s->threads < s->partitions ? s->threads : s->partitions;
+  pthread_t *handles = (pthread_t *)TLBT_MALLOC(sizeof(pthread_t) * threads);
+  TLBT_MAP_SHARDED_TASK_TYPE *tasks =
+      (TLBT_MAP_SHARDED_TASK_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_SHARDED_TASK_TYPE) * threads);
+  TLBT_ASSERT(handles && tasks && "Failed to allocate memory for merging");
+  for (TLBT_SIZE_T t = 0; t < threads; ++t) {
+    tasks[t].sharded = s;
+    tasks[t].t = t;
+  }
+  // the calling thread takes the first part and the parts of threads which couldn't be created
+  TLBT_SIZE_T started = 1;
+  while (started < threads &&
+         pthread_create(&handles[started], NULL, TLBT_MAP_FUNC_INTERNAL(sharded_worker), &tasks[started]) == 0)
+    ++started;
+  TLBT_MAP_FUNC_INTERNAL(sharded_worker)(&tasks[0]);
+  for (TLBT_SIZE_T t = started; t < threads; ++t)
+    TLBT_MAP_FUNC_INTERNAL(sharded_worker)(&tasks[t]);
+  for (TLBT_SIZE_T t = 1; t < started; ++t)
+    pthread_join(handles[t], NULL);
+  TLBT_FREE(handles);
+  TLBT_FREE(tasks);
 }
 
-#ifdef TLBT_VALUE_T
-TLBT_INLINE bool TLBT_MAP_FUNC(get)(TLBT_MAP_TYPE *const m, TLBT_KEY_T key, TLBT_VALUE_T *out) {
-  return TLBT_MAP_FUNC(get_ph)(m, key, out, TLBT_HASH_FUNC(key));
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_SHARDED_FUNC(partition)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_SIZE_T partition) {
+  return &s->shards[partition];
+}
+
+TLBT_INLINE bool TLBT_MAP_SHARDED_FUNC(get_ph)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_KEY_T key, TLBT_VALUE_T *out,
+                                               TLBT_MAP_HASH_T hash) {
+  return TLBT_MAP_FUNC(get_ph)(&s->shards[TLBT_MAP_FUNC_INTERNAL(sharded_partition)(s, hash)], key, out, hash);
+}
+
+TLBT_INLINE bool TLBT_MAP_SHARDED_FUNC(get)(TLBT_MAP_SHARDED_TYPE *const s, TLBT_KEY_T key, TLBT_VALUE_T *out) {
+  return TLBT_MAP_SHARDED_FUNC(get_ph)(s, key, out, TLBT_HASH_FUNC(key));
 }
+
 #endif
 
-TLBT_INLINE void TLBT_MAP_FUNC(clear)(TLBT_MAP_TYPE *const m) {
-  m->count = 0;
-  for (TLBT_SIZE_T i = 0; i < m->capacity; ++i)
-    m->keys[i].index = 0;
+#ifdef TLBT_MAP_RCU
+
+static inline TLBT_MAP_RCU_SNAPSHOT_TYPE *TLBT_MAP_FUNC_INTERNAL(rcu_snapshot)(TLBT_SIZE_T capacity) {
+  TLBT_MAP_RCU_SNAPSHOT_TYPE *snapshot = (TLBT_MAP_RCU_SNAPSHOT_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_RCU_SNAPSHOT_TYPE));
+  TLBT_ASSERT(snapshot && "Failed to allocate memory for the snapshot");
+  TLBT_MAP_FUNC(create)(&snapshot->map, capacity);
+  snapshot->epoch = 0;
+  snapshot->next = NULL;
+  return snapshot;
 }
 
-TLBT_INLINE bool TLBT_MAP_FUNC(copy)(TLBT_MAP_TYPE *const dest, const TLBT_MAP_TYPE *const src) {
-  if (dest->capacity != src->capacity) {
-    if ((dest->capacity * TLBT_MAX_LOAD_FACTOR) <= src->count)
-      return false;
+static inline void TLBT_MAP_FUNC_INTERNAL(rcu_free)(TLBT_MAP_RCU_SNAPSHOT_TYPE *snapshot) {
+  TLBT_MAP_FUNC(destroy)(&snapshot->map);
+  TLBT_FREE(snapshot);
+}
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(create)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T readers) {
+  r->readers = (TLBT_MAP_RCU_READER_TYPE *)TLBT_MALLOC(sizeof(TLBT_MAP_RCU_READER_TYPE) * readers);
+  TLBT_ASSERT(r->readers && "Failed to allocate memory for the readers");
+  TLBT_MEMSET(r->readers, 0, sizeof(TLBT_MAP_RCU_READER_TYPE) * readers);
+  r->reader_count = readers;
+  r->current = TLBT_MAP_FUNC_INTERNAL(rcu_snapshot)(TLBT_MAP_MIN_CAPACITY);
+  r->retired = NULL;
+  r->epoch = 1;
+}
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(destroy)(TLBT_MAP_RCU_TYPE *const r) {
+  while (r->retired) {
+    TLBT_MAP_RCU_SNAPSHOT_TYPE *next = r->retired->next;
+    TLBT_MAP_FUNC_INTERNAL(rcu_free)(r->retired);
+    r->retired = next;
+  }
+  TLBT_MAP_FUNC_INTERNAL(rcu_free)(r->current);
+  TLBT_FREE(r->readers);
+}
+
+// announcing has to be visible before the snapshot is loaded, otherwise the writer could free it in between. the
+// writer swaps the snapshot before bumping the epoch, so a reader which sees the new epoch also sees the new snapshot
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(read_begin)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader) {
+  __atomic_store_n(&r->readers[reader].epoch, __atomic_load_n(&r->epoch, __ATOMIC_ACQUIRE), __ATOMIC_SEQ_CST);
+  return &__atomic_load_n(&r->current, __ATOMIC_SEQ_CST)->map;
+}
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(read_end)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader) {
+  __atomic_store_n(&r->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
 
-    TLBT_MAP_FUNC(clear)(dest);
-    for (TLBT_SIZE_T i = 0; i < src->capacity; ++i) {
-      if (TLBT_IS_OCCUPIED(src->keys[i].index)) {
 #ifdef TLBT_VALUE_T
-        TLBT_MAP_FUNC(insert)(dest, src->keys[i].key, src->values[i]);
-#else
-        TLBT_MAP_FUNC(insert)(dest, src->keys[i].key);
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(get_ph)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                           TLBT_VALUE_T *out, TLBT_MAP_HASH_T hash) {
+  const bool found = TLBT_MAP_FUNC(get_ph)(TLBT_MAP_RCU_FUNC(read_begin)(r, reader), key, out, hash);
+  TLBT_MAP_RCU_FUNC(read_end)(r, reader);
+  return found;
+}
+
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(get)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                        TLBT_VALUE_T *out) {
+  return TLBT_MAP_RCU_FUNC(get_ph)(r, reader, key, out, TLBT_HASH_FUNC(key));
+}
 #endif
-      }
+
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(contains_ph)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key,
+                                                TLBT_MAP_HASH_T hash) {
+  const bool found = TLBT_MAP_FUNC(contains_ph)(TLBT_MAP_RCU_FUNC(read_begin)(r, reader), key, hash);
+  TLBT_MAP_RCU_FUNC(read_end)(r, reader);
+  return found;
+}
+
+TLBT_INLINE bool TLBT_MAP_RCU_FUNC(contains)(TLBT_MAP_RCU_TYPE *const r, TLBT_SIZE_T reader, TLBT_KEY_T key) {
+  return TLBT_MAP_RCU_FUNC(contains_ph)(r, reader, key, TLBT_HASH_FUNC(key));
+}
+
+// only the writer changes the current snapshot, so it can read it without announcing itself
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(prepare)(TLBT_MAP_RCU_TYPE *const r) {
+  return &TLBT_MAP_FUNC_INTERNAL(rcu_snapshot)(r->current->map.capacity)->map;
+}
+
+TLBT_INLINE TLBT_MAP_TYPE *TLBT_MAP_RCU_FUNC(prepare_copy)(TLBT_MAP_RCU_TYPE *const r) {
+  TLBT_MAP_TYPE *next = TLBT_MAP_RCU_FUNC(prepare)(r);
+  TLBT_MAP_FUNC(copy)(next, &r->current->map);
+  return next;
+}
+
+// a snapshot can be freed once every reader either isn't reading or started after it was replaced
+TLBT_INLINE TLBT_SIZE_T TLBT_MAP_RCU_FUNC(reclaim)(TLBT_MAP_RCU_TYPE *const r) {
+  TLBT_SIZE_T left = 0;
+  TLBT_MAP_RCU_SNAPSHOT_TYPE **link = &r->retired;
+  while (*link) {
+    TLBT_MAP_RCU_SNAPSHOT_TYPE *const snapshot = *link;
+    bool used = false;
+    for (TLBT_SIZE_T i = 0; i < r->reader_count && !used; ++i) {
+      const TLBT_UINT64_T epoch = __atomic_load_n(&r->readers[i].epoch, __ATOMIC_SEQ_CST);
+      used = epoch != 0 && epoch <= snapshot->epoch;
     }
-  } else {
-    for (TLBT_SIZE_T i = 0; i < src->capacity; ++i) {
-      dest->keys[i] = src->keys[i];
-#ifdef TLBT_VALUE_T
-      dest->values[i] = src->values[i];
-#endif
+    if (used) {
+      ++left;
+      link = &snapshot->next;
+    } else {
+      *link = snapshot->next;
+      TLBT_MAP_FUNC_INTERNAL(rcu_free)(snapshot);
     }
   }
-  dest->count = src->count;
-  return true;
+  return left;
+}
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(publish)(TLBT_MAP_RCU_TYPE *const r, TLBT_MAP_TYPE *next) {
+  TLBT_MAP_RCU_SNAPSHOT_TYPE *const old =
+      __atomic_exchange_n(&r->current, (TLBT_MAP_RCU_SNAPSHOT_TYPE *)next, __ATOMIC_SEQ_CST);
+  old->epoch = __atomic_fetch_add(&r->epoch, 1, __ATOMIC_SEQ_CST);
+  old->next = r->retired;
+  r->retired = old;
+  TLBT_MAP_RCU_FUNC(reclaim)(r);
+}
+
+TLBT_INLINE void TLBT_MAP_RCU_FUNC(synchronize)(TLBT_MAP_RCU_TYPE *const r) {
+  while (TLBT_MAP_RCU_FUNC(reclaim)(r) != 0)
+    sched_yield();
 }
 
 #endif
 
+#endif
+
 #undef TLBT_ASSERT
 #undef TLBT_BASE2_CAPACITY
+#undef TLBT_CALLOC
 #undef TLBT_COMBINE
 #undef TLBT_COMBINE2
 #undef TLBT_COMPARE_REF
+#undef TLBT_CTRL_DELETED
+#undef TLBT_CTRL_EMPTY
+#undef TLBT_CTRL_H2
 #undef TLBT_DEFINITION
 #undef TLBT_DELETED_BIT
+#undef TLBT_DISTANCE
 #undef TLBT_DYNAMIC_MEMORY
 #undef TLBT_EQUALS
 #undef TLBT_EQUALS_FUNC
 #undef TLBT_EQUALS_REF
+#undef TLBT_FAST_RANGE
 #undef TLBT_FREE
+#undef TLBT_GROUP_WIDTH
 #undef TLBT_HASH
 #undef TLBT_HASH_FUNC
 #undef TLBT_HASH_REF
@@ -578,20 +3572,94 @@ TLBT_INLINE bool TLBT_MAP_FUNC(copy)(TLBT_MAP_TYPE *const dest, const TLBT_MAP_T
 #undef TLBT_KEY_T
 #undef TLBT_KEY_T_NAME
 #undef TLBT_MALLOC
+#undef TLBT_MAP_AUTO_SHRINK
+#undef TLBT_MAP_BATCH_CHUNK
+#undef TLBT_MAP_BITMAP_WORDS
+#undef TLBT_MAP_BUILD_TASK_TYPE
+#undef TLBT_MAP_BUILD_TYPE
+#undef TLBT_MAP_COUNT
+#undef TLBT_MAP_COUNTERS
+#undef TLBT_MAP_DELETED_KEY
+#undef TLBT_MAP_EMPTY_KEY
+#undef TLBT_MAP_ENTRY_BYTES
+#undef TLBT_MAP_ENTRY_HASH
+#undef TLBT_MAP_EPOCH
+#undef TLBT_MAP_FLAGS
+#undef TLBT_MAP_FREEZE
+#undef TLBT_MAP_FREEZE_BUCKET_SIZE
+#undef TLBT_MAP_FROZEN_DIRECT
+#undef TLBT_MAP_FROZEN_ENTRY_TYPE
+#undef TLBT_MAP_FROZEN_FUNC
+#undef TLBT_MAP_FROZEN_TYPE
 #undef TLBT_MAP_FUNC
 #undef TLBT_MAP_FUNC_INTERNAL
+#undef TLBT_MAP_GENERATION
+#undef TLBT_MAP_HASH_MATCHES
+#undef TLBT_MAP_HASH_T
+#undef TLBT_MAP_HASH_VERSION
+#undef TLBT_MAP_HOME
+#undef TLBT_MAP_HUGE_PAGES
+#undef TLBT_MAP_INCREMENTAL_RESIZE
+#undef TLBT_MAP_INDEX_T
+#undef TLBT_MAP_INTEGER_KEY
 #undef TLBT_MAP_ITERATOR_FUNC
 #undef TLBT_MAP_ITERATOR_TYPE
+#undef TLBT_MAP_KEYS_EQUAL
 #undef TLBT_MAP_KEY_TYPE
+#undef TLBT_MAP_LARGE
+#undef TLBT_MAP_LAYOUT_INTERLEAVED
+#undef TLBT_MAP_MARK_FREE
+#undef TLBT_MAP_MARK_OCCUPIED
+#undef TLBT_MAP_MIGRATE_STEP
+#undef TLBT_MAP_MIN_CAPACITY
+#undef TLBT_MAP_MMAP
+#undef TLBT_MAP_MMAP_THRESHOLD
 #undef TLBT_MAP_NO_ITERATOR
+#undef TLBT_MAP_NO_SSE2
+#undef TLBT_MAP_OCCUPANCY_BITMAP
+#undef TLBT_MAP_OLD_TABLE
+#undef TLBT_MAP_PARALLEL_BUILD
+#undef TLBT_MAP_PREFETCH_DISTANCE
+#undef TLBT_MAP_RCU
+#undef TLBT_MAP_RCU_FUNC
+#undef TLBT_MAP_RCU_READER_TYPE
+#undef TLBT_MAP_RCU_SNAPSHOT_TYPE
+#undef TLBT_MAP_RCU_TYPE
+#undef TLBT_MAP_ROBIN_HOOD
+#undef TLBT_MAP_SERIALIZE
+#undef TLBT_MAP_SERIAL_ALIGN
+#undef TLBT_MAP_SERIAL_HEADER
+#undef TLBT_MAP_SERIAL_MAGIC
+#undef TLBT_MAP_SERIAL_PAD
+#undef TLBT_MAP_SERIAL_VALUE_SIZE
+#undef TLBT_MAP_SHARDED
+#undef TLBT_MAP_SHARDED_FUNC
+#undef TLBT_MAP_SHARDED_TASK_TYPE
+#undef TLBT_MAP_SHARDED_TYPE
+#undef TLBT_MAP_SIMD_PROBE
+#undef TLBT_MAP_SLOT_OCCUPIED
+#undef TLBT_MAP_SPLIT_VALUES
+#undef TLBT_MAP_SSE2
+#undef TLBT_MAP_STATS_BUCKETS
+#undef TLBT_MAP_STATS_TYPE
+#undef TLBT_MAP_STORE_HASH
 #undef TLBT_MAP_TYPE
+#undef TLBT_MAP_VALUE
+#undef TLBT_MAP_WRAP
+#undef TLBT_MAP_WRAP_GROUP
+#undef TLBT_MAP_ZEROED_SLOTS
 #undef TLBT_MAX_LOAD_FACTOR
 #undef TLBT_MEMSET
+#undef TLBT_MIN_LOAD_FACTOR
 #undef TLBT_MOD
 #undef TLBT_OCCUPIED_BIT
+#undef TLBT_PREFETCH
 #undef TLBT_SIZE_T
 #undef TLBT_STATIC
+#undef TLBT_SWAR_LSB
+#undef TLBT_SWAR_MSB
 #undef TLBT_UINT32_T
+#undef TLBT_UINT64_T
+#undef TLBT_UINT8_T
 #undef TLBT_VALUE_T
 #undef TLBT_VALUE_T_NAME
-
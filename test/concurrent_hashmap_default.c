@@ -0,0 +1,212 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(uint32_t x) {
+  // murmur3 finalizer. the segment is picked by the upper bits so they have to be mixed as well
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+  x ^= x >> 13;
+  x *= 0xC2B2AE35U;
+  x ^= x >> 16;
+  return x;
+}
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/concurrent_hashmap.h"
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_CMAP_SEGMENT_BITS 1
+#define TLBT_STATIC
+#include "../src/concurrent_hashmap.h"
+
+static size_t allocations = 0;
+static size_t frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME counted
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/concurrent_hashmap.h"
+
+#include <pthread.h>
+
+#define THREADS 4
+#define KEYS_PER_THREAD 4096
+
+typedef struct worker {
+  tlbt_cmap_uint32_t_uint32_t *map;
+  uint32_t id;
+  uint32_t torn; // values which didn't belong to their key
+  uint32_t found;
+} worker;
+
+static void *insert_worker(void *arg) {
+  worker *w = (worker *)arg;
+  for (uint32_t i = 0; i < KEYS_PER_THREAD; ++i) {
+    const uint32_t key = i * THREADS + w->id;
+    tlbt_cmap_uint32_t_uint32_t_insert(w->map, key, key * 2);
+  }
+  return 0;
+}
+
+static void *remove_worker(void *arg) {
+  worker *w = (worker *)arg;
+  for (uint32_t i = 0; i < KEYS_PER_THREAD; i += 2) {
+    const uint32_t key = i * THREADS + w->id;
+    tlbt_cmap_uint32_t_uint32_t_remove(w->map, key);
+  }
+  return 0;
+}
+
+// inserts and removes the keys the remove workers removed again and again. the tombstones keep getting purged and
+// the entries which stay in the map move around while the readers look them up
+static void *churn_worker(void *arg) {
+  worker *w = (worker *)arg;
+  for (uint32_t round = 0; round < 8; ++round) {
+    for (uint32_t i = 0; i < KEYS_PER_THREAD; i += 2) {
+      const uint32_t key = i * THREADS + w->id;
+      tlbt_cmap_uint32_t_uint32_t_insert(w->map, key, key * 2);
+      tlbt_cmap_uint32_t_uint32_t_remove(w->map, key);
+    }
+  }
+  return 0;
+}
+
+static void *read_worker(void *arg) {
+  worker *w = (worker *)arg;
+  for (int round = 0; round < 4; ++round) {
+    for (uint32_t key = 0; key < THREADS * KEYS_PER_THREAD; ++key) {
+      uint32_t value = 0;
+      if (tlbt_cmap_uint32_t_uint32_t_get(w->map, key, &value)) {
+        ++w->found;
+        w->torn += value != key * 2;
+      }
+    }
+  }
+  return 0;
+}
+
+static void run_threads(void *(*writer)(void *), tlbt_cmap_uint32_t_uint32_t *m) {
+  pthread_t threads[THREADS * 2];
+  worker workers[THREADS * 2];
+  for (uint32_t i = 0; i < THREADS * 2; ++i) {
+    workers[i] = (worker){.map = m, .id = i % THREADS};
+    pthread_create(&threads[i], 0, i < THREADS ? writer : read_worker, &workers[i]);
+  }
+  for (uint32_t i = 0; i < THREADS * 2; ++i) {
+    pthread_join(threads[i], 0);
+    tlbt_assert_fmt(workers[i].torn == 0, "reader %u saw %u wrong values", i, workers[i].torn);
+  }
+}
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // single threaded behavior
+  {
+    tlbt_cmap_uint32_t_uint32_t m;
+    tlbt_cmap_uint32_t_uint32_t_create(&m, 0);
+    for (uint32_t i = 0; i < 1000; ++i)
+      tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_insert(&m, i, i + 1), "should have inserted successfully");
+    tlbt_assert_msg(!tlbt_cmap_uint32_t_uint32_t_insert(&m, 10, 0), "inserting an existing key should fail");
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_count(&m) == 1000, "wrong count");
+
+    uint32_t value = 0;
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_get(&m, 10, &value) && value == 11, "insert shouldn't overwrite");
+    tlbt_assert_msg(!tlbt_cmap_uint32_t_uint32_t_insert_or_assign(&m, 10, 42), "key should have been assigned");
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_get(&m, 10, &value) && value == 42, "value should be overwritten");
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_insert_or_assign(&m, 5000, 1), "key should have been inserted");
+
+    for (uint32_t i = 0; i < 1000; i += 2)
+      tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_remove(&m, i), "should have removed element");
+    tlbt_assert_msg(!tlbt_cmap_uint32_t_uint32_t_remove(&m, 0), "element was already removed");
+    for (uint32_t i = 0; i < 1000; ++i)
+      tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_contains(&m, i) == (i % 2 == 1), "map and reference disagree");
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_count(&m) == 501, "wrong count after removing");
+
+    // the tombstones get dropped when the segments run out of room instead of growing forever
+    for (uint32_t round = 0; round < 100; ++round) {
+      for (uint32_t i = 0; i < 1000; i += 2)
+        tlbt_cmap_uint32_t_uint32_t_insert(&m, 100000 + i, i);
+      for (uint32_t i = 0; i < 1000; i += 2)
+        tlbt_cmap_uint32_t_uint32_t_remove(&m, 100000 + i);
+    }
+    size_t capacity = 0;
+    for (size_t i = 0; i < 64; ++i)
+      capacity += m.segments[i].table->capacity;
+    tlbt_assert_fmt(capacity <= 4096, "churn shouldn't grow the map (capacity %zu)", capacity);
+    tlbt_cmap_uint32_t_uint32_t_destroy(&m);
+  }
+
+  // purging the tombstones of a map which never holds more than one entry doesn't allocate new tables
+  {
+    tlbt_cmap_counted_uint32_t m;
+    tlbt_cmap_counted_uint32_t_create(&m, 0);
+    const size_t tables = allocations;
+    for (uint32_t i = 0; i < 200000; ++i) {
+      tlbt_cmap_counted_uint32_t_insert(&m, i, i);
+      tlbt_assert_msg(tlbt_cmap_counted_uint32_t_remove(&m, i), "should have removed element");
+    }
+    tlbt_assert_fmt(allocations == tables, "churn allocated %zu tables", allocations - tables);
+    tlbt_cmap_counted_uint32_t_insert(&m, 7, 8);
+    uint32_t value = 0;
+    tlbt_assert_msg(tlbt_cmap_counted_uint32_t_get(&m, 7, &value) && value == 8, "should have found key");
+    tlbt_cmap_counted_uint32_t_destroy(&m);
+    tlbt_assert_msg(allocations == frees, "every table should be freed");
+  }
+
+  // set with only two segments
+  {
+    tlbt_cset_uint32_t s;
+    tlbt_cset_uint32_t_create(&s, 16);
+    for (uint32_t i = 0; i < 500; ++i)
+      tlbt_assert_msg(tlbt_cset_uint32_t_insert(&s, i * 7), "should have inserted successfully");
+    for (uint32_t i = 0; i < 3500; ++i)
+      tlbt_assert_msg(tlbt_cset_uint32_t_contains(&s, i) == (i % 7 == 0), "set and reference disagree");
+    tlbt_cset_uint32_t_destroy(&s);
+  }
+
+  // writers grow the segments while readers check that every value they see belongs to its key
+  {
+    tlbt_cmap_uint32_t_uint32_t m;
+    tlbt_cmap_uint32_t_uint32_t_create(&m, 0);
+    run_threads(insert_worker, &m);
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_count(&m) == THREADS * KEYS_PER_THREAD, "lost inserts");
+    for (uint32_t key = 0; key < THREADS * KEYS_PER_THREAD; ++key) {
+      uint32_t value = 0;
+      tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_get(&m, key, &value) && value == key * 2, "should have found key");
+    }
+
+    run_threads(remove_worker, &m);
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_count(&m) == THREADS * KEYS_PER_THREAD / 2, "lost removes");
+    run_threads(churn_worker, &m);
+    tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_count(&m) == THREADS * KEYS_PER_THREAD / 2, "churn changed the count");
+    for (uint32_t key = 0; key < THREADS * KEYS_PER_THREAD; ++key)
+      tlbt_assert_msg(tlbt_cmap_uint32_t_uint32_t_contains(&m, key) == ((key / THREADS) % 2 == 1),
+                      "map and reference disagree");
+    tlbt_cmap_uint32_t_uint32_t_destroy(&m);
+  }
+
+  TLBT_TEST_DONE();
+}
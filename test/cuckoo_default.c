@@ -0,0 +1,128 @@
+#include "common.h"
+#include "../src/assert.h"
+#include "../src/hash.h"
+#include <stddef.h>
+
+static bool internal_assert_triggered = false;
+#define INTERNAL_ASSERT(cond)                                                                                          \
+  do {                                                                                                                 \
+    if (!(cond)) {                                                                                                     \
+      /* this only works because the functions are statically defined */                                               \
+      internal_assert_triggered = true;                                                                                \
+      return;                                                                                                          \
+    }                                                                                                                  \
+  } while (0)
+
+static inline uint64_t string_slice_hash64(const string_slice *const s) {
+  return tlbt_hash_bytes64(s->data, s->len, 0);
+}
+
+#define TLBT_KEY_T string_slice
+#define TLBT_VALUE_T point
+#define TLBT_HASH(x) string_slice_hash64(&x)
+#define TLBT_EQUALS(a, b) string_slice_equals(&a, &b)
+#define TLBT_KEY_T_NAME str
+#define TLBT_VALUE_T_NAME point
+#define TLBT_ASSERT INTERNAL_ASSERT
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_HASH(x) tlbt_hash_mix64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // map with string keys
+  {
+    tlbt_cuckoo_map_str_point_bucket buckets[4];
+    tlbt_cuckoo_map_str_point m = {0};
+    tlbt_cuckoo_map_str_point_init(&m, 3, buckets);
+    tlbt_assert_msg(internal_assert_triggered, "internal assert should have triggered because of no base2 capacity");
+    internal_assert_triggered = false;
+
+    tlbt_cuckoo_map_str_point_init(&m, 4, buckets);
+    tlbt_assert_msg(!internal_assert_triggered, "there should be no failed assertion");
+    tlbt_assert_msg(m.bucket_count == 4 && m.count == 0 && m.buckets == buckets, "map should use the given buckets");
+
+    const char *test_strings[16] = {"hello",   "world", "!",      "these", "are",  "some", "unique", "test",
+                                    "strings", "I",     "should", "not",   "need", "more", "than",   "sixteen"};
+
+    // 16 slots with a max load factor of 0.95 take 15 entries
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      tlbt_assert_msg(!tlbt_cuckoo_map_str_point_contains(&m, key), "shouldn't have found element");
+      const bool success = tlbt_cuckoo_map_str_point_insert(&m, key, (point){i, -i});
+      tlbt_assert_fmt(success == (i < 15), "wrong insert result for '%s'", test_strings[i]);
+    }
+    tlbt_assert_msg(m.count == 15, "count should be 15");
+
+    string_slice hello = {.data = "hello", .len = 5};
+    tlbt_assert_msg(!tlbt_cuckoo_map_str_point_insert(&m, hello, (point){1, 1}), "key should already exist");
+    tlbt_assert_msg(tlbt_cuckoo_map_str_point_insert_or_assign(&m, hello, (point){42, 42}), "should have assigned");
+    tlbt_assert_msg(m.count == 15, "assigning shouldn't change the count");
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      point value = {0};
+      const bool found = tlbt_cuckoo_map_str_point_get(&m, key, &value);
+      tlbt_assert_fmt(found == (i < 15), "wrong get result for '%s'", test_strings[i]);
+      if (i == 0)
+        tlbt_assert_msg(value.x == 42 && value.y == 42, "value should have been overwritten");
+      else if (found)
+        tlbt_assert_msg(value.x == i && value.y == -i, "wrong value associated with key");
+    }
+
+    for (int i = 0; i < 15; i += 2) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      tlbt_assert_msg(tlbt_cuckoo_map_str_point_remove(&m, key), "should have removed element");
+      tlbt_assert_msg(!tlbt_cuckoo_map_str_point_remove(&m, key), "element was already removed");
+    }
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      tlbt_assert_msg(tlbt_cuckoo_map_str_point_contains(&m, key) == (i < 15 && i % 2 == 1), "wrong contains");
+    }
+    tlbt_assert_msg(m.count == 7, "count should be 7");
+
+    tlbt_cuckoo_map_str_point_clear(&m);
+    tlbt_assert_msg(m.count == 0 && !tlbt_cuckoo_map_str_point_contains(&m, hello), "map should be empty");
+  }
+
+  // fills the set up to the max load factor, which needs long chains of moves towards the end
+  {
+    static tlbt_cuckoo_set_uint64_t_bucket buckets[1024];
+    tlbt_cuckoo_set_uint64_t s = {0};
+    tlbt_cuckoo_set_uint64_t_init(&s, 1024, buckets);
+    const uint64_t max = (uint64_t)(1024 * 4 * 0.95);
+    for (uint64_t i = 0; i < max; ++i)
+      tlbt_assert_fmt(tlbt_cuckoo_set_uint64_t_insert(&s, i * 11), "failed inserting key %d", (int)i);
+    tlbt_assert_msg(!tlbt_cuckoo_set_uint64_t_insert(&s, 5), "set should be full");
+    tlbt_assert_msg(s.count == max, "wrong count");
+    for (uint64_t i = 0; i < max * 11; ++i)
+      tlbt_assert_fmt(tlbt_cuckoo_set_uint64_t_contains(&s, i) == (i % 11 == 0), "set is wrong about %d", (int)i);
+
+    // every key is in one of its two buckets
+    size_t occupied = 0;
+    for (size_t b = 0; b < s.bucket_count; ++b) {
+      for (int slot = 0; slot < 4; ++slot) {
+        if (buckets[b].tags[slot] == 0)
+          continue;
+        const uint64_t h = tlbt_hash_mix64(buckets[b].keys[slot]);
+        tlbt_assert_msg(b == _tlbt_cuckoo_set_uint64_t_first(&s, h) || b == _tlbt_cuckoo_set_uint64_t_second(&s, h),
+                        "key is in neither of its buckets");
+        ++occupied;
+      }
+    }
+    tlbt_assert_msg(occupied == max, "wrong number of occupied slots");
+
+    for (uint64_t i = 0; i < max; i += 2)
+      tlbt_cuckoo_set_uint64_t_remove(&s, i * 11);
+    for (uint64_t i = 0; i < max; i += 2)
+      tlbt_assert_msg(tlbt_cuckoo_set_uint64_t_insert(&s, i * 11 + 1), "removing should have made room");
+  }
+
+  TLBT_TEST_DONE();
+}
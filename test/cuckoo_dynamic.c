@@ -0,0 +1,123 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+#include "../src/hash.h"
+
+static int allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+// only 64 different hashes
+static inline uint64_t bad_hash(uint64_t x) {
+  return tlbt_hash_mix64(x & 63);
+}
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_VALUE_T uint32_t
+#define TLBT_HASH(x) tlbt_hash_mix64(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME bad
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+#define TLBT_KEY_T const char *
+#define TLBT_KEY_T_NAME cstr
+#define TLBT_HASH(x) tlbt_hash_bytes64((x), strlen(x), 0)
+#define TLBT_EQUALS(a, b) (strcmp((a), (b)) == 0)
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/cuckoo.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // grows from the smallest size
+  {
+    tlbt_cuckoo_map_uint64_t_uint32_t m = {0};
+    tlbt_cuckoo_map_uint64_t_uint32_t_create(&m, 0);
+    tlbt_assert_msg(m.bucket_count == 2 && allocations == 1, "should have allocated the smallest table");
+    for (uint64_t i = 0; i < 100000; ++i)
+      tlbt_assert_msg(tlbt_cuckoo_map_uint64_t_uint32_t_insert(&m, i, (uint32_t)i * 3), "should have inserted");
+    tlbt_assert_msg(m.count == 100000, "wrong count");
+    tlbt_assert_fmt((double)m.count / (m.bucket_count * 4) > 0.45, "load of %f is too low",
+                    (double)m.count / (m.bucket_count * 4));
+    tlbt_assert_msg(allocations == frees + 1, "every replaced table should have been freed");
+
+    for (uint64_t i = 0; i < 100000; i += 4)
+      tlbt_assert_msg(tlbt_cuckoo_map_uint64_t_uint32_t_remove(&m, i), "should have removed element");
+    for (uint64_t i = 1; i < 100000; i += 4)
+      tlbt_cuckoo_map_uint64_t_uint32_t_insert_or_assign(&m, i, 7);
+    for (uint64_t i = 0; i < 100010; ++i) {
+      uint32_t value = 0;
+      const bool expected = i < 100000 && i % 4 != 0;
+      tlbt_assert_fmt(tlbt_cuckoo_map_uint64_t_uint32_t_get(&m, i, &value) == expected, "map is wrong about %d",
+                      (int)i);
+      tlbt_assert_msg(!expected || value == (i % 4 == 1 ? 7 : (uint32_t)i * 3), "wrong value associated with key");
+    }
+    tlbt_cuckoo_map_uint64_t_uint32_t_destroy(&m);
+    tlbt_assert_msg(allocations == frees, "everything should have been freed");
+  }
+
+  // a capacity which fits without growing
+  {
+    tlbt_cuckoo_map_uint64_t_uint32_t m = {0};
+    tlbt_cuckoo_map_uint64_t_uint32_t_create(&m, 3800);
+    tlbt_assert_msg(m.bucket_count == 1024, "3800 entries should fit into 1024 buckets");
+    const size_t buckets = m.bucket_count;
+    for (uint64_t i = 0; i < 3800; ++i)
+      tlbt_cuckoo_map_uint64_t_uint32_t_insert(&m, i, 0);
+    tlbt_assert_msg(m.bucket_count == buckets, "shouldn't have grown");
+    tlbt_cuckoo_map_uint64_t_uint32_t_destroy(&m);
+  }
+
+  // at most 8 keys per hash fit
+  {
+    tlbt_cuckoo_set_bad s = {0};
+    tlbt_cuckoo_set_bad_create(&s, 16);
+    for (uint64_t i = 0; i < 64 * 8; ++i)
+      tlbt_assert_fmt(tlbt_cuckoo_set_bad_insert(&s, i), "failed inserting key %d", (int)i);
+    tlbt_assert_msg(!tlbt_cuckoo_set_bad_insert(&s, 64 * 8), "a 9th key with the same hash shouldn't fit");
+    for (uint64_t i = 0; i < 64 * 9; ++i)
+      tlbt_assert_msg(tlbt_cuckoo_set_bad_contains(&s, i) == (i < 64 * 8), "set and reference disagree");
+    tlbt_cuckoo_set_bad_destroy(&s);
+  }
+
+  // string set
+  {
+    const char *words[] = {"de", "fr", "it", "es", "pt", "nl", "be", "at", "ch", "pl", "cz", "dk", "se", "no", "fi"};
+    const int word_count = (int)(sizeof(words) / sizeof(words[0]));
+    tlbt_cuckoo_set_cstr s = {0};
+    tlbt_cuckoo_set_cstr_create(&s, 4);
+    for (int i = 0; i < word_count; ++i)
+      tlbt_assert_msg(tlbt_cuckoo_set_cstr_insert(&s, words[i]), "should have inserted successfully");
+    char buffer[3] = {0};
+    for (int i = 0; i < word_count; ++i) {
+      memcpy(buffer, words[i], 2);
+      tlbt_assert_msg(!tlbt_cuckoo_set_cstr_insert(&s, buffer), "key should already exist");
+    }
+    tlbt_assert_msg(s.count == (size_t)word_count, "duplicates shouldn't be counted");
+    tlbt_assert_msg(!tlbt_cuckoo_set_cstr_contains(&s, "us"), "should not have found element");
+    tlbt_cuckoo_set_cstr_destroy(&s);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,68 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+#define TLBT_T int
+#define TLBT_STATIC
+#define TLBT_FAST_RANGE
+#define TLBT_COMPARE(a, b) ((a) - (b))
+#include "../src/deque.h"
+
+#define TLBT_T int
+#define TLBT_T_NAME dynamic
+#define TLBT_STATIC
+#define TLBT_FAST_RANGE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_NO_SORT
+#include "../src/deque.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // a capacity which isn't a power of 2. head and tail wrap around the end many times
+  {
+    tlbt_deque_int d = {0};
+    int buffer[7] = {0};
+    tlbt_deque_int_init(&d, 7, buffer);
+    int front = 0, back = 0;
+    for (int round = 0; round < 100; ++round) {
+      for (int i = 0; i < 5; ++i)
+        tlbt_assert_msg(tlbt_deque_int_push_back(&d, back++), "should have pushed to the back");
+      for (int i = 0; i < (int)d.count; ++i)
+        tlbt_assert_fmt(*tlbt_deque_int_at(&d, i) == front + i, "wrong value at %d in round %d", i, round);
+      for (int i = 0; i < 5; ++i) {
+        tlbt_assert_msg(*tlbt_deque_int_peek_front(&d) == front++, "wrong front");
+        tlbt_assert_msg(tlbt_deque_int_pop_front(&d), "should have popped the front");
+      }
+      tlbt_assert_msg(d.head < 7 && d.tail < 7, "indices should have wrapped");
+    }
+
+    for (int i = 0; i < 7; ++i)
+      tlbt_assert_msg(tlbt_deque_int_push_front(&d, i), "should have pushed to the front");
+    tlbt_assert_msg(!tlbt_deque_int_push_back(&d, 7), "deque should be full");
+    for (int i = 0; i < 7; ++i)
+      tlbt_assert_fmt(*tlbt_deque_int_at(&d, i) == 6 - i, "wrong value at %d", i);
+
+    tlbt_deque_int_sort(&d);
+    for (int i = 0; i < 7; ++i)
+      tlbt_assert_fmt(*tlbt_deque_int_at(&d, i) == i, "sorted incorrectly at %d", i);
+  }
+
+  // growing from 3 over 6 and 12 while the elements wrap around
+  {
+    tlbt_deque_dynamic d = {0};
+    tlbt_deque_dynamic_create(&d, 3);
+    tlbt_deque_dynamic_push_back(&d, 1);
+    tlbt_deque_dynamic_push_back(&d, 2);
+    tlbt_deque_dynamic_pop_front(&d);
+    for (int i = 3; i <= 10; ++i)
+      tlbt_deque_dynamic_push_back(&d, i);
+    tlbt_deque_dynamic_push_front(&d, 1);
+    tlbt_assert_msg(d.capacity == 12 && d.count == 10, "should have grown to 12");
+    for (int i = 0; i < 10; ++i)
+      tlbt_assert_fmt(*tlbt_deque_dynamic_at(&d, i) == i + 1, "wrong value at %d", i);
+    tlbt_deque_dynamic_destroy(&d);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,93 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+#include "../src/hash.h"
+#include "../src/hash.h"
+
+#define TLBT_KEY_T const char *
+#define TLBT_KEY_T_NAME cstr
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) TLBT_HASH_CSTR(x)
+#define TLBT_EQUALS(a, b) (strcmp((a), (b)) == 0)
+#define TLBT_BASE2_CAPACITY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// sequential keys masked to the lowest bits are the worst case for weak hashes with TLBT_BASE2_CAPACITY
+#define BUCKET_TEST(HASH, KEY_COUNT)                                                                                   \
+  do {                                                                                                                 \
+    unsigned buckets[1024] = {0};                                                                                      \
+    for (uint32_t i = 0; i < (KEY_COUNT); ++i)                                                                         \
+      ++buckets[(HASH) & 1023];                                                                                        \
+    unsigned max = 0;                                                                                                  \
+    for (int b = 0; b < 1024; ++b)                                                                                     \
+      max = buckets[b] > max ? buckets[b] : max;                                                                       \
+    /* the expected load is 16 per bucket */                                                                           \
+    tlbt_assert_fmt(max < 40, "%s distributes badly (%u keys in one bucket)", #HASH, max);                             \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // xxh64 reference values
+  tlbt_assert_msg(tlbt_hash_bytes64("", 0, 0) == 0xEF46DB3751D8E999ULL, "wrong hash of the empty string");
+  tlbt_assert_msg(tlbt_hash_bytes64("a", 1, 0) == 0xD24EC4F1A98C6E5BULL, "wrong hash of 'a'");
+  tlbt_assert_msg(tlbt_hash_bytes64("abc", 3, 0) == 0x44BC2CF5AD770999ULL, "wrong hash of 'abc'");
+
+  // the position in memory shouldn't matter and every length goes through a different tail
+  {
+    unsigned char buffer[128 + 8];
+    for (int i = 0; i < 128 + 8; ++i)
+      buffer[i] = (unsigned char)(i * 37 + 11);
+    for (size_t len = 0; len <= 100; ++len) {
+      unsigned char copy[100];
+      memcpy(copy, buffer + 3, len);
+      tlbt_assert_msg(tlbt_hash_bytes(buffer + 3, len) == tlbt_hash_bytes(copy, len), "unaligned hash differs");
+      if (len > 0)
+        tlbt_assert_msg(tlbt_hash_bytes(buffer + 3, len) != tlbt_hash_bytes(buffer + 3, len - 1),
+                        "prefixes should hash differently");
+      tlbt_assert_msg(tlbt_hash_crc32(buffer + 3, len) == tlbt_hash_crc32(copy, len), "unaligned crc differs");
+    }
+    tlbt_assert_msg(tlbt_hash_string("hello") == tlbt_hash_bytes("hello", 5), "string and bytes should match");
+  }
+
+  BUCKET_TEST(tlbt_hash_u32(i), 1 << 14);
+  BUCKET_TEST(tlbt_hash_u32(i << 10), 1 << 14);
+  BUCKET_TEST(tlbt_hash_u64((uint64_t)i << 32), 1 << 14);
+  BUCKET_TEST(tlbt_hash_ptr((const void *)(uintptr_t)(0x10000 + i * 64)), 1 << 14);
+  BUCKET_TEST(tlbt_hash_bytes(&i, sizeof(i)), 1 << 14);
+
+  // the mixers are bijective so small inputs must never collide
+  {
+    bool seen[4096] = {0};
+    for (uint32_t i = 0; i < 4096; ++i) {
+      const uint32_t h = tlbt_hash_mix32(i);
+      tlbt_assert_msg(tlbt_hash_mix32(i + 4096) != h, "mixer shouldn't collide");
+      seen[h & 4095] = true;
+    }
+    size_t used = 0;
+    for (int i = 0; i < 4096; ++i)
+      used += seen[i];
+    tlbt_assert_fmt(used > 2400, "only %zu of 4096 buckets used", used);
+  }
+
+  // ready-made macro with the hashmap
+  {
+    tlbt_map_cstr_int_key keys[16];
+    int values[16];
+    tlbt_map_cstr_int m = {0};
+    tlbt_map_cstr_int_init(&m, 16, keys, values);
+    const char *words[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+    for (int i = 0; i < 5; ++i)
+      tlbt_assert_msg(tlbt_map_cstr_int_insert(&m, words[i], i), "should have inserted successfully");
+    char buffer[16];
+    for (int i = 0; i < 5; ++i) {
+      // a different pointer with the same content
+      strcpy(buffer, words[i]);
+      int value = -1;
+      tlbt_assert_msg(tlbt_map_cstr_int_get(&m, buffer, &value) && value == i, "should have found element");
+    }
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,164 @@
+// MAP_ANONYMOUS isn't part of C99
+#define _DEFAULT_SOURCE
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+static int allocations = 0;
+static int zeroed_allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+// the slots of tables whose empty slots are zero come from here
+static void *custom_calloc(size_t count, size_t size) {
+  ++zeroed_allocations;
+  return calloc(count, size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_CALLOC custom_calloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// 0 is the empty key so zeroed slots are empty as well
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME zero
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_MAP_EMPTY_KEY 0u
+#define TLBT_MAP_DELETED_KEY 1u
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_CALLOC custom_calloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// the default sentinels aren't zero, so the slots have to be cleared after allocating them
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME sentinel
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_CALLOC custom_calloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// every array beyond 4 KiB is mmapped
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME mapped
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_MMAP
+#define TLBT_MAP_MMAP_THRESHOLD 4096
+#define TLBT_MAP_HUGE_PAGES
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME mapped_simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_MMAP
+#define TLBT_MAP_MMAP_THRESHOLD 4096
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define COUNT 100000
+
+// inserts COUNT keys while growing from 16 slots, removes every third one and checks all of them
+#define CHECK_MAP(TYPE)                                                                                                \
+  do {                                                                                                                 \
+    TYPE m = {0};                                                                                                      \
+    TYPE##_create(&m, 16);                                                                                             \
+    for (int i = 0; i < COUNT; ++i)                                                                                    \
+      tlbt_assert_msg(TYPE##_insert(&m, i, -i), #TYPE " should have inserted");                                        \
+    for (int i = 0; i < COUNT; i += 3)                                                                                 \
+      tlbt_assert_msg(TYPE##_remove(&m, i), #TYPE " should have removed");                                             \
+    for (int i = 0; i < COUNT; ++i) {                                                                                  \
+      int value = 0;                                                                                                   \
+      const bool found = TYPE##_get(&m, i, &value);                                                                    \
+      tlbt_assert_fmt(found == (i % 3 != 0) && (!found || value == -i), #TYPE " is wrong about %d", i);                \
+    }                                                                                                                  \
+    TYPE##_destroy(&m);                                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // the slots and the bitmap are zero allocated, the values aren't
+  {
+    CHECK_MAP(tlbt_map_int_int);
+    tlbt_assert_fmt(allocations > 0 && zeroed_allocations == allocations * 2,
+                    "%d zeroed allocations for %d tables", zeroed_allocations, allocations);
+    tlbt_assert_msg(frees == allocations + zeroed_allocations, "every allocation should have been freed");
+  }
+
+  {
+    allocations = zeroed_allocations = frees = 0;
+    tlbt_set_zero s = {0};
+    tlbt_set_zero_create(&s, 16);
+    tlbt_assert_msg(zeroed_allocations == 1 && allocations == 0, "zeroed slots are empty");
+    for (uint32_t i = 2; i < 1000; ++i)
+      tlbt_set_zero_insert(&s, i);
+    for (uint32_t i = 0; i < 1002; ++i)
+      tlbt_assert_fmt(tlbt_set_zero_contains(&s, i) == (i >= 2 && i < 1000), "set is wrong about %u", i);
+    tlbt_set_zero_destroy(&s);
+
+    allocations = zeroed_allocations = frees = 0;
+    tlbt_set_sentinel t = {0};
+    tlbt_set_sentinel_create(&t, 16);
+    tlbt_assert_msg(zeroed_allocations == 0 && allocations == 1, "zeroed slots aren't empty");
+    for (uint32_t i = 0; i < 1000; ++i)
+      tlbt_set_sentinel_insert(&t, i);
+    for (uint32_t i = 0; i < 1002; ++i)
+      tlbt_assert_fmt(tlbt_set_sentinel_contains(&t, i) == (i < 1000), "set is wrong about %u", i);
+    tlbt_set_sentinel_destroy(&t);
+  }
+
+  // small tables still use malloc, bigger ones are mmapped. both have to be freed the right way on every resize
+  {
+    CHECK_MAP(tlbt_map_mapped_int);
+    CHECK_MAP(tlbt_map_mapped_simd_int);
+
+    tlbt_map_mapped_int m = {0};
+    tlbt_map_mapped_int_create(&m, 1 << 16);
+    tlbt_map_mapped_int_insert(&m, 7, 7);
+    size_t bits = 0;
+    for (size_t w = 0; w < (m.capacity + 63) / 64; ++w)
+      bits += (size_t)__builtin_popcountll(m.occupancy[w]);
+    tlbt_assert_msg(bits == 1 && tlbt_map_mapped_int_contains(&m, 7) && !tlbt_map_mapped_int_contains(&m, 8),
+                    "fresh mmapped tables should be empty");
+    tlbt_map_mapped_int_destroy(&m);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,113 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_BATCH_CHUNK 7 // forces the keys to be split over several chunks
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // fixed memory map
+  {
+    tlbt_map_int_int_key keys[256];
+    int values[256];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 256, keys, values);
+
+    int lookup[100];
+    int results[100];
+    bool found[100];
+    tlbt_assert_msg(tlbt_map_int_int_get_batch(&m, lookup, 0, results, found) == 0, "empty batch finds nothing");
+    for (int i = 0; i < 100; ++i)
+      lookup[i] = i * 3;
+    tlbt_assert_msg(tlbt_map_int_int_contains_batch(&m, lookup, 100, found) == 0, "empty map contains nothing");
+
+    for (int i = 0; i < 150; ++i)
+      tlbt_map_int_int_insert(&m, i, -i);
+    for (int i = 0; i < 100; ++i)
+      results[i] = 12345;
+
+    tlbt_assert_msg(tlbt_map_int_int_get_batch(&m, lookup, 100, results, found) == 50, "should have found 50 keys");
+    for (int i = 0; i < 100; ++i) {
+      tlbt_assert_msg(found[i] == (lookup[i] < 150), "found the wrong keys");
+      tlbt_assert_msg(results[i] == (found[i] ? -lookup[i] : 12345), "wrong value or missing value overwritten");
+    }
+
+    uint32_t hashes[100];
+    for (int i = 0; i < 100; ++i)
+      hashes[i] = int_hash(lookup[i]);
+    tlbt_assert_msg(tlbt_map_int_int_contains_batch_ph(&m, lookup, hashes, 100, found) == 50,
+                    "should have found 50 keys");
+    for (int i = 0; i < 100; ++i)
+      tlbt_assert_msg(found[i] == (lookup[i] < 150), "found the wrong keys");
+  }
+
+  // dynamic map which is in the middle of an incremental resize
+  {
+    tlbt_map_simd_int m = {0};
+    tlbt_map_simd_int_create(&m, 16);
+    int i = 0;
+    for (; i < 100 || !m.old; ++i)
+      tlbt_map_simd_int_insert(&m, i, i * 2);
+
+    int lookup[300];
+    int results[300];
+    bool found[300];
+    for (int k = 0; k < 300; ++k)
+      lookup[k] = 299 - k;
+    const size_t expected = (size_t)(i < 300 ? i : 300);
+    tlbt_assert_msg(tlbt_map_simd_int_get_batch(&m, lookup, 300, results, found) == expected, "wrong amount found");
+    for (int k = 0; k < 300; ++k) {
+      tlbt_assert_msg(found[k] == (lookup[k] < i), "found the wrong keys");
+      tlbt_assert_msg(!found[k] || results[k] == lookup[k] * 2, "wrong value associated with key");
+    }
+    tlbt_map_simd_int_destroy(&m);
+  }
+
+  // set
+  {
+    tlbt_set_int_key keys[64];
+    tlbt_set_int s = {0};
+    tlbt_set_int_init(&s, 64, keys);
+    for (int i = 0; i < 32; i += 2)
+      tlbt_set_int_insert(&s, i);
+    int lookup[32];
+    bool found[32];
+    for (int i = 0; i < 32; ++i)
+      lookup[i] = i;
+    tlbt_assert_msg(tlbt_set_int_contains_batch(&s, lookup, 32, found) == 16, "should have found 16 keys");
+    for (int i = 0; i < 32; ++i)
+      tlbt_assert_msg(found[i] == (i % 2 == 0), "found the wrong keys");
+  }
+
+  TLBT_TEST_DONE();
+}
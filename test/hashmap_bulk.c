@@ -0,0 +1,150 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_COUNTERS
+#define TLBT_MAP_BATCH_CHUNK 7 // forces the keys to be split over several chunks
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME base2
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME fixed
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define COUNT 100000
+
+static int keys[COUNT];
+static int values[COUNT];
+
+int main(void) {
+  TLBT_TEST_START();
+
+  for (int i = 0; i < COUNT; ++i) {
+    keys[i] = i * 7;
+    values[i] = -i;
+  }
+
+  // reserve picks the smallest capacity which holds the entries
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    tlbt_map_int_int_reserve(&m, 11);
+    tlbt_assert_msg(m.capacity == 16 && m.counters.resizes == 0, "16 slots already hold 11 entries");
+    tlbt_map_int_int_reserve(&m, 1000);
+    tlbt_assert_fmt(m.capacity * 0.7 >= 1000 && (m.capacity - 1) * 0.7 < 1000, "%d slots aren't the minimum",
+                    (int)m.capacity);
+    tlbt_map_int_int_reserve(&m, 10);
+    tlbt_assert_msg(m.capacity >= 1000 / 0.7, "reserve shouldn't shrink");
+    for (int i = 0; i < 1000; ++i)
+      tlbt_map_int_int_insert(&m, i, i);
+    tlbt_assert_msg(m.counters.resizes == 1, "inserting the reserved entries shouldn't grow the map");
+    tlbt_map_int_int_destroy(&m);
+
+    tlbt_map_base2_int b = {0};
+    tlbt_map_base2_int_create(&b, 16);
+    tlbt_map_base2_int_reserve(&b, 1000);
+    tlbt_assert_fmt(b.capacity == 2048, "should have rounded up to 2048 slots, got %d", (int)b.capacity);
+    tlbt_map_base2_int_destroy(&b);
+  }
+
+  // one resize for the whole batch, no matter how many chunks it gets hashed in
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    for (int i = 0; i < 10; ++i)
+      tlbt_map_int_int_insert(&m, -1 - i, i);
+    tlbt_assert_msg(tlbt_map_int_int_insert_many(&m, keys, values, COUNT) == COUNT, "should have inserted all");
+    tlbt_assert_msg(m.count == COUNT + 10, "wrong count");
+    tlbt_assert_fmt(m.counters.resizes == 1, "should have resized once, resized %d times", (int)m.counters.resizes);
+    for (int i = 0; i < COUNT; ++i) {
+      int value = 0;
+      tlbt_assert_fmt(tlbt_map_int_int_get(&m, keys[i], &value) && value == values[i], "%d is missing", keys[i]);
+    }
+    for (int i = 0; i < 10; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_contains(&m, -1 - i), "earlier entries should still be there");
+    tlbt_assert_msg(tlbt_map_int_int_insert_many(&m, keys, values, 0) == 0, "empty batch inserts nothing");
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // with precomputed hashes while a migration is in progress
+  {
+    tlbt_map_base2_int m = {0};
+    tlbt_map_base2_int_create(&m, 64);
+    for (int i = 0; i < 45; ++i)
+      tlbt_map_base2_int_insert(&m, -1 - i, i);
+    tlbt_assert_msg(m.old != NULL, "a migration should be in progress");
+
+    static uint32_t hashes[COUNT];
+    for (int i = 0; i < COUNT; ++i)
+      hashes[i] = int_hash(keys[i]);
+    const uint64_t resizes = m.counters.resizes;
+    tlbt_assert_msg(tlbt_map_base2_int_insert_many_ph(&m, keys, values, hashes, COUNT) == COUNT,
+                    "should have inserted all");
+    tlbt_assert_msg(m.old == NULL && m.counters.resizes == resizes + 1, "should have resized once");
+    for (int i = 0; i < COUNT; ++i)
+      tlbt_assert_fmt(tlbt_map_base2_int_contains(&m, keys[i]), "%d is missing", keys[i]);
+    for (int i = 0; i < 45; ++i)
+      tlbt_assert_msg(tlbt_map_base2_int_contains(&m, -1 - i), "migrated entries should still be there");
+    tlbt_map_base2_int_destroy(&m);
+  }
+
+  // fixed memory stops once the map is full
+  {
+    tlbt_map_fixed_int_key fixed_keys[64];
+    int fixed_values[64];
+    uint8_t ctrl[64 + 16];
+    tlbt_map_fixed_int m = {0};
+    tlbt_map_fixed_int_init(&m, 64, fixed_keys, fixed_values, ctrl);
+    tlbt_assert_msg(tlbt_map_fixed_int_insert_many(&m, keys, values, 100) == 44, "should have filled the map");
+    for (int i = 0; i < 100; ++i)
+      tlbt_assert_fmt(tlbt_map_fixed_int_contains(&m, keys[i]) == (i < 44), "map is wrong about %d", keys[i]);
+  }
+
+  // set
+  {
+    tlbt_set_int s = {0};
+    tlbt_set_int_create(&s, 16);
+    tlbt_assert_msg(tlbt_set_int_insert_many(&s, keys, 5000) == 5000 && s.count == 5000, "should have inserted all");
+    tlbt_assert_msg(5000 <= s.capacity * 0.7 && 5000 > (s.capacity - 1) * 0.7, "should have reserved once");
+    for (int i = 0; i < 5000; ++i)
+      tlbt_assert_fmt(tlbt_set_int_contains(&s, keys[i]), "%d is missing", keys[i]);
+    tlbt_set_int_destroy(&s);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -96,6 +96,23 @@ static inline int equals_ref_test_func(const char *left, const char *right) {
 #define TLBT_STATIC
 #include "../src/hashmap.h"
 
+// simd probing
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_MAP_SIMD_PROBE
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) (x)
+#define TLBT_EQUALS(a, b) (a == b)
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
 int main(void) {
   return 0;
 }
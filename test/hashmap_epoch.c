@@ -0,0 +1,144 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+// the largest generation before wrapping around
+#define MAX_EPOCH ((1u << 30) - 1)
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_EPOCH
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME dynamic
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_EPOCH
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // clearing only bumps the generation
+  {
+    tlbt_map_int_int_key keys[64];
+    int values[64];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 64, keys, values);
+    tlbt_assert_msg(m.epoch == 1, "a new map should start at the first generation");
+
+    // leaves tombstones behind so stale ones have to count as empty as well
+    bool present[100] = {0};
+    for (int round = 0; round < 50; ++round) {
+      for (int i = 0; i < 40; ++i) {
+        const int key = (round * 7 + i * 13) % 100;
+        if (present[key])
+          present[key] = !tlbt_map_int_int_remove(&m, key);
+        else
+          present[key] = tlbt_map_int_int_insert(&m, key, key + round);
+      }
+      for (int k = 0; k < 100; ++k)
+        tlbt_assert_fmt(tlbt_map_int_int_contains(&m, k) == present[k], "map is wrong about %d", k);
+
+      const uint32_t epoch = m.epoch;
+      tlbt_map_int_int_clear(&m);
+      tlbt_assert_msg(m.epoch == epoch + 1 && m.count == 0, "clear should start a new generation");
+      memset(present, 0, sizeof(present));
+      for (int k = 0; k < 100; ++k)
+        tlbt_assert_fmt(!tlbt_map_int_int_contains(&m, k), "%d should have been cleared", k);
+
+      tlbt_map_iterator_int_int it = {0};
+      tlbt_map_iterator_int_int_init(&it, &m);
+      int key = 0, value = 0;
+      tlbt_assert_msg(!tlbt_map_iterator_int_int_iterate(&it, &key, &value), "cleared map should be empty");
+    }
+
+    // a slot of an old generation is free for new entries
+    for (int i = 0; i < 44; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_insert(&m, i, i), "every slot should be available again");
+    tlbt_map_int_int_rehash(&m);
+    for (int i = 0; i < 44; ++i) {
+      int value = -1;
+      tlbt_assert_msg(tlbt_map_int_int_get(&m, i, &value) && value == i, "rehashing should keep the entries");
+    }
+  }
+
+  // wrapping around resets the slots, otherwise entries of the first generation would come back
+  {
+    tlbt_map_int_int_key keys[32];
+    int values[32];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 32, keys, values);
+    for (int i = 0; i < 10; ++i)
+      tlbt_map_int_int_insert(&m, i, i);
+    m.epoch = MAX_EPOCH - 1;
+    for (int i = 0; i < 10; ++i)
+      tlbt_assert_msg(!tlbt_map_int_int_contains(&m, i), "entries of other generations should be invisible");
+    tlbt_map_int_int_insert(&m, 50, 50);
+    tlbt_map_int_int_clear(&m);
+    tlbt_assert_msg(m.epoch == MAX_EPOCH, "should have bumped the generation");
+    tlbt_map_int_int_insert(&m, 60, 60);
+    tlbt_map_int_int_clear(&m);
+    tlbt_assert_msg(m.epoch == 1, "should have wrapped around");
+    for (int i = 0; i < 10; ++i)
+      tlbt_assert_msg(!tlbt_map_int_int_contains(&m, i), "wrapping around should have reset the slots");
+    tlbt_assert_msg(!tlbt_map_int_int_contains(&m, 50) && !tlbt_map_int_int_contains(&m, 60), "map should be empty");
+  }
+
+  // growing, migrating, the occupancy bitmap and saving
+  {
+    tlbt_map_dynamic_int m = {0};
+    tlbt_map_dynamic_int_create(&m, 16);
+    for (int round = 0; round < 20; ++round) {
+      for (int i = 0; i < 100 * round; ++i)
+        tlbt_map_dynamic_int_insert(&m, i, i ^ round);
+      tlbt_assert_msg(m.count == (size_t)(100 * round), "wrong count");
+      for (int i = 0; i < 100 * round + 10; ++i) {
+        int value = -1;
+        const bool expected = i < 100 * round;
+        tlbt_assert_fmt(tlbt_map_dynamic_int_get(&m, i, &value) == expected, "map is wrong about %d", i);
+        tlbt_assert_msg(!expected || value == (i ^ round), "value of an older generation was returned");
+      }
+      size_t visited = 0;
+      tlbt_map_iterator_dynamic_int it = {0};
+      tlbt_map_iterator_dynamic_int_init(&it, &m);
+      int key = 0, value = 0;
+      while (tlbt_map_iterator_dynamic_int_iterate(&it, &key, &value))
+        ++visited;
+      tlbt_assert_msg(visited == m.count, "iterator should only visit the current generation");
+      if (round != 19)
+        tlbt_map_dynamic_int_clear(&m);
+    }
+
+    FILE *file = tmpfile();
+    tlbt_assert_msg(file && tlbt_map_dynamic_int_save(&m, file), "should have saved the map");
+    rewind(file);
+    tlbt_map_dynamic_int loaded = {0};
+    tlbt_assert_msg(tlbt_map_dynamic_int_load(&loaded, file), "should have loaded the map");
+    tlbt_assert_msg(loaded.epoch == m.epoch && loaded.count == m.count, "generation should have been saved");
+    for (int i = 0; i < 1900; ++i)
+      tlbt_assert_msg(tlbt_map_dynamic_int_contains(&loaded, i), "loaded map should have every entry");
+    tlbt_map_dynamic_int_clear(&loaded);
+    tlbt_assert_msg(!tlbt_map_dynamic_int_contains(&loaded, 5), "loaded map should be clearable");
+    tlbt_map_dynamic_int_destroy(&loaded);
+    tlbt_map_dynamic_int_destroy(&m);
+    fclose(file);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,178 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+#include "../src/hash.h"
+
+static inline uint32_t int_hash(int x) {
+  return tlbt_hash_mix32((uint32_t)x);
+}
+
+// keys are their own hash so the home slot is hash * capacity >> 32
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME placed
+#define TLBT_HASH(x) (x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_STORE_HASH
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd_fixed
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME integer
+#define TLBT_VALUE_T int
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME large
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) tlbt_hash_mix64((uint64_t)(x))
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_FAST_RANGE
+#define TLBT_MAP_LARGE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define COUNT 20000
+
+// grows from 10 slots over capacities which are never a power of 2, removes every third key, rehashes and checks all
+#define CHECK_MAP(TYPE)                                                                                                \
+  do {                                                                                                                 \
+    TYPE m = {0};                                                                                                      \
+    TYPE##_create(&m, 10);                                                                                             \
+    for (int i = 0; i < COUNT; ++i)                                                                                    \
+      tlbt_assert_msg(TYPE##_insert(&m, i, -i), #TYPE " should have inserted");                                        \
+    for (int i = 0; i < COUNT; i += 3)                                                                                 \
+      tlbt_assert_msg(TYPE##_remove(&m, i), #TYPE " should have removed");                                             \
+    TYPE##_rehash(&m);                                                                                                 \
+    for (int i = 0; i < COUNT; ++i) {                                                                                  \
+      int value = 0;                                                                                                   \
+      const bool found = TYPE##_get(&m, i, &value);                                                                    \
+      tlbt_assert_fmt(found == (i % 3 != 0) && (!found || value == -i), #TYPE " is wrong about %d", i);                \
+    }                                                                                                                  \
+    tlbt_assert_fmt(m.capacity % 10 == 0 && (m.capacity & (m.capacity - 1)) != 0, #TYPE " has capacity %zu",          \
+                    (size_t)m.capacity);                                                                               \
+    TYPE##_destroy(&m);                                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  {
+    tlbt_set_placed_key keys[10];
+    tlbt_set_placed s = {0};
+    tlbt_set_placed_init(&s, 10, keys);
+    tlbt_set_placed_insert(&s, 0x80000000u);
+    tlbt_set_placed_insert(&s, 0xFFFFFFFFu);
+    // home slot 9 is taken, so it wraps around to 0
+    tlbt_set_placed_insert(&s, 0xF0000000u);
+    tlbt_set_placed_insert(&s, 0x19999999u);
+    tlbt_assert_msg(s.keys[5].key == 0x80000000u && s.keys[9].key == 0xFFFFFFFFu && s.keys[0].key == 0xF0000000u &&
+                        s.keys[1].key == 0x19999999u,
+                    "keys should be in the slots of the upper bits of their hash");
+    tlbt_assert_msg(tlbt_set_placed_remove(&s, 0xFFFFFFFFu) && tlbt_set_placed_contains(&s, 0xF0000000u),
+                    "the wrapped key should be found past the tombstone");
+  }
+
+  {
+    CHECK_MAP(tlbt_map_int_int);
+    CHECK_MAP(tlbt_map_simd_int);
+    CHECK_MAP(tlbt_map_robin_hood_int);
+    CHECK_MAP(tlbt_map_integer_int);
+    CHECK_MAP(tlbt_map_large_int);
+  }
+
+  // the home slots have to spread the keys as well as modulo does
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 1000);
+    for (int i = 0; i < 600; ++i)
+      tlbt_map_int_int_insert(&m, i, i);
+    tlbt_map_stats_int_int stats;
+    tlbt_map_int_int_stats(&m, &stats);
+    tlbt_assert_fmt(stats.capacity == 1000 && stats.mean_probe_length < 3.0f, "mean probe length is %f",
+                    (double)stats.mean_probe_length);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // the control bytes can't be the upper bits of the hash which already picked the slot. neighbouring entries would
+  // all share them and nearly every probed entry would have to be compared
+  {
+    tlbt_map_simd_int m = {0};
+    tlbt_map_simd_int_create(&m, 30000);
+    for (int i = 0; i < 20000; ++i)
+      tlbt_map_simd_int_insert(&m, i, i);
+    const uint64_t equals = m.counters.equals;
+    for (int i = 20000; i < 40000; ++i)
+      tlbt_assert_msg(!tlbt_map_simd_int_contains(&m, i), "should be missing");
+    tlbt_assert_fmt(m.counters.equals - equals < 2000, "%llu comparisons for 20000 misses",
+                    (unsigned long long)(m.counters.equals - equals));
+    tlbt_map_simd_int_destroy(&m);
+  }
+
+  // tables smaller than a group wrap more than once while probing
+  {
+    tlbt_map_simd_fixed_int_key keys[5];
+    int values[5];
+    uint8_t ctrl[5 + 16];
+    tlbt_map_simd_fixed_int m = {0};
+    tlbt_map_simd_fixed_int_init(&m, 5, keys, values, ctrl);
+    for (int i = 0; i < 3; ++i)
+      tlbt_assert_msg(tlbt_map_simd_fixed_int_insert(&m, i, i * 2), "should have inserted");
+    for (int i = 0; i < 10; ++i) {
+      int value = 0;
+      const bool found = tlbt_map_simd_fixed_int_get(&m, i, &value);
+      tlbt_assert_fmt(found == (i < 3) && (!found || value == i * 2), "map is wrong about %d", i);
+    }
+  }
+
+  TLBT_TEST_DONE();
+}
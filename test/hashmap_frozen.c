@@ -0,0 +1,202 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+#include "../src/hash.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+// only 16 different hashes so most keys end up in the overflow
+static inline uint32_t bad_hash(int x) {
+  return (uint32_t)(x & 15) * 2654435761u;
+}
+
+// pairs of keys share a hash so half of them overflow
+static inline uint32_t pair_hash(int x) {
+  return (uint32_t)(x / 2) * 2654435761u;
+}
+
+static int compared = 0;
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME bad
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME incremental
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME pair
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) pair_hash(x)
+#define TLBT_EQUALS(a, b) (++compared, (a) == (b))
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T const char *
+#define TLBT_KEY_T_NAME cstr
+#define TLBT_HASH(x) TLBT_HASH_CSTR(x)
+#define TLBT_EQUALS(a, b) (strcmp((a), (b)) == 0)
+#define TLBT_MAP_FREEZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define FROZEN_TEST(MAP, KEY_COUNT)                                                                                    \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_create(&m, 16);                                                                               \
+    for (int i = 0; i < (KEY_COUNT); ++i)                                                                              \
+      tlbt_map_##MAP##_int_insert(&m, i * 3, i);                                                                       \
+    for (int i = 0; i < (KEY_COUNT); i += 5)                                                                           \
+      tlbt_map_##MAP##_int_remove(&m, i * 3);                                                                          \
+    tlbt_map_frozen_##MAP##_int f = {0};                                                                               \
+    tlbt_assert_msg(tlbt_map_##MAP##_int_freeze(&m, &f), "should have frozen the map");                                \
+    tlbt_assert_msg(f.count == m.count, "every entry should be in the frozen map");                                    \
+    tlbt_map_##MAP##_int_destroy(&m);                                                                                  \
+    for (int i = 0; i < (KEY_COUNT) * 3 + 10; ++i) {                                                                   \
+      int value = -1;                                                                                                  \
+      const bool expected = i % 3 == 0 && (i / 3) % 5 != 0 && i / 3 < (KEY_COUNT);                                    \
+      tlbt_assert_fmt(tlbt_map_frozen_##MAP##_int_get(&f, i, &value) == expected, "frozen map is wrong about %d", i); \
+      tlbt_assert_msg(!expected || value == i / 3, "wrong value associated with key");                                 \
+    }                                                                                                                  \
+    tlbt_map_frozen_##MAP##_int_destroy(&f);                                                                           \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  FROZEN_TEST(int, 1);
+  FROZEN_TEST(int, 1000);
+  FROZEN_TEST(int, 100000);
+  FROZEN_TEST(bad, 200);
+  // stops in the middle of a migration so the entries are spread over two tables
+  FROZEN_TEST(incremental, 1500);
+
+  // every slot is used and the perfect hash function sends every key to its own slot
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    for (int i = 0; i < 5000; ++i)
+      tlbt_map_int_int_insert(&m, i, i);
+    tlbt_map_frozen_int_int f = {0};
+    tlbt_assert_msg(tlbt_map_int_int_freeze(&m, &f), "should have frozen the map");
+    tlbt_assert_msg(f.slots == 5000 && f.count == 5000, "int_hash is bijective so nothing should overflow");
+    static bool seen[5000];
+    for (int i = 0; i < 5000; ++i) {
+      const uint32_t h = int_hash(i);
+      const size_t slot = _tlbt_map_int_int_frozen_slot(h, f.seeds[_tlbt_map_int_int_frozen_bucket(h, f.buckets)],
+                                                        f.slots);
+      tlbt_assert_msg(!seen[slot], "two keys share a slot");
+      seen[slot] = true;
+      tlbt_assert_msg(f.entries[slot].key == i, "key isn't in the slot the hash function points to");
+    }
+    tlbt_map_frozen_int_int_destroy(&f);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // colliding hashes overflow
+  {
+    tlbt_map_bad_int m = {0};
+    tlbt_map_bad_int_create(&m, 16);
+    for (int i = 0; i < 100; ++i)
+      tlbt_map_bad_int_insert(&m, i, i);
+    tlbt_map_frozen_bad_int f = {0};
+    tlbt_assert_msg(tlbt_map_bad_int_freeze(&m, &f), "should have frozen the map");
+    tlbt_assert_fmt(f.slots == 16 && f.count == 100, "expected 16 slots and 84 overflowing keys, got %zu slots",
+                    f.slots);
+    tlbt_map_frozen_bad_int_destroy(&f);
+    tlbt_map_bad_int_destroy(&m);
+  }
+
+  // misses don't compare any key and hits in the overflow don't scan it
+  {
+    tlbt_map_pair_int m = {0};
+    tlbt_map_pair_int_create(&m, 16);
+    for (int i = 0; i < 20000; ++i)
+      tlbt_map_pair_int_insert(&m, i, -i);
+    tlbt_map_frozen_pair_int f = {0};
+    tlbt_assert_msg(tlbt_map_pair_int_freeze(&m, &f), "should have frozen the map");
+    tlbt_assert_fmt(f.count - f.slots == 10000, "%zu keys overflowed", f.count - f.slots);
+    compared = 0;
+    for (int i = 20000; i < 40000; ++i)
+      tlbt_assert_msg(!tlbt_map_frozen_pair_int_contains(&f, i), "should be missing");
+    tlbt_assert_fmt(compared == 0, "%d comparisons for 20000 misses", compared);
+    for (int i = 0; i < 20000; ++i) {
+      int value = 0;
+      tlbt_assert_fmt(tlbt_map_frozen_pair_int_get(&f, i, &value) && value == -i, "should have found %d", i);
+    }
+    tlbt_assert_fmt(compared <= 30000, "%d comparisons for 20000 hits", compared);
+    // a key which shares its hash with a key in the map but isn't in it
+    tlbt_map_pair_int_remove(&m, 7);
+    tlbt_map_frozen_pair_int_destroy(&f);
+    tlbt_assert_msg(tlbt_map_pair_int_freeze(&m, &f), "should have frozen the map");
+    tlbt_assert_msg(!tlbt_map_frozen_pair_int_contains(&f, 7) && tlbt_map_frozen_pair_int_contains(&f, 6),
+                    "only the key left of the pair should be found");
+    tlbt_map_frozen_pair_int_destroy(&f);
+    tlbt_map_pair_int_destroy(&m);
+  }
+
+  // empty map
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    tlbt_map_frozen_int_int f = {0};
+    tlbt_assert_msg(tlbt_map_int_int_freeze(&m, &f), "should have frozen the map");
+    tlbt_assert_msg(!tlbt_map_frozen_int_int_contains(&f, 0), "frozen map should be empty");
+    tlbt_map_frozen_int_int_destroy(&f);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // string set
+  {
+    const char *words[] = {"de", "fr", "it", "es", "pt", "nl", "be", "at", "ch", "pl", "cz", "dk", "se", "no", "fi"};
+    const int word_count = (int)(sizeof(words) / sizeof(words[0]));
+    tlbt_set_cstr s = {0};
+    tlbt_set_cstr_create(&s, 16);
+    for (int i = 0; i < word_count; ++i)
+      tlbt_set_cstr_insert(&s, words[i]);
+    tlbt_set_frozen_cstr f = {0};
+    tlbt_assert_msg(tlbt_set_cstr_freeze(&s, &f), "should have frozen the set");
+    tlbt_set_cstr_destroy(&s);
+    char buffer[3] = {0};
+    for (int i = 0; i < word_count; ++i) {
+      memcpy(buffer, words[i], 2);
+      tlbt_assert_msg(tlbt_set_frozen_cstr_contains(&f, buffer), "should have found element");
+    }
+    tlbt_assert_msg(!tlbt_set_frozen_cstr_contains(&f, "us"), "should not have found element");
+    tlbt_set_frozen_cstr_destroy(&f);
+  }
+
+  TLBT_TEST_DONE();
+}
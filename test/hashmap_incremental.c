@@ -0,0 +1,132 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// a small migration step keeps an old table around for many operations so that lookups, removals, iteration and
+// copies all have to deal with entries spread over two tables
+#define INCREMENTAL_TEST(NAME)                                                                                         \
+  do {                                                                                                                 \
+    tlbt_map_##NAME##_int m = {0};                                                                                     \
+    tlbt_map_##NAME##_int_create(&m, 16);                                                                              \
+    bool saw_old_table = false;                                                                                        \
+    for (int i = 0; i < 1000; ++i) {                                                                                   \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_insert(&m, i, i * 2), "should have inserted successfully");                \
+      saw_old_table |= m.old != NULL;                                                                                  \
+      /* removing every fifth key right away hits entries in both tables */                                            \
+      if (i % 5 == 4)                                                                                                  \
+        tlbt_assert_msg(tlbt_map_##NAME##_int_remove(&m, i - 2), "should have removed element");                       \
+    }                                                                                                                  \
+    tlbt_assert_msg(saw_old_table, "there should have been a resize in progress");                                     \
+    tlbt_assert_msg(m.count == 800, "count should be 800");                                                            \
+                                                                                                                       \
+    tlbt_map_##NAME##_int m2 = {0};                                                                                    \
+    tlbt_map_##NAME##_int_create(&m2, 4096);                                                                           \
+    /* make sure the copy happens while a resize is still going on */                                                  \
+    tlbt_map_##NAME##_int_insert(&m, 1000, 2000);                                                                      \
+    while (!m.old) {                                                                                                   \
+      const int key = (int)m.count + 200;                                                                              \
+      tlbt_map_##NAME##_int_insert(&m, key, key * 2);                                                                  \
+    }                                                                                                                  \
+    tlbt_assert_msg(tlbt_map_##NAME##_int_copy(&m2, &m), "should have succeeded copying");                             \
+    tlbt_assert_msg(m2.count == m.count, "copy should have the same count");                                           \
+                                                                                                                       \
+    int key = 0;                                                                                                       \
+    int value = 0;                                                                                                     \
+    size_t iterations = 0;                                                                                             \
+    tlbt_map_iterator_##NAME##_int iter = {0};                                                                         \
+    tlbt_map_iterator_##NAME##_int_init(&iter, &m);                                                                    \
+    while (tlbt_map_iterator_##NAME##_int_iterate(&iter, &key, &value)) {                                              \
+      tlbt_assert_msg(value == key * 2, "wrong value associated with key");                                            \
+      tlbt_assert_msg(key >= 1000 || key % 5 != 2, "removed key shouldn't be iterated");                               \
+      ++iterations;                                                                                                    \
+    }                                                                                                                  \
+    tlbt_assert_msg(iterations == m.count, "iteration count different from element count");                            \
+                                                                                                                       \
+    for (int i = 0; i < 1000; ++i) {                                                                                   \
+      const bool expected = i % 5 != 2;                                                                                \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_contains(&m2, i) == expected, "copy and original disagree");               \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_get(&m, i, &value) == expected, "removed keys should stay removed");       \
+      if (expected)                                                                                                    \
+        tlbt_assert_msg(value == i * 2, "wrong value associated with key");                                            \
+    }                                                                                                                  \
+                                                                                                                       \
+    /* the lookups above finished the migration */                                                                     \
+    tlbt_assert_msg(m.old == NULL, "the old table should have been freed");                                            \
+    for (int i = 2000; !m2.old; ++i)                                                                                   \
+      tlbt_map_##NAME##_int_insert(&m2, i, i * 2);                                                                     \
+    tlbt_map_##NAME##_int_clear(&m2);                                                                                  \
+    tlbt_assert_msg(m2.count == 0 && m2.old == NULL, "clear should drop the old table too");                           \
+    tlbt_assert_msg(!tlbt_map_##NAME##_int_contains(&m2, 1), "there shouldn't be anything left");                      \
+                                                                                                                       \
+    tlbt_map_##NAME##_int_destroy(&m);                                                                                 \
+    tlbt_map_##NAME##_int_destroy(&m2);                                                                                \
+    tlbt_assert_msg(allocations == frees, "there should be the same amount of allocations and frees");                 \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+  INCREMENTAL_TEST(int);
+  INCREMENTAL_TEST(robin_hood);
+  INCREMENTAL_TEST(simd);
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,145 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+// neither TLBT_HASH nor TLBT_EQUALS, the built-in mixer and == are used
+#define TLBT_KEY_T uint32_t
+#define TLBT_VALUE_T int
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// zero is a valid key here, so the sentinels are other values
+#define TLBT_KEY_T int64_t
+#define TLBT_VALUE_T int
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_MAP_EMPTY_KEY INT64_MIN
+#define TLBT_MAP_DELETED_KEY (INT64_MIN + 1)
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// keys are their own hash so they can be put into specific slots
+#define TLBT_KEY_T uint32_t
+#define TLBT_KEY_T_NAME fixed
+#define TLBT_HASH(x) (x)
+#define TLBT_MAP_INTEGER_KEY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+int main(void) {
+  TLBT_TEST_START();
+
+  tlbt_assert_msg(sizeof(tlbt_map_uint32_t_int_key) == sizeof(uint32_t), "the slots should only hold the key");
+  tlbt_assert_msg(sizeof(tlbt_set_fixed_key) == sizeof(uint32_t), "the slots should only hold the key");
+
+  {
+    tlbt_map_uint32_t_int m = {0};
+    tlbt_map_uint32_t_int_create(&m, 16);
+    for (uint32_t i = 0; i < 10000; ++i)
+      tlbt_assert_msg(tlbt_map_uint32_t_int_insert(&m, i, (int)i * 3), "should have inserted");
+    tlbt_assert_msg(m.count == 10000, "wrong count");
+    for (uint32_t i = 0; i < 10000; ++i) {
+      int value = 0;
+      tlbt_assert_fmt(tlbt_map_uint32_t_int_get(&m, i, &value) && value == (int)i * 3, "%u is missing", i);
+    }
+    tlbt_assert_msg(!tlbt_map_uint32_t_int_contains(&m, (uint32_t)-1), "the empty key is never contained");
+    tlbt_assert_msg(!tlbt_map_uint32_t_int_contains(&m, (uint32_t)-2), "the deleted key is never contained");
+
+    for (uint32_t i = 0; i < 10000; i += 2)
+      tlbt_assert_msg(tlbt_map_uint32_t_int_remove(&m, i), "should have removed");
+    tlbt_map_stats_uint32_t_int stats;
+    tlbt_map_uint32_t_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.count == 5000 && stats.tombstones == 5000, "removed keys should leave tombstones");
+
+    // rehashing drops the tombstones and every remaining key has to be found again
+    tlbt_map_uint32_t_int_rehash(&m);
+    tlbt_map_uint32_t_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.count == 5000 && stats.tombstones == 0, "rehash should have dropped the tombstones");
+    for (uint32_t i = 0; i < 10000; ++i) {
+      int value = 0;
+      const bool found = tlbt_map_uint32_t_int_get(&m, i, &value);
+      tlbt_assert_fmt(found == (i % 2 == 1) && (!found || value == (int)i * 3), "map is wrong about %u", i);
+    }
+
+    size_t visited = 0;
+    tlbt_map_iterator_uint32_t_int it = {0};
+    tlbt_map_iterator_uint32_t_int_init(&it, &m);
+    uint32_t key = 0;
+    int value = 0;
+    while (tlbt_map_iterator_uint32_t_int_iterate(&it, &key, &value)) {
+      tlbt_assert_fmt(key % 2 == 1 && value == (int)key * 3, "iterated over %u", key);
+      ++visited;
+    }
+    tlbt_assert_msg(visited == 5000, "iterator visited the wrong number of entries");
+
+    tlbt_map_uint32_t_int_clear(&m);
+    tlbt_assert_msg(m.count == 0 && !tlbt_map_uint32_t_int_contains(&m, 1), "clear should have removed all");
+    tlbt_map_uint32_t_int_destroy(&m);
+  }
+
+  // custom sentinels with zero and negative keys during incremental resizing
+  {
+    tlbt_map_int64_t_int m = {0};
+    tlbt_map_int64_t_int_create(&m, 16);
+    bool migrating = false;
+    for (int64_t i = -2000; i < 2000; ++i) {
+      tlbt_map_int64_t_int_insert(&m, i, (int)i);
+      migrating |= m.old != NULL;
+    }
+    tlbt_assert_msg(migrating, "should have resized incrementally");
+    for (int64_t i = -2000; i < 2000; i += 3)
+      tlbt_assert_msg(tlbt_map_int64_t_int_remove(&m, i), "should have removed");
+    for (int64_t i = -2000; i < 2000; ++i) {
+      int value = 0;
+      const bool found = tlbt_map_int64_t_int_get(&m, i, &value);
+      tlbt_assert_fmt(found == ((i + 2000) % 3 != 0) && (!found || value == (int)i), "map is wrong about %d", (int)i);
+    }
+    size_t bits = 0;
+    for (size_t w = 0; w < (m.capacity + 63) / 64; ++w)
+      bits += (size_t)__builtin_popcountll(m.occupancy[w]);
+    tlbt_assert_msg(m.old != NULL || bits == m.count, "bitmap is wrong");
+    tlbt_map_int64_t_int_destroy(&m);
+  }
+
+  // a table without a single empty slot left. rehash can't start behind one and has to take more than one pass
+  {
+    tlbt_set_fixed_key keys[32];
+    tlbt_set_fixed s = {0};
+    tlbt_set_fixed_init(&s, 32, keys);
+    for (uint32_t i = 0; i < 32; ++i) {
+      tlbt_set_fixed_insert(&s, i);
+      tlbt_set_fixed_remove(&s, i);
+    }
+    // 69 and 95 sit behind the tombstones 37 and 63 leave behind. 95 wraps around the end
+    const uint32_t inserted[] = {5, 37, 69, 31, 63, 95};
+    for (size_t i = 0; i < sizeof(inserted) / sizeof(inserted[0]); ++i)
+      tlbt_set_fixed_insert(&s, inserted[i]);
+    tlbt_set_fixed_remove(&s, 37);
+    tlbt_set_fixed_remove(&s, 63);
+    for (uint32_t i = 0; i < 32; ++i)
+      tlbt_assert_fmt(s.keys[i].key != (uint32_t)-1, "slot %u shouldn't be empty", i);
+
+    tlbt_set_fixed_rehash(&s);
+    tlbt_assert_msg(s.keys[5].key == 5 && s.keys[6].key == 69 && s.keys[31].key == 31 && s.keys[0].key == 95,
+                    "entries should have moved into the tombstones in front of them");
+    for (uint32_t i = 0; i < 32; ++i) {
+      const bool kept = i == 0 || i == 5 || i == 6 || i == 31;
+      tlbt_assert_fmt(kept || s.keys[i].key == (uint32_t)-1, "slot %u should be empty", i);
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+      const bool contained = i == 5 || i == 69 || i == 31 || i == 95;
+      tlbt_assert_fmt(tlbt_set_fixed_contains(&s, i) == contained, "set is wrong about %u", i);
+    }
+  }
+
+  TLBT_TEST_DONE();
+}
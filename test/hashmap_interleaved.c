@@ -0,0 +1,182 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T point
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME linear
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_MAP_FREEZE
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_AUTO_SHRINK
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// same as linear but with the values in a separate array
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME split
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// inserts, overwrites, removes and looks up every key. then the iterator has to visit exactly the remaining entries
+#define CHECK_MAP(MAP)                                                                                                 \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_create(&m, 16);                                                                               \
+    for (int i = 0; i < 20000; ++i)                                                                                    \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_insert(&m, i, i * 2), "should have inserted");                            \
+    for (int i = 0; i < 20000; i += 3)                                                                                 \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, i), "should have removed element");                            \
+    for (int i = 1; i < 20000; i += 3)                                                                                 \
+      tlbt_map_##MAP##_int_insert_or_assign(&m, i, -i);                                                                \
+    bool inserted = false;                                                                                             \
+    *tlbt_map_##MAP##_int_get_or_insert(&m, 20000, &inserted) = 7;                                                     \
+    tlbt_assert_msg(inserted, "key should have been missing");                                                         \
+    for (int i = 0; i < 20010; ++i) {                                                                                  \
+      int value = 0;                                                                                                   \
+      const bool expected = i <= 20000 && i % 3 != 0;                                                                  \
+      tlbt_assert_fmt(tlbt_map_##MAP##_int_get(&m, i, &value) == expected, #MAP " map is wrong about %d", i);         \
+      const int expected_value = i == 20000 ? 7 : i % 3 == 1 ? -i : i * 2;                                             \
+      tlbt_assert_fmt(!expected || value == expected_value, #MAP " map has the wrong value for %d", i);               \
+    }                                                                                                                  \
+    tlbt_map_iterator_##MAP##_int it = {0};                                                                            \
+    tlbt_map_iterator_##MAP##_int_init(&it, &m);                                                                       \
+    int key = 0, value = 0;                                                                                            \
+    size_t visited = 0;                                                                                                \
+    while (tlbt_map_iterator_##MAP##_int_iterate(&it, &key, &value)) {                                                 \
+      tlbt_assert_fmt(key == 20000 ? value == 7 : value == (key % 3 == 1 ? -key : key * 2),                            \
+                      #MAP " iterator returned the wrong value for %d", key);                                         \
+      ++visited;                                                                                                       \
+    }                                                                                                                  \
+    tlbt_assert_msg(visited == m.count, #MAP " iterator should visit every entry once");                              \
+    tlbt_map_##MAP##_int_destroy(&m);                                                                                  \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // the value is part of the key slot
+  {
+    tlbt_assert_msg(sizeof(tlbt_map_int_point_key) >= sizeof(int) + sizeof(point), "the value should be in the slot");
+    tlbt_map_int_point_key keys[32];
+    tlbt_map_int_point m = {0};
+    tlbt_map_int_point_init(&m, 32, keys);
+    // 32 slots with a max load factor of 0.7 take 22 entries
+    for (int i = 0; i < 23; ++i)
+      tlbt_assert_fmt(tlbt_map_int_point_insert(&m, i, (point){i, -i}) == (i < 22), "wrong insert result for %d", i);
+
+    point p = {0};
+    tlbt_assert_msg(tlbt_map_int_point_get(&m, 5, &p) && p.x == 5 && p.y == -5, "wrong value associated with key");
+    size_t slot = 0;
+    tlbt_assert_msg(_tlbt_map_int_point_find_entry(&m, 5, int_hash(5), &slot), "should have found the slot");
+    tlbt_assert_msg(keys[slot].key == 5 && keys[slot].value.x == 5, "value should be stored next to the key");
+
+    tlbt_map_iterator_int_point it = {0};
+    tlbt_map_iterator_int_point_init(&it, &m);
+    const int *key = NULL;
+    point *value = NULL;
+    while (tlbt_map_iterator_int_point_iterate_ref(&it, &key, &value))
+      value->y = 100;
+    tlbt_assert_msg(tlbt_map_int_point_get(&m, 21, &p) && p.y == 100, "references should point into the slots");
+  }
+
+  CHECK_MAP(linear);
+  CHECK_MAP(robin);
+  CHECK_MAP(simd);
+
+  // a lookup of a migrating key has to find the value in the old table
+  {
+    tlbt_map_simd_int m = {0};
+    tlbt_map_simd_int_create(&m, 16);
+    for (int i = 0; i < 11; ++i)
+      tlbt_map_simd_int_insert(&m, i, i + 100);
+    tlbt_map_simd_int_insert(&m, 11, 111);
+    tlbt_assert_msg(m.old != NULL, "a migration should be in progress");
+    for (int i = 0; i < 12; ++i) {
+      int value = 0;
+      tlbt_assert_msg(tlbt_map_simd_int_get(&m, i, &value) && value == i + 100, "wrong value during migration");
+    }
+    tlbt_map_simd_int_destroy(&m);
+  }
+
+  // freezing and saving take the values from the slots
+  {
+    tlbt_map_linear_int m = {0};
+    tlbt_map_linear_int_create(&m, 16);
+    for (int i = 0; i < 1000; ++i)
+      tlbt_map_linear_int_insert(&m, i, i * 3);
+
+    tlbt_map_frozen_linear_int f = {0};
+    tlbt_assert_msg(tlbt_map_linear_int_freeze(&m, &f), "should have frozen the map");
+    for (int i = 0; i < 1000; ++i) {
+      int value = 0;
+      tlbt_assert_msg(tlbt_map_frozen_linear_int_get(&f, i, &value) && value == i * 3, "frozen map has wrong value");
+    }
+    tlbt_map_frozen_linear_int_destroy(&f);
+
+    FILE *file = tmpfile();
+    tlbt_assert_msg(file, "failed to create temporary file");
+    tlbt_assert_msg(tlbt_map_linear_int_save(&m, file), "should have saved the map");
+    rewind(file);
+    tlbt_map_split_int split = {0};
+    tlbt_assert_msg(!tlbt_map_split_int_load(&split, file), "a split map shouldn't load an interleaved file");
+    rewind(file);
+    tlbt_map_linear_int loaded = {0};
+    tlbt_assert_msg(tlbt_map_linear_int_load(&loaded, file), "should have loaded the map");
+    for (int i = 0; i < 1000; ++i) {
+      int value = 0;
+      tlbt_assert_msg(tlbt_map_linear_int_get(&loaded, i, &value) && value == i * 3, "loaded map has wrong value");
+    }
+    tlbt_map_linear_int_destroy(&loaded);
+    tlbt_map_linear_int_destroy(&m);
+    fclose(file);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,100 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int equals_calls = 0;
+
+static inline bool counting_equals(uint64_t a, uint64_t b) {
+  ++equals_calls;
+  return a == b;
+}
+
+// the lower 32 bits are the same for every key. only the upper half tells them apart
+static inline uint64_t upper_hash(uint64_t x) {
+  return (x * 0x9E3779B97F4A7C15ULL) << 32 | 0x1234;
+}
+
+// the low bits pick the slot, bits 25 to 31 where a 32 bit map takes its control byte from never change
+static inline uint64_t split_hash(uint64_t x) {
+  return (x * 0x9E3779B97F4A7C15ULL) << 32 | (x & 0xFFFF);
+}
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME u64
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) upper_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_MAP_LARGE
+#define TLBT_MAP_STORE_HASH
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) upper_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_MAP_LARGE
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T uint64_t
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) split_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_MAP_LARGE
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_BASE2_CAPACITY
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define LARGE_TEST(MAP, ...)                                                                                           \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int_key keys[64];                                                                                 \
+    int values[64];                                                                                                    \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_init(&m, 64, keys, values);                                                                   \
+    for (uint64_t i = 0; i < 40; ++i)                                                                                  \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_insert(&m, i, (int)i), "should have inserted successfully");               \
+    for (uint64_t i = 0; i < 40; i += 3)                                                                               \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, i), "should have removed element");                              \
+    equals_calls = 0;                                                                                                  \
+    for (uint64_t i = 0; i < 80; ++i) {                                                                                \
+      int value = -1;                                                                                                  \
+      const bool expected = i < 40 && i % 3 != 0;                                                                      \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_get(&m, i, &value) == expected, "map and reference disagree");              \
+      tlbt_assert_msg(!expected || value == (int)i, "wrong value associated with key");                                \
+    }                                                                                                                  \
+    /* a 32 bit hash would have made every stored hash match */                                                        \
+    tlbt_assert_fmt(equals_calls == 26, "only the hits should compare keys (%d equals calls)", equals_calls);          \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  tlbt_assert_msg(sizeof(((tlbt_map_u64_int_key *)0)->index) == 8, "the metadata should be 64 bit wide");
+  tlbt_assert_msg(sizeof(((tlbt_map_u64_int_key *)0)->hash) == 8, "the stored hash should be 64 bit wide");
+
+  LARGE_TEST(u64);
+  LARGE_TEST(robin_hood);
+
+  // the control bytes take the upper 7 bits of the 64 bit hash
+  {
+    tlbt_map_simd_int m = {0};
+    tlbt_map_simd_int_create(&m, 16);
+    for (uint64_t i = 0; i < 1000; ++i)
+      tlbt_map_simd_int_insert_ph(&m, i, (int)i, split_hash(i));
+    equals_calls = 0;
+    for (uint64_t i = 0; i < 2000; ++i)
+      tlbt_assert_msg(tlbt_map_simd_int_contains(&m, i) == (i < 1000), "map and reference disagree");
+    // 1000 hits plus roughly one in 128 control bytes matching by accident
+    tlbt_assert_fmt(equals_calls < 1300, "control bytes should filter most keys (%d equals calls)", equals_calls);
+    tlbt_map_simd_int_destroy(&m);
+  }
+
+  TLBT_TEST_DONE();
+}
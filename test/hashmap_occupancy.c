@@ -0,0 +1,233 @@
+// mmap and fileno are POSIX and not part of C99
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+// only 16 different hashes so there are long probe sequences and a lot of shifting and displacing
+static inline uint32_t bad_hash(int x) {
+  return int_hash(x & 15);
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_AUTO_SHRINK
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_NO_ITERATOR
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+typedef struct visit_state {
+  int visited;
+  long long key_sum;
+  int stop_after;
+} visit_state;
+
+static bool visit_int(const int *key, int *value, void *userdata) {
+  visit_state *state = userdata;
+  tlbt_assert_fmt(*value == *key * 2, "visited %d with the wrong value", *key);
+  state->key_sum += *key;
+  return ++state->visited != state->stop_after;
+}
+
+static bool visit_set(const int *key, void *userdata) {
+  visit_state *state = userdata;
+  state->key_sum += *key;
+  return ++state->visited != state->stop_after;
+}
+
+// every set bit has to belong to an entry which is found in exactly that slot. together with the number of set bits
+// matching the count this means the bitmap and the slots agree
+#define COUNT_BITS(MAP, HASH, table, bits)                                                                             \
+  do {                                                                                                                 \
+    const tlbt_map_##MAP##_int *t = (table);                                                                           \
+    for (size_t i = 0; t && i < t->capacity; ++i) {                                                                    \
+      if (!((t->occupancy[i / 64] >> (i % 64)) & 1))                                                                   \
+        continue;                                                                                                      \
+      size_t slot = 0;                                                                                                 \
+      tlbt_assert_fmt(_tlbt_map_##MAP##_int_find_entry(t, t->keys[i].key, HASH(t->keys[i].key), &slot) && slot == i,   \
+                      #MAP " bitmap is wrong about slot %d", (int)i);                                                  \
+      ++(bits);                                                                                                        \
+    }                                                                                                                  \
+  } while (0)
+
+#define CHECK_BITMAP(MAP, HASH, m, old)                                                                                \
+  do {                                                                                                                 \
+    size_t bits = 0;                                                                                                   \
+    COUNT_BITS(MAP, HASH, m, bits);                                                                                    \
+    COUNT_BITS(MAP, HASH, old, bits);                                                                                  \
+    tlbt_assert_fmt(bits == (m)->count, #MAP " bitmap has %d bits set for %d entries", (int)bits, (int)(m)->count);    \
+  } while (0)
+
+// removes most keys of a big map and checks that iterating and for_each visit exactly the remaining ones
+#define CHECK_MAP(MAP, HASH, OLD)                                                                                      \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_create(&m, 16);                                                                               \
+    for (int i = 0; i < 3000; ++i)                                                                                     \
+      tlbt_map_##MAP##_int_insert(&m, i, i * 2);                                                                       \
+    CHECK_BITMAP(MAP, HASH, &m, OLD);                                                                                  \
+    long long expected_sum = 0;                                                                                        \
+    for (int i = 0; i < 3000; ++i) {                                                                                   \
+      if (i % 97 == 0)                                                                                                 \
+        expected_sum += i;                                                                                             \
+      else                                                                                                             \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, i), "should have removed element");                            \
+    }                                                                                                                  \
+    CHECK_BITMAP(MAP, HASH, &m, OLD);                                                                                  \
+                                                                                                                       \
+    tlbt_map_iterator_##MAP##_int it = {0};                                                                            \
+    tlbt_map_iterator_##MAP##_int_init(&it, &m);                                                                       \
+    int key = 0, value = 0, visited = 0;                                                                               \
+    long long sum = 0;                                                                                                 \
+    while (tlbt_map_iterator_##MAP##_int_iterate(&it, &key, &value)) {                                                 \
+      tlbt_assert_fmt(key % 97 == 0 && value == key * 2, "iterated over removed key %d", key);                         \
+      sum += key;                                                                                                      \
+      ++visited;                                                                                                       \
+    }                                                                                                                  \
+    tlbt_assert_msg((size_t)visited == m.count && sum == expected_sum, #MAP " iterator missed entries");               \
+                                                                                                                       \
+    visit_state state = {0, 0, -1};                                                                                    \
+    tlbt_map_##MAP##_int_for_each(&m, visit_int, &state);                                                              \
+    tlbt_assert_msg((size_t)state.visited == m.count && state.key_sum == expected_sum,                                 \
+                    #MAP " for_each missed entries");                                                                  \
+    state = (visit_state){0, 0, 5};                                                                                    \
+    tlbt_map_##MAP##_int_for_each(&m, visit_int, &state);                                                              \
+    tlbt_assert_msg(state.visited == 5, #MAP " for_each should stop once the visitor returns false");                  \
+                                                                                                                       \
+    tlbt_map_##MAP##_int_rehash(&m);                                                                                   \
+    CHECK_BITMAP(MAP, HASH, &m, OLD);                                                                                  \
+    tlbt_map_##MAP##_int_clear(&m);                                                                                    \
+    CHECK_BITMAP(MAP, HASH, &m, OLD);                                                                                  \
+    tlbt_map_iterator_##MAP##_int_reset(&it);                                                                          \
+    tlbt_assert_msg(!tlbt_map_iterator_##MAP##_int_iterate(&it, &key, &value), "cleared map should be empty");         \
+    tlbt_map_##MAP##_int_destroy(&m);                                                                                  \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  CHECK_MAP(int, int_hash, (tlbt_map_int_int *)NULL);
+  CHECK_MAP(robin, bad_hash, m.old);
+  CHECK_MAP(simd, bad_hash, (tlbt_map_simd_int *)NULL);
+
+  // the bitmap of an old table during incremental resizing
+  {
+    tlbt_map_robin_int m = {0};
+    tlbt_map_robin_int_create(&m, 64);
+    for (int i = 0; i < 45; ++i)
+      tlbt_map_robin_int_insert(&m, i, i * 2);
+    tlbt_map_robin_int_remove(&m, 3);
+    tlbt_assert_msg(m.old != NULL, "a migration should be in progress");
+    CHECK_BITMAP(robin, bad_hash, &m, m.old);
+    visit_state state = {0, 0, -1};
+    tlbt_map_robin_int_for_each(&m, visit_int, &state);
+    tlbt_assert_msg((size_t)state.visited == m.count, "for_each should visit both tables");
+    tlbt_map_iterator_robin_int it = {0};
+    tlbt_map_iterator_robin_int_init(&it, &m);
+    int key = 0, value = 0, visited = 0;
+    while (visited <= 45 && tlbt_map_iterator_robin_int_iterate(&it, &key, &value)) {
+      tlbt_assert_fmt(key != 3 && value == key * 2, "iterated over removed key %d", key);
+      ++visited;
+    }
+    tlbt_assert_fmt((size_t)visited == m.count, "iterator visited %d of %d entries in both tables", visited,
+                    (int)m.count);
+    tlbt_map_robin_int_destroy(&m);
+  }
+
+  // copies, loaded and viewed maps
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 1024);
+    for (int i = 0; i < 500; ++i)
+      tlbt_map_int_int_insert(&m, i, i * 2);
+    for (int i = 0; i < 500; i += 2)
+      tlbt_map_int_int_remove(&m, i);
+
+    tlbt_map_int_int copy = {0};
+    tlbt_map_int_int_create(&copy, 1024);
+    tlbt_map_int_int_insert(&copy, 1000, 0);
+    tlbt_assert_msg(tlbt_map_int_int_copy(&copy, &m), "should have copied");
+    CHECK_BITMAP(int, int_hash, &copy, (tlbt_map_int_int *)NULL);
+    tlbt_map_int_int_destroy(&copy);
+
+    FILE *file = tmpfile();
+    tlbt_assert_msg(file && tlbt_map_int_int_save(&m, file), "should have saved the map");
+    rewind(file);
+    tlbt_map_int_int loaded = {0};
+    tlbt_assert_msg(tlbt_map_int_int_load(&loaded, file), "should have loaded the map");
+    CHECK_BITMAP(int, int_hash, &loaded, (tlbt_map_int_int *)NULL);
+    tlbt_map_int_int_destroy(&loaded);
+
+    fseek(file, 0, SEEK_END);
+    const size_t size = (size_t)ftell(file);
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    tlbt_assert_msg(data != MAP_FAILED, "failed to map the file");
+    tlbt_map_int_int viewed = {0};
+    tlbt_assert_msg(tlbt_map_int_int_view(&viewed, data, size), "should have viewed the map");
+    tlbt_assert_msg(viewed.occupancy == NULL, "a viewed map shouldn't have a bitmap");
+    visit_state state = {0, 0, -1};
+    tlbt_map_int_int_for_each(&viewed, visit_int, &state);
+    tlbt_assert_msg(state.visited == 250 && state.key_sum == 250 * 250, "for_each should scan the viewed slots");
+    munmap(data, size);
+    fclose(file);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // set
+  {
+    tlbt_set_int s = {0};
+    tlbt_set_int_create(&s, 16);
+    for (int i = 0; i < 200; ++i)
+      tlbt_set_int_insert(&s, i);
+    visit_state state = {0, 0, -1};
+    tlbt_set_int_for_each(&s, visit_set, &state);
+    tlbt_assert_msg(state.visited == 200 && state.key_sum == 199 * 100, "for_each should visit every key");
+    tlbt_set_int_destroy(&s);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,165 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+#include <errno.h>
+#include <pthread.h>
+
+// lets the map create this many threads before creating threads fails. unlimited while negative
+static int creatable_threads = -1;
+
+static int create_thread(pthread_t *thread, const pthread_attr_t *attr, void *(*start)(void *), void *arg) {
+  if (creatable_threads == 0)
+    return EAGAIN;
+  if (creatable_threads > 0)
+    --creatable_threads;
+  return pthread_create(thread, attr, start, arg);
+}
+
+#define pthread_create create_thread
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+// only 64 different hashes so the runs of occupied slots get long and cross the regions of the threads
+static inline uint32_t bad_hash(int x) {
+  return int_hash(x & 63);
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_PARALLEL_BUILD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME crowded
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_EPOCH
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_MAP_PARALLEL_BUILD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_PARALLEL_BUILD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define COUNT 200000
+
+static int keys[COUNT];
+static int values[COUNT];
+
+// the first n keys have to be found with their values and iterating has to visit exactly count entries
+#define CHECK_MAP(MAP, m, n, expected)                                                                                 \
+  do {                                                                                                                 \
+    tlbt_assert_fmt((m)->count == (size_t)(expected), #MAP " has %d entries instead of %d", (int)(m)->count,           \
+                    (int)(expected));                                                                                  \
+    for (int i = 0; i < (n); ++i) {                                                                                    \
+      int value = 0;                                                                                                   \
+      tlbt_assert_fmt(tlbt_map_##MAP##_int_get((m), keys[i], &value) && value == values[i], #MAP " is missing %d",     \
+                      keys[i]);                                                                                        \
+    }                                                                                                                  \
+    size_t visited = 0;                                                                                                \
+    tlbt_map_iterator_##MAP##_int it = {0};                                                                            \
+    tlbt_map_iterator_##MAP##_int_init(&it, (m));                                                                      \
+    int key = 0, value = 0;                                                                                            \
+    while (tlbt_map_iterator_##MAP##_int_iterate(&it, &key, &value))                                                   \
+      ++visited;                                                                                                       \
+    tlbt_assert_msg(visited == (m)->count, #MAP " iterator visited the wrong number of entries");                      \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  for (int i = 0; i < COUNT; ++i) {
+    keys[i] = i * 11;
+    values[i] = i ^ 0x5555;
+  }
+
+  // different numbers of threads, including more threads than regions of 64 slots
+  {
+    const size_t threads[] = {1, 2, 3, 4, 7, 64};
+    const int counts[] = {0, 1, 10, 1000, COUNT};
+    for (size_t t = 0; t < sizeof(threads) / sizeof(threads[0]); ++t) {
+      for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+        tlbt_map_int_int m = {0};
+        tlbt_map_int_int_create(&m, 16);
+        tlbt_assert_msg(tlbt_map_int_int_build_parallel(&m, keys, values, counts[c], threads[t]) == (size_t)counts[c],
+                        "should have inserted every key");
+        CHECK_MAP(int, &m, counts[c], counts[c]);
+
+        // the bitmap has to agree with the slots
+        size_t bits = 0;
+        for (size_t w = 0; w < (m.capacity + 63) / 64; ++w)
+          bits += (size_t)__builtin_popcountll(m.occupancy[w]);
+        tlbt_assert_msg(bits == m.count, "bitmap is wrong");
+        tlbt_map_int_int_destroy(&m);
+      }
+    }
+  }
+
+  // long runs of occupied slots, an existing generation with tombstones and a migration in progress
+  {
+    tlbt_map_crowded_int m = {0};
+    tlbt_map_crowded_int_create(&m, 64);
+    for (int i = 0; i < 100; ++i)
+      tlbt_map_crowded_int_insert(&m, -1 - i, i);
+    tlbt_map_crowded_int_clear(&m);
+    int old = 0;
+    while (m.old == NULL)
+      tlbt_map_crowded_int_insert(&m, -1 - old++, 0);
+    for (int i = 0; i < 10; i += 2)
+      tlbt_map_crowded_int_remove(&m, -1 - i);
+    tlbt_assert_msg(m.old != NULL, "a migration should be in progress");
+
+    tlbt_assert_msg(tlbt_map_crowded_int_build_parallel(&m, keys, values, 5000, 4) == 5000, "should have inserted");
+    tlbt_assert_msg(m.old == NULL, "should have finished the migration first");
+    for (int i = 0; i < old; ++i) {
+      const bool removed = i < 10 && i % 2 == 0;
+      tlbt_assert_fmt(tlbt_map_crowded_int_contains(&m, -1 - i) != removed, "map is wrong about %d", -1 - i);
+    }
+    CHECK_MAP(crowded, &m, 5000, 5000 + old - 5);
+    tlbt_map_crowded_int_destroy(&m);
+  }
+
+  // the calling thread takes over the parts of the threads which couldn't be created
+  {
+    const int creatable[] = {0, 1, 2};
+    for (size_t k = 0; k < sizeof(creatable) / sizeof(creatable[0]); ++k) {
+      tlbt_map_int_int m = {0};
+      tlbt_map_int_int_create(&m, 16);
+      creatable_threads = creatable[k];
+      tlbt_assert_msg(tlbt_map_int_int_build_parallel(&m, keys, values, 10000, 4) == 10000, "should have inserted");
+      creatable_threads = -1;
+      CHECK_MAP(int, &m, 10000, 10000);
+      tlbt_map_int_int_destroy(&m);
+    }
+  }
+
+  // set
+  {
+    tlbt_set_int s = {0};
+    tlbt_set_int_create(&s, 16);
+    tlbt_assert_msg(tlbt_set_int_build_parallel(&s, keys, COUNT, 3) == COUNT && s.count == COUNT, "wrong count");
+    for (int i = 0; i < COUNT; ++i)
+      tlbt_assert_fmt(tlbt_set_int_contains(&s, keys[i]), "set is missing %d", keys[i]);
+    tlbt_set_int_destroy(&s);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,125 @@
+#include <stddef.h>
+#include <pthread.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_RCU
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_RCU
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// every version v of the map holds the keys 0 to KEYS - 1 with the value v. readers have to see a single version
+// within one read, never a mix of two or a snapshot which got freed already
+#define KEYS 500
+#define VERSIONS 200
+#define READERS 3
+
+typedef struct {
+  tlbt_map_rcu_int_int *rcu;
+  size_t reader;
+  int last;
+  bool mixed;
+} reader;
+
+static void *read_versions(void *arg) {
+  reader *r = (reader *)arg;
+  while (r->last < VERSIONS) {
+    tlbt_map_int_int *m = tlbt_map_rcu_int_int_read_begin(r->rcu, r->reader);
+    int version = 0;
+    const bool found = tlbt_map_int_int_get(m, 0, &version);
+    for (int i = 1; found && i < KEYS; ++i) {
+      int value = 0;
+      if (!tlbt_map_int_int_get(m, i, &value) || value != version)
+        r->mixed = true;
+    }
+    tlbt_map_rcu_int_int_read_end(r->rcu, r->reader);
+    if (found) {
+      r->mixed |= version < r->last;
+      r->last = version;
+    }
+  }
+  return NULL;
+}
+
+int main(void) {
+  TLBT_TEST_START();
+
+  {
+    tlbt_map_rcu_int_int rcu = {0};
+    tlbt_map_rcu_int_int_create(&rcu, READERS);
+    pthread_t handles[READERS];
+    reader readers[READERS];
+    for (size_t t = 0; t < READERS; ++t) {
+      readers[t] = (reader){&rcu, t, 0, false};
+      tlbt_assert_msg(pthread_create(&handles[t], NULL, read_versions, &readers[t]) == 0, "failed to create thread");
+    }
+    // even versions are built from scratch, odd ones are copies of the previous one with updated values
+    for (int v = 1; v <= VERSIONS; ++v) {
+      tlbt_map_int_int *next =
+          v % 2 == 0 ? tlbt_map_rcu_int_int_prepare(&rcu) : tlbt_map_rcu_int_int_prepare_copy(&rcu);
+      for (int i = 0; i < KEYS; ++i)
+        tlbt_map_int_int_insert_or_assign(next, i, v);
+      tlbt_map_rcu_int_int_publish(&rcu, next);
+    }
+    for (size_t t = 0; t < READERS; ++t) {
+      pthread_join(handles[t], NULL);
+      tlbt_assert_fmt(!readers[t].mixed, "reader %zu saw mixed or older versions", t);
+    }
+    tlbt_map_rcu_int_int_synchronize(&rcu);
+    tlbt_assert_msg(rcu.retired == NULL, "all replaced snapshots should be freed");
+    tlbt_map_rcu_int_int_destroy(&rcu);
+  }
+
+  // a reader which is still reading keeps its snapshot alive and, as it could have picked up any of them, the ones
+  // published after it started as well
+  {
+    tlbt_set_rcu_int rcu = {0};
+    tlbt_set_rcu_int_create(&rcu, 2);
+    tlbt_set_int *first = tlbt_set_rcu_int_prepare(&rcu);
+    tlbt_set_int_insert(first, 1);
+    tlbt_set_rcu_int_publish(&rcu, first);
+    tlbt_assert_msg(rcu.retired == NULL, "the empty snapshot isn't read by anyone");
+
+    tlbt_set_int *seen = tlbt_set_rcu_int_read_begin(&rcu, 1);
+    for (int v = 2; v <= 4; ++v) {
+      tlbt_set_int *next = tlbt_set_rcu_int_prepare_copy(&rcu);
+      tlbt_set_int_insert(next, v);
+      tlbt_set_rcu_int_publish(&rcu, next);
+    }
+    tlbt_assert_fmt(tlbt_set_rcu_int_reclaim(&rcu) == 3, "%zu snapshots are left", tlbt_set_rcu_int_reclaim(&rcu));
+    tlbt_assert_msg(tlbt_set_int_contains(seen, 1) && !tlbt_set_int_contains(seen, 2), "the snapshot has changed");
+    tlbt_assert_msg(tlbt_set_rcu_int_contains(&rcu, 0, 4) && tlbt_set_rcu_int_contains(&rcu, 0, 1),
+                    "the other reader should see the latest snapshot");
+    tlbt_set_rcu_int_read_end(&rcu, 1);
+    tlbt_assert_msg(tlbt_set_rcu_int_reclaim(&rcu) == 0, "the snapshot should be freed after reading");
+
+    // the reader starts again in the current epoch, so the next snapshot it reads can be replaced and freed
+    seen = tlbt_set_rcu_int_read_begin(&rcu, 1);
+    tlbt_set_rcu_int_publish(&rcu, tlbt_set_rcu_int_prepare(&rcu));
+    tlbt_assert_msg(rcu.retired != NULL && tlbt_set_int_contains(seen, 4), "the read snapshot should be retired");
+    tlbt_set_rcu_int_read_end(&rcu, 1);
+    tlbt_set_rcu_int_publish(&rcu, tlbt_set_rcu_int_prepare(&rcu));
+    tlbt_assert_msg(rcu.retired == NULL, "publishing should reclaim");
+    tlbt_assert_msg(!tlbt_set_rcu_int_contains(&rcu, 0, 4), "the latest snapshot is empty");
+    tlbt_set_rcu_int_destroy(&rcu);
+  }
+
+  TLBT_TEST_DONE();
+}
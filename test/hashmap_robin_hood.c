@@ -0,0 +1,163 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+// clusters the keys a lot so that entries get displaced and shifted back
+static inline uint32_t clustering_hash(int x) {
+  return (uint32_t)x / 4;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T string_slice
+#define TLBT_VALUE_T point
+#define TLBT_HASH(x) string_slice_hash(&x)
+#define TLBT_EQUALS(a, b) string_slice_equals(&a, &b)
+#define TLBT_KEY_T_NAME str
+#define TLBT_VALUE_T_NAME point
+#define TLBT_MAX_LOAD_FACTOR 0.5
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define OCCUPIED_BIT (1U << 31)
+#define DELETED_BIT (1U << 30)
+
+// checks that there are no tombstones and that every stored distance matches the home slot of the key
+static void check_invariants(const tlbt_map_int_int *const m) {
+  size_t count = 0;
+  for (size_t i = 0; i < m->capacity; ++i) {
+    const uint32_t index = m->keys[i].index;
+    tlbt_assert_msg(!(index & DELETED_BIT), "there should never be a tombstone");
+    if (!(index & OCCUPIED_BIT)) {
+      tlbt_assert_msg(index == 0, "empty slots should be completely reset");
+      continue;
+    }
+    ++count;
+    const size_t home = clustering_hash(m->keys[i].key) % m->capacity;
+    const size_t dist = (i + m->capacity - home) % m->capacity;
+    tlbt_assert_fmt((index & (DELETED_BIT - 1)) == dist, "stored distance %u should be %zu",
+                    index & (DELETED_BIT - 1), dist);
+    if (dist > 0) {
+      const uint32_t prev = m->keys[(i + m->capacity - 1) % m->capacity].index;
+      tlbt_assert_msg((prev & OCCUPIED_BIT) && (prev & (DELETED_BIT - 1)) + 1 >= dist,
+                      "an entry should never be poorer than its predecessor by more than one");
+    }
+  }
+  tlbt_assert_msg(count == m->count, "count should match the occupied slots");
+}
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // churn test against a plain lookup table
+  {
+    tlbt_map_int_int_key keys[37];
+    int values[37];
+    bool present[64] = {0};
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 37, keys, values);
+
+    uint32_t state = 12345;
+    for (int step = 0; step < 20000; ++step) {
+      state = state * 1103515245u + 12345u;
+      const int key = (int)((state >> 16) % 64);
+      if (present[key]) {
+        int value = 0;
+        tlbt_assert_msg(tlbt_map_int_int_get(&m, key, &value), "should have found the key");
+        tlbt_assert_msg(value == key * 3, "wrong value associated with key");
+        tlbt_assert_msg(tlbt_map_int_int_remove(&m, key), "should have removed the key");
+        present[key] = false;
+      } else {
+        tlbt_assert_msg(!tlbt_map_int_int_contains(&m, key), "shouldn't have found the key");
+        if (tlbt_map_int_int_insert(&m, key, key * 3))
+          present[key] = true;
+      }
+      if (step % 100 == 0)
+        check_invariants(&m);
+    }
+    check_invariants(&m);
+
+    for (int key = 0; key < 64; ++key)
+      tlbt_assert_msg(tlbt_map_int_int_contains(&m, key) == present[key], "map and reference disagree");
+
+    tlbt_map_int_int_clear(&m);
+    tlbt_assert_msg(m.count == 0, "count should be 0 after clear");
+    check_invariants(&m);
+  }
+
+  // wrap around test. all keys have the last slot as home
+  {
+    tlbt_map_int_int_key keys[8];
+    int values[8];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 8, keys, values);
+    for (int i = 28; i < 32; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_insert(&m, i, i), "should have inserted successfully");
+    check_invariants(&m);
+    tlbt_assert_msg(tlbt_map_int_int_remove(&m, 28), "should have removed element");
+    check_invariants(&m);
+    for (int i = 29; i < 32; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_contains(&m, i), "should have contained element");
+  }
+
+  // dynamic test
+  {
+    tlbt_map_str_point m = {0};
+    tlbt_map_str_point_create(&m, 16);
+
+    const char *test_strings[16] = {"hello",   "world", "!",      "these", "are",  "some", "unique", "test",
+                                    "strings", "I",     "should", "not",   "need", "more", "than",   "sixteen"};
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      const bool success = tlbt_map_str_point_insert(&m, key, (point){i, -i});
+      tlbt_assert_msg(success, "should have inserted successfully");
+    }
+    tlbt_assert_msg(m.capacity == 32, "capacity should be 32");
+    tlbt_assert_msg(m.count == 16, "count should be 16");
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      point value = {0};
+      tlbt_assert_msg(tlbt_map_str_point_get(&m, key, &value), "should have found element");
+      tlbt_assert_msg(value.x == i && value.y == -i, "wrong value associated with key");
+    }
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      tlbt_assert_msg(tlbt_map_str_point_remove(&m, key), "should have removed element");
+    }
+    tlbt_assert_msg(m.count == 0, "count should be 0 now");
+    for (size_t i = 0; i < m.capacity; ++i)
+      tlbt_assert_msg(m.keys[i].index == 0, "all slots should be empty again");
+
+    tlbt_map_str_point_destroy(&m);
+    tlbt_assert_msg(allocations == frees, "there should be the same amount of allocations and frees");
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,260 @@
+// mmap and fileno are POSIX and not part of C99
+#define _POSIX_C_SOURCE 200112L
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// same layout but a different hash function
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME rehashed
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) ((uint32_t)(x))
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SERIALIZE
+#define TLBT_MAP_HASH_VERSION 1
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_SERIALIZE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME fixed
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SERIALIZE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+static FILE *save_int(tlbt_map_int_int *m) {
+  FILE *file = tmpfile();
+  tlbt_assert_msg(file, "failed to create temporary file");
+  tlbt_assert_msg(tlbt_map_int_int_save(m, file), "should have saved the map");
+  rewind(file);
+  return file;
+}
+
+static size_t file_size(FILE *file) {
+  fseek(file, 0, SEEK_END);
+  const size_t size = (size_t)ftell(file);
+  rewind(file);
+  return size;
+}
+
+// malloc memory is aligned well enough for every array in the file
+static void *read_all(FILE *file, size_t *out_size) {
+  *out_size = file_size(file);
+  void *data = malloc(*out_size);
+  tlbt_assert_msg(data && fread(data, *out_size, 1, file) == 1, "failed to read the file");
+  rewind(file);
+  return data;
+}
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // load and mmap
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    for (int i = 0; i < 10000; ++i)
+      tlbt_map_int_int_insert(&m, i, i * 2);
+    // tombstones have to survive as well
+    for (int i = 0; i < 10000; i += 3)
+      tlbt_map_int_int_remove(&m, i);
+    FILE *file = save_int(&m);
+    tlbt_assert_msg(file_size(file) % 64 == 0, "the file should be padded to whole arrays");
+
+    tlbt_map_int_int loaded = {0};
+    tlbt_assert_msg(tlbt_map_int_int_load(&loaded, file), "should have loaded the map");
+    tlbt_assert_msg(loaded.capacity == m.capacity && loaded.count == m.count, "capacity and count should match");
+
+    const size_t size = file_size(file);
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+    tlbt_assert_msg(data != MAP_FAILED, "failed to map the file");
+    tlbt_map_int_int viewed = {0};
+    tlbt_assert_msg(tlbt_map_int_int_view(&viewed, data, size), "should have viewed the map");
+    tlbt_assert_msg((char *)viewed.keys == (char *)data + 64, "view should use the mapped memory as it is");
+
+    for (int i = 0; i < 10010; ++i) {
+      const bool expected = i < 10000 && i % 3 != 0;
+      int value = -1;
+      tlbt_assert_fmt(tlbt_map_int_int_get(&loaded, i, &value) == expected, "loaded map is wrong about %d", i);
+      tlbt_assert_msg(!expected || value == i * 2, "wrong value associated with key");
+      value = -1;
+      tlbt_assert_fmt(tlbt_map_int_int_get(&viewed, i, &value) == expected, "viewed map is wrong about %d", i);
+      tlbt_assert_msg(!expected || value == i * 2, "wrong value associated with key");
+    }
+
+    // growing the loaded map works like for any other map
+    for (int i = 10000; i < 20000; ++i)
+      tlbt_map_int_int_insert(&loaded, i, i * 2);
+    tlbt_assert_msg(tlbt_map_int_int_contains(&loaded, 19999) && tlbt_map_int_int_contains(&loaded, 1),
+                    "loaded map should have grown");
+
+    // files which don't belong to the map type
+    tlbt_map_rehashed_int r = {0};
+    tlbt_assert_msg(!tlbt_map_rehashed_int_view(&r, data, size), "different hash version should be rejected");
+    tlbt_map_robin_int rh = {0};
+    tlbt_assert_msg(!tlbt_map_robin_int_view(&rh, data, size), "different layout should be rejected");
+    tlbt_assert_msg(!tlbt_map_int_int_view(&viewed, data, size - 1), "truncated file should be rejected");
+    tlbt_assert_msg(!tlbt_map_int_int_view(&viewed, data, 32), "truncated header should be rejected");
+    tlbt_assert_msg(!tlbt_map_rehashed_int_load(&r, file), "different hash version should be rejected");
+
+    munmap(data, size);
+    fclose(file);
+    tlbt_map_int_int_destroy(&loaded);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // corrupted and truncated files
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    for (int i = 0; i < 100; ++i)
+      tlbt_map_int_int_insert(&m, i, i);
+    FILE *file = save_int(&m);
+    size_t size = 0;
+    unsigned char *data = read_all(file, &size);
+
+    tlbt_map_int_int other = {0};
+    data[0] ^= 1;
+    tlbt_assert_msg(!tlbt_map_int_int_view(&other, data, size), "wrong magic should be rejected");
+    data[0] ^= 1;
+    tlbt_assert_msg(tlbt_map_int_int_view(&other, data, size), "should have viewed the map");
+
+    FILE *truncated = tmpfile();
+    fwrite(data, size - 64, 1, truncated);
+    rewind(truncated);
+    tlbt_assert_msg(!tlbt_map_int_int_load(&other, truncated), "truncated file should be rejected");
+
+    fclose(truncated);
+    free(data);
+    fclose(file);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // robin hood with stored hashes
+  {
+    tlbt_map_robin_int m = {0};
+    tlbt_map_robin_int_create(&m, 10);
+    for (int i = 0; i < 3000; ++i)
+      tlbt_map_robin_int_insert(&m, i * 7, i);
+    for (int i = 0; i < 3000; i += 2)
+      tlbt_map_robin_int_remove(&m, i * 7);
+    FILE *file = tmpfile();
+    tlbt_assert_msg(tlbt_map_robin_int_save(&m, file), "should have saved the map");
+    rewind(file);
+    tlbt_map_robin_int loaded = {0};
+    tlbt_assert_msg(tlbt_map_robin_int_load(&loaded, file), "should have loaded the map");
+    for (int i = 0; i < 3000 * 7; ++i) {
+      const bool expected = i % 7 == 0 && (i / 7) % 2 == 1;
+      int value = -1;
+      tlbt_assert_fmt(tlbt_map_robin_int_get(&loaded, i, &value) == expected, "loaded map is wrong about %d", i);
+      tlbt_assert_msg(!expected || value == i / 7, "wrong value associated with key");
+    }
+    fclose(file);
+    tlbt_map_robin_int_destroy(&loaded);
+    tlbt_map_robin_int_destroy(&m);
+  }
+
+  // saving in the middle of a migration finishes it first
+  {
+    tlbt_set_simd s = {0};
+    tlbt_set_simd_create(&s, 16);
+    int inserted = 0;
+    while (!s.old || inserted < 1000)
+      tlbt_set_simd_insert(&s, inserted++);
+    FILE *file = tmpfile();
+    tlbt_assert_msg(tlbt_set_simd_save(&s, file), "should have saved the set");
+    tlbt_assert_msg(s.old == NULL, "migration should be done");
+    size_t size = 0;
+    void *data = read_all(file, &size);
+    tlbt_set_simd loaded = {0};
+    tlbt_set_simd viewed = {0};
+    tlbt_assert_msg(tlbt_set_simd_load(&loaded, file), "should have loaded the set");
+    tlbt_assert_msg(tlbt_set_simd_view(&viewed, data, size), "should have viewed the set");
+    for (int i = 0; i < inserted + 100; ++i) {
+      tlbt_assert_fmt(tlbt_set_simd_contains(&loaded, i) == (i < inserted), "loaded set is wrong about %d", i);
+      tlbt_assert_fmt(tlbt_set_simd_contains(&viewed, i) == (i < inserted), "viewed set is wrong about %d", i);
+    }
+    free(data);
+    fclose(file);
+    tlbt_set_simd_destroy(&loaded);
+    tlbt_set_simd_destroy(&s);
+  }
+
+  // fixed memory maps keep working on top of writable memory
+  {
+    tlbt_map_fixed_int_key keys[64];
+    int values[64];
+    tlbt_map_fixed_int m = {0};
+    tlbt_map_fixed_int_init(&m, 64, keys, values);
+    for (int i = 0; i < 20; ++i)
+      tlbt_map_fixed_int_insert(&m, i, -i);
+    FILE *file = tmpfile();
+    tlbt_assert_msg(tlbt_map_fixed_int_save(&m, file), "should have saved the map");
+    rewind(file);
+    size_t size = 0;
+    void *data = read_all(file, &size);
+
+    tlbt_map_fixed_int viewed = {0};
+    tlbt_assert_msg(tlbt_map_fixed_int_view(&viewed, data, size), "should have viewed the map");
+    int i = 20;
+    while (tlbt_map_fixed_int_insert(&viewed, i, -i))
+      ++i;
+    tlbt_assert_fmt(i == 44, "should have stopped at the max load factor, stopped at %d", i);
+    tlbt_assert_msg(tlbt_map_fixed_int_remove(&viewed, 3), "should have removed element");
+    for (int j = 0; j < 50; ++j) {
+      int value = 1;
+      const bool expected = j < 44 && j != 3;
+      tlbt_assert_fmt(tlbt_map_fixed_int_get(&viewed, j, &value) == expected, "viewed map is wrong about %d", j);
+      tlbt_assert_msg(!expected || value == -j, "wrong value associated with key");
+    }
+    free(data);
+    fclose(file);
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,168 @@
+#include <stddef.h>
+#include <errno.h>
+#include <pthread.h>
+#include "common.h"
+#include "../src/assert.h"
+
+// lets the map create this many threads before creating threads fails. unlimited while negative
+static int creatable_threads = -1;
+
+static int create_thread(pthread_t *thread, const pthread_attr_t *attr, void *(*start)(void *), void *arg) {
+  if (creatable_threads == 0)
+    return EAGAIN;
+  if (creatable_threads > 0)
+    --creatable_threads;
+  return pthread_create(thread, attr, start, arg);
+}
+
+#define pthread_create create_thread
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+// counts its calls if it gets a counter. the threads in the first test run it at the same time, so they get none
+static void add_count(int *into, int value, void *userdata) {
+  *into += value;
+  if (userdata)
+    ++*(int *)userdata;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_SHARDED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// the merged shards keep migrating while entries get combined into them
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME migrating
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_MAP_LAYOUT_INTERLEAVED
+#define TLBT_MAP_SHARDED
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// every thread counts the words of its part of the input. word w occurs w % 7 + 1 times in every part
+#define WORDS 5000
+#define THREADS 4
+
+typedef struct {
+  tlbt_map_sharded_int_int *sharded;
+  size_t thread;
+} worker;
+
+static void *count_words(void *arg) {
+  const worker *w = (const worker *)arg;
+  for (int round = 0; round < 7; ++round) {
+    for (int word = 0; word < WORDS; ++word) {
+      if (word % 7 >= round)
+        tlbt_map_sharded_int_int_add(w->sharded, w->thread, word, 1);
+    }
+  }
+  return NULL;
+}
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // more partitions than threads, as many and fewer
+  {
+    const size_t partitions[] = {16, THREADS, 3, 1};
+    for (size_t k = 0; k < sizeof(partitions) / sizeof(partitions[0]); ++k) {
+      tlbt_map_sharded_int_int s = {0};
+      tlbt_map_sharded_int_int_create(&s, THREADS, partitions[k], add_count, NULL);
+      pthread_t handles[THREADS];
+      worker workers[THREADS];
+      for (size_t t = 0; t < THREADS; ++t) {
+        workers[t].sharded = &s;
+        workers[t].thread = t;
+        tlbt_assert_msg(pthread_create(&handles[t], NULL, count_words, &workers[t]) == 0, "failed to create thread");
+      }
+      for (size_t t = 0; t < THREADS; ++t)
+        pthread_join(handles[t], NULL);
+      tlbt_map_sharded_int_int_merge(&s);
+
+      size_t total = 0;
+      for (size_t p = 0; p < partitions[k]; ++p) {
+        tlbt_map_int_int *m = tlbt_map_sharded_int_int_partition(&s, p);
+        total += m->count;
+        // the keys of a partition have to spread over all of its slots
+        tlbt_map_stats_int_int stats;
+        tlbt_map_int_int_stats(m, &stats);
+        tlbt_assert_fmt(stats.mean_probe_length < 3.0f, "mean probe length of partition %zu is %f", p,
+                        (double)stats.mean_probe_length);
+      }
+      tlbt_assert_fmt(total == WORDS, "%zu words in %zu partitions", total, partitions[k]);
+      for (int word = 0; word < WORDS; ++word) {
+        int count = 0;
+        tlbt_assert_fmt(tlbt_map_sharded_int_int_get(&s, word, &count) && count == THREADS * (word % 7 + 1),
+                        "word %d was counted %d times", word, count);
+      }
+      tlbt_assert_msg(!tlbt_map_sharded_int_int_get(&s, WORDS, &(int){0}), "should be missing");
+
+      // the other shards are empty after merging
+      for (size_t t = 1; t < THREADS; ++t) {
+        for (size_t p = 0; p < partitions[k]; ++p)
+          tlbt_assert_msg(s.shards[t * s.stride + p].count == 0, "shards should be empty");
+      }
+      tlbt_map_sharded_int_int_destroy(&s);
+    }
+  }
+
+  // adding after merging continues on top of the result
+  {
+    int combined = 0;
+    tlbt_map_sharded_migrating_int s = {0};
+    tlbt_map_sharded_migrating_int_create(&s, 3, 5, add_count, &combined);
+    for (int i = 0; i < 30000; ++i)
+      tlbt_map_sharded_migrating_int_add(&s, (size_t)i % 3, i % 10000, i);
+    tlbt_map_sharded_migrating_int_merge(&s);
+    tlbt_assert_fmt(combined == 20000, "combine was called %d times", combined);
+    for (int i = 0; i < 10000; ++i)
+      tlbt_map_sharded_migrating_int_add(&s, 2, i, 1);
+    tlbt_map_sharded_migrating_int_merge(&s);
+    for (int i = 0; i < 10000; ++i) {
+      int value = 0;
+      tlbt_assert_fmt(tlbt_map_sharded_migrating_int_get(&s, i, &value) && value == 3 * i + 30000 + 1,
+                      "%d has the value %d", i, value);
+    }
+    size_t total = 0;
+    for (size_t p = 0; p < 5; ++p)
+      total += tlbt_map_sharded_migrating_int_partition(&s, p)->count;
+    tlbt_assert_fmt(total == 10000, "%zu entries", total);
+    tlbt_map_sharded_migrating_int_destroy(&s);
+  }
+
+  // the calling thread merges the partitions of the threads which couldn't be created
+  {
+    const int creatable[] = {0, 1};
+    for (size_t k = 0; k < sizeof(creatable) / sizeof(creatable[0]); ++k) {
+      tlbt_map_sharded_int_int s = {0};
+      tlbt_map_sharded_int_int_create(&s, 3, 6, add_count, NULL);
+      for (int i = 0; i < 9000; ++i)
+        tlbt_map_sharded_int_int_add(&s, (size_t)i / 3000, i % 3000, 1);
+      creatable_threads = creatable[k];
+      tlbt_map_sharded_int_int_merge(&s);
+      creatable_threads = -1;
+      for (int i = 0; i < 3000; ++i) {
+        int value = 0;
+        tlbt_assert_fmt(tlbt_map_sharded_int_int_get(&s, i, &value) && value == 3, "%d has the value %d", i, value);
+      }
+      tlbt_map_sharded_int_int_destroy(&s);
+    }
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,229 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+// clusters the keys so that entries end up far away from their home slot and rehashing has to move them around
+static inline uint32_t clustering_hash(int x) {
+  return (uint32_t)x / 4 * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAX_LOAD_FACTOR 0.9
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAX_LOAD_FACTOR 0.9
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_STORE_HASH
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME auto
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_AUTO_SHRINK
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// capacities which aren't a power of 2. the counters tell how often removing resized or rehashed the map
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME auto_any
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_AUTO_SHRINK
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME manual
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) clustering_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define DELETED_BIT (1U << 30)
+#define CTRL_DELETED 0xFE
+
+// fills a fixed memory map with tombstones, rehashes it and checks that nothing got lost on the way
+#define REHASH_TEST(MAP, CAPACITY, IS_TOMBSTONE, ...)                                                                  \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int_key keys[CAPACITY];                                                                           \
+    int values[CAPACITY];                                                                                              \
+    bool present[256] = {0};                                                                                           \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_init(&m, CAPACITY, keys, values __VA_ARGS__);                                                 \
+    uint32_t state = 4242;                                                                                             \
+    for (int step = 0; step < 5000; ++step) {                                                                          \
+      state = state * 1103515245u + 12345u;                                                                            \
+      const int key = (int)((state >> 16) % 256);                                                                      \
+      if (present[key]) {                                                                                              \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, key), "should have removed the key");                          \
+        present[key] = false;                                                                                          \
+      } else if (tlbt_map_##MAP##_int_insert(&m, key, key * 3)) {                                                      \
+        present[key] = true;                                                                                           \
+      }                                                                                                                \
+      if (step % 500 != 499)                                                                                           \
+        continue;                                                                                                      \
+                                                                                                                       \
+      size_t tombstones = 0;                                                                                           \
+      for (size_t i = 0; i < CAPACITY; ++i)                                                                            \
+        tombstones += IS_TOMBSTONE(m, i);                                                                              \
+      tlbt_assert_msg(tombstones > 0, "the churn should have left tombstones behind");                                 \
+      const size_t count = m.count;                                                                                    \
+      tlbt_map_##MAP##_int_rehash(&m);                                                                                 \
+      for (size_t i = 0; i < CAPACITY; ++i)                                                                            \
+        tlbt_assert_msg(!IS_TOMBSTONE(m, i), "rehashing should have purged all tombstones");                           \
+      tlbt_assert_msg(m.count == count, "rehashing shouldn't change the count");                                       \
+      for (int k = 0; k < 256; ++k) {                                                                                  \
+        int value = 0;                                                                                                 \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_get(&m, k, &value) == present[k], "map and reference disagree");          \
+        tlbt_assert_msg(!present[k] || value == k * 3, "wrong value associated with key");                             \
+      }                                                                                                                \
+    }                                                                                                                  \
+  } while (0)
+
+#define DEFAULT_TOMBSTONE(m, i) ((m).keys[(i)].index == DELETED_BIT)
+#define SIMD_TOMBSTONE(m, i) ((m).ctrl[(i)] == CTRL_DELETED)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // capacities smaller than a group, not a multiple of the group and bigger than the key range
+  REHASH_TEST(int, 37, DEFAULT_TOMBSTONE);
+  REHASH_TEST(int, 300, DEFAULT_TOMBSTONE);
+  {
+    unsigned char ctrl[7 + 16];
+    REHASH_TEST(simd, 7, SIMD_TOMBSTONE, , ctrl);
+  }
+  {
+    unsigned char ctrl[37 + 16];
+    REHASH_TEST(simd, 37, SIMD_TOMBSTONE, , ctrl);
+  }
+  {
+    unsigned char ctrl[300 + 16];
+    REHASH_TEST(simd, 300, SIMD_TOMBSTONE, , ctrl);
+  }
+
+  // automatic shrinking test
+  {
+    tlbt_map_auto_int m = {0};
+    tlbt_map_auto_int_create(&m, 16);
+    for (int i = 0; i < 10000; ++i)
+      tlbt_assert_msg(tlbt_map_auto_int_insert(&m, i, i), "should have inserted successfully");
+    const size_t peak = m.capacity;
+
+    size_t previous = m.capacity;
+    for (int i = 0; i < 9990; ++i) {
+      tlbt_assert_msg(tlbt_map_auto_int_remove(&m, i), "should have removed element");
+      tlbt_assert_msg(m.capacity <= previous, "removing should never grow the map");
+      previous = m.capacity;
+    }
+    // 10 entries leave a 16 slot table more than half of the max load factor full
+    tlbt_assert_fmt(m.capacity == 32, "capacity should be 32 again (%zu, peak %zu)", m.capacity, peak);
+    for (int i = 0; i < 10000; ++i)
+      tlbt_assert_msg(tlbt_map_auto_int_contains(&m, i) == (i >= 9990), "only the last keys should remain");
+
+    // hysteresis: bouncing around the shrink threshold must not resize every time
+    tlbt_map_auto_int_clear(&m);
+    for (int i = 0; i < 2000; ++i)
+      tlbt_map_auto_int_insert(&m, i, i);
+    for (int i = 0; i < 1800; ++i)
+      tlbt_map_auto_int_remove(&m, i);
+    const int allocations_before = allocations;
+    for (int round = 0; round < 100; ++round) {
+      tlbt_map_auto_int_remove(&m, 1999 - round % 10);
+      tlbt_map_auto_int_insert(&m, 1999 - round % 10, 0);
+    }
+    tlbt_assert_fmt(allocations - allocations_before <= 3, "should have resized at most once (%d allocations)",
+                    allocations - allocations_before);
+
+    tlbt_map_auto_int_destroy(&m);
+    tlbt_assert_msg(allocations == frees, "there should be the same amount of allocations and frees");
+  }
+
+  // automatic shrinking without TLBT_BASE2_CAPACITY. every remove below the min load factor must shrink instead of
+  // rehashing the whole table in place
+  {
+    const size_t capacities[] = {1000, 1024, 17};
+    for (size_t c = 0; c < sizeof(capacities) / sizeof(capacities[0]); ++c) {
+      tlbt_map_auto_any_int m = {0};
+      tlbt_map_auto_any_int_create(&m, capacities[c]);
+      for (int i = 0; i < 20000; ++i)
+        tlbt_map_auto_any_int_insert(&m, i, i);
+      const uint64_t resizes = m.counters.resizes;
+      for (int i = 0; i < 19990; ++i)
+        tlbt_assert_msg(tlbt_map_auto_any_int_remove(&m, i), "should have removed element");
+      tlbt_assert_fmt(m.counters.resizes - resizes <= 20, "removing from capacity %zu resized %llu times",
+                      capacities[c], (unsigned long long)(m.counters.resizes - resizes));
+      tlbt_assert_fmt(m.capacity <= 64, "capacity should have shrunk (%zu)", (size_t)m.capacity);
+      for (int i = 0; i < 20000; ++i)
+        tlbt_assert_msg(tlbt_map_auto_any_int_contains(&m, i) == (i >= 19990), "only the last keys should remain");
+      tlbt_map_auto_any_int_destroy(&m);
+    }
+  }
+
+  // manual shrinking test
+  {
+    tlbt_map_manual_int m = {0};
+    tlbt_map_manual_int_create(&m, 16);
+    for (int i = 0; i < 1000; ++i)
+      tlbt_map_manual_int_insert(&m, i, i);
+    tlbt_assert_msg(m.capacity == 2048, "capacity should be 2048");
+
+    // only a few removals so it can't shrink but rehashing still gets rid of the tombstones
+    for (int i = 0; i < 100; ++i)
+      tlbt_map_manual_int_remove(&m, i);
+    tlbt_map_manual_int_shrink_to_fit(&m);
+    tlbt_assert_msg(m.capacity == 2048, "capacity shouldn't have changed");
+    for (size_t i = 0; i < m.capacity; ++i)
+      tlbt_assert_msg(!SIMD_TOMBSTONE(m, i), "shrinking should have purged all tombstones");
+
+    for (int i = 100; i < 900; ++i)
+      tlbt_map_manual_int_remove(&m, i);
+    tlbt_map_manual_int_shrink_to_fit(&m);
+    tlbt_assert_msg(m.capacity == 512, "capacity should be 512");
+    for (int i = 0; i < 1000; ++i)
+      tlbt_assert_msg(tlbt_map_manual_int_contains(&m, i) == (i >= 900), "only the last keys should remain");
+
+    tlbt_map_manual_int_destroy(&m);
+    tlbt_assert_msg(allocations == frees, "there should be the same amount of allocations and frees");
+  }
+
+  TLBT_TEST_DONE();
+}
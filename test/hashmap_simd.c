@@ -0,0 +1,171 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int allocations = 0;
+static int frees = 0;
+
+static void *custom_alloc(size_t size) {
+  ++allocations;
+  return malloc(size);
+}
+
+static void custom_free(void *ptr) {
+  ++frees;
+  free(ptr);
+}
+
+// only 8 different h2 values and mostly the same home slot so the control bytes match a lot
+// and TLBT_EQUALS has to sort it out
+static inline uint32_t colliding_hash(int x) {
+  return ((uint32_t)x * 2654435761u) | 0x1FFFFFFFu;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) colliding_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME swar
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) colliding_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_NO_SSE2
+// the SWAR fallback works on the configured 64 bit type
+#define TLBT_UINT64_T unsigned long long
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T string_slice
+#define TLBT_VALUE_T point
+#define TLBT_HASH(x) string_slice_hash(&x)
+#define TLBT_EQUALS(a, b) string_slice_equals(&a, &b)
+#define TLBT_KEY_T_NAME str
+#define TLBT_VALUE_T_NAME point
+#define TLBT_MAX_LOAD_FACTOR 0.5
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_MALLOC custom_alloc
+#define TLBT_FREE custom_free
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// inserts, removes and looks up pseudo random keys and compares the results with a plain lookup table
+#define CHURN_TEST(MAP, CAPACITY)                                                                                      \
+  do {                                                                                                                 \
+    tlbt_map_##MAP##_int_key keys[CAPACITY];                                                                           \
+    int values[CAPACITY];                                                                                              \
+    unsigned char ctrl[CAPACITY + 16];                                                                                 \
+    bool present[64] = {0};                                                                                            \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    tlbt_map_##MAP##_int_init(&m, CAPACITY, keys, values, ctrl);                                                       \
+    uint32_t state = 12345;                                                                                            \
+    for (int step = 0; step < 20000; ++step) {                                                                         \
+      state = state * 1103515245u + 12345u;                                                                            \
+      const int key = (int)((state >> 16) % 64);                                                                       \
+      if (present[key]) {                                                                                              \
+        int value = 0;                                                                                                 \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_get(&m, key, &value), "should have found the key");                       \
+        tlbt_assert_msg(value == key * 3, "wrong value associated with key");                                          \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, key), "should have removed the key");                          \
+        present[key] = false;                                                                                          \
+      } else {                                                                                                         \
+        tlbt_assert_msg(!tlbt_map_##MAP##_int_contains(&m, key), "shouldn't have found the key");                      \
+        if (tlbt_map_##MAP##_int_insert(&m, key, key * 3))                                                             \
+          present[key] = true;                                                                                         \
+      }                                                                                                                \
+    }                                                                                                                  \
+    size_t count = 0;                                                                                                  \
+    for (int key = 0; key < 64; ++key) {                                                                               \
+      count += present[key];                                                                                           \
+      tlbt_assert_msg(tlbt_map_##MAP##_int_contains(&m, key) == present[key], "map and reference disagree");           \
+    }                                                                                                                  \
+    tlbt_assert_msg(m.count == count, "count should match the reference");                                             \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // capacities smaller than a group, not a multiple of the group and bigger than the key range
+  CHURN_TEST(int, 7);
+  CHURN_TEST(int, 37);
+  CHURN_TEST(int, 128);
+  CHURN_TEST(swar, 7);
+  CHURN_TEST(swar, 37);
+  CHURN_TEST(swar, 128);
+
+  // iterator test
+  {
+    tlbt_map_int_int_key keys[32];
+    int values[32];
+    unsigned char ctrl[32 + 16];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 32, keys, values, ctrl);
+    for (int i = 0; i < 16; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_insert(&m, i, -i), "should have inserted successfully");
+    for (int i = 0; i < 16; i += 2)
+      tlbt_assert_msg(tlbt_map_int_int_remove(&m, i), "should have removed element");
+
+    int key = 0;
+    int value = 0;
+    size_t iterations = 0;
+    tlbt_map_iterator_int_int iter = {0};
+    tlbt_map_iterator_int_int_init(&iter, &m);
+    while (tlbt_map_iterator_int_int_iterate(&iter, &key, &value)) {
+      tlbt_assert_msg(key % 2 == 1 && value == -key, "iterated kvp should be one of the remaining ones");
+      ++iterations;
+    }
+    tlbt_assert_msg(iterations == 8, "iteration count different from element count");
+
+    tlbt_map_int_int_clear(&m);
+    tlbt_assert_msg(m.count == 0, "count should be 0 after clear");
+    tlbt_map_iterator_int_int_reset(&iter);
+    tlbt_assert_msg(!tlbt_map_iterator_int_int_iterate(&iter, &key, &value), "there should be nothing to iterate");
+  }
+
+  // dynamic test
+  {
+    tlbt_map_str_point m = {0};
+    tlbt_map_str_point_create(&m, 16);
+
+    const char *test_strings[16] = {"hello",   "world", "!",      "these", "are",  "some", "unique", "test",
+                                    "strings", "I",     "should", "not",   "need", "more", "than",   "sixteen"};
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      const bool success = tlbt_map_str_point_insert(&m, key, (point){i, -i});
+      tlbt_assert_msg(success, "should have inserted successfully");
+    }
+    tlbt_assert_msg(m.capacity == 32, "capacity should be 32");
+    tlbt_assert_msg(m.count == 16, "count should be 16");
+
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      point value = {0};
+      tlbt_assert_msg(tlbt_map_str_point_get(&m, key, &value), "should have found element");
+      tlbt_assert_msg(value.x == i && value.y == -i, "wrong value associated with key");
+    }
+
+    tlbt_map_str_point m2 = {0};
+    tlbt_map_str_point_create(&m2, 32);
+    tlbt_assert_msg(tlbt_map_str_point_copy(&m2, &m), "should have succeeded copying");
+    for (int i = 0; i < 16; ++i) {
+      string_slice key = {.data = test_strings[i], .len = strlen(test_strings[i])};
+      tlbt_assert_msg(tlbt_map_str_point_remove(&m, key), "should have removed element");
+      tlbt_assert_msg(tlbt_map_str_point_contains(&m2, key), "copy should still contain the element");
+    }
+    tlbt_assert_msg(m.count == 0, "count should be 0 now");
+
+    tlbt_map_str_point_destroy(&m);
+    tlbt_map_str_point_destroy(&m2);
+    tlbt_assert_msg(allocations == frees, "there should be the same amount of allocations and frees");
+  }
+
+  TLBT_TEST_DONE();
+}
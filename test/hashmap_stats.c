@@ -0,0 +1,219 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+// keys land in the slot of their own value which makes the probe sequences easy to predict
+static inline uint32_t identity_hash(int x) {
+  return (uint32_t)x;
+}
+
+// only 8 different hashes so there are long probe sequences
+static inline uint32_t bad_hash(int x) {
+  return ((uint32_t)x & 7) * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) identity_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_STATS_BUCKETS 4
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) bad_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) identity_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define BUCKETS(stats) (sizeof((stats).histogram) / sizeof((stats).histogram[0]))
+
+// the histogram has to add up to the entries and agree with the mean and the max. the last bucket also holds longer
+// probe lengths, so the mean can only be checked if it's empty
+#define CHECK_STATS(MAP, m)                                                                                            \
+  do {                                                                                                                 \
+    tlbt_map_stats_##MAP##_int stats;                                                                                  \
+    tlbt_map_##MAP##_int_stats((m), &stats);                                                                           \
+    const size_t last = BUCKETS(stats) - 1;                                                                            \
+    size_t entries = 0, total = 0, longest = 0;                                                                        \
+    for (size_t b = 0; b <= last; ++b) {                                                                               \
+      entries += stats.histogram[b];                                                                                   \
+      total += stats.histogram[b] * (b + 1);                                                                           \
+      longest = stats.histogram[b] ? b + 1 : longest;                                                                  \
+    }                                                                                                                  \
+    tlbt_assert_fmt(entries == (m)->count, #MAP " histogram holds %d of %d entries", (int)entries, (int)(m)->count);   \
+    tlbt_assert_msg(longest == stats.max_probe_length || (longest == last + 1 && stats.max_probe_length > longest),    \
+                    #MAP " max probe length doesn't match the histogram");                                             \
+    tlbt_assert_msg(stats.histogram[last] != 0 || (stats.mean_probe_length * entries >= total * 0.999f &&              \
+                                                   stats.mean_probe_length * entries <= total * 1.001f),               \
+                    #MAP " mean probe length doesn't match the histogram");                                            \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  // probe lengths, tombstones and the last histogram bucket
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    tlbt_map_stats_int_int stats;
+    tlbt_map_int_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.count == 0 && stats.capacity == 16 && stats.max_probe_length == 0 &&
+                        stats.mean_probe_length == 0.0f,
+                    "an empty map has no probe lengths");
+
+    // slot 0, 1 and 2. key 1 is pushed out of its home slot into slot 3
+    tlbt_map_int_int_insert(&m, 0, 0);
+    tlbt_map_int_int_insert(&m, 16, 0);
+    tlbt_map_int_int_insert(&m, 32, 0);
+    tlbt_map_int_int_insert(&m, 1, 0);
+    tlbt_map_int_int_remove(&m, 16);
+    tlbt_map_int_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.count == 3 && stats.tombstones == 1, "should have counted the removed key as a tombstone");
+    tlbt_assert_msg(stats.histogram[0] == 1 && stats.histogram[1] == 0 && stats.histogram[2] == 2,
+                    "the keys should have probe lengths 1, 3 and 3");
+    tlbt_assert_msg(stats.max_probe_length == 3 && stats.mean_probe_length > 2.33f &&
+                        stats.mean_probe_length < 2.34f,
+                    "wrong max or mean probe length");
+    tlbt_assert_msg(stats.load_factor > 0.187f && stats.load_factor < 0.188f, "wrong load factor");
+
+    // 48 takes the tombstone in slot 1. probe lengths 5 and 6 are in the last bucket
+    tlbt_map_int_int_insert(&m, 48, 0);
+    tlbt_map_int_int_insert(&m, 64, 0);
+    tlbt_map_int_int_insert(&m, 80, 0);
+    tlbt_map_int_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.tombstones == 0 && stats.histogram[1] == 1, "the tombstone should have been reused");
+    tlbt_assert_msg(stats.histogram[3] == 2 && stats.max_probe_length == 6, "longer probes belong in the last bucket");
+    CHECK_STATS(int, &m);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // counting probes and comparisons
+  {
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_create(&m, 16);
+    tlbt_assert_msg(m.counters.probes == 0 && m.counters.equals == 0 && m.counters.resizes == 0 &&
+                        m.counters.bytes_rehashed == 0,
+                    "a new map shouldn't have counted anything");
+    tlbt_map_int_int_insert(&m, 0, 0);
+    tlbt_map_int_int_insert(&m, 16, 0);
+    tlbt_map_int_int_insert(&m, 32, 0);
+    tlbt_assert_msg(m.counters.probes == 1 + 2 + 3 && m.counters.equals == 0, "inserts only look for a free slot");
+
+    m.counters.probes = 0;
+    tlbt_assert_msg(tlbt_map_int_int_contains(&m, 32), "should contain 32");
+    tlbt_assert_msg(m.counters.probes == 3 && m.counters.equals == 3, "should have compared 0, 16 and 32");
+    tlbt_assert_msg(!tlbt_map_int_int_contains(&m, 48), "shouldn't contain 48");
+    tlbt_assert_msg(m.counters.probes == 7 && m.counters.equals == 6, "a miss stops at the first empty slot");
+
+    // growing 16 -> 32 -> 64 moves 11 and then 22 entries
+    for (int i = 1; i < 23; ++i)
+      tlbt_map_int_int_insert(&m, i * 100, i);
+    tlbt_assert_fmt(m.counters.resizes == 2, "should have grown twice, counted %d", (int)m.counters.resizes);
+    tlbt_assert_msg(m.counters.bytes_rehashed == (11 + 22) * (sizeof(tlbt_map_int_int_key) + sizeof(int)),
+                    "should have counted the moved keys and values");
+    tlbt_map_int_int_rehash(&m);
+    tlbt_assert_msg(m.counters.resizes == 3, "rehashing in place should count as a resize");
+    CHECK_STATS(int, &m);
+    tlbt_map_int_int_destroy(&m);
+  }
+
+  // robin hood with an old table during incremental resizing
+  {
+    tlbt_map_robin_int m = {0};
+    tlbt_map_robin_int_create(&m, 64);
+    for (int i = 0; i < 45; ++i)
+      tlbt_map_robin_int_insert(&m, i, i);
+    tlbt_map_robin_int_remove(&m, 3);
+    tlbt_assert_msg(m.old != NULL, "a migration should be in progress");
+    CHECK_STATS(robin, &m);
+    tlbt_map_stats_robin_int stats;
+    tlbt_map_robin_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.tombstones > 0, "migrated entries of the old table should be tombstones");
+
+    // the stored distance is the probe length minus one
+    size_t histogram[16] = {0};
+    for (const tlbt_map_robin_int *t = &m; t; t = t->old) {
+      for (size_t i = 0; i < t->capacity; ++i) {
+        if ((t->keys[i].index >> 30) == 2) {
+          const size_t length = (t->keys[i].index & ((1u << 30) - 1)) + 1;
+          ++histogram[length < 16 ? length - 1 : 15];
+        }
+      }
+    }
+    tlbt_assert_msg(memcmp(histogram, stats.histogram, sizeof(histogram)) == 0,
+                    "histogram should match the robin hood distances");
+
+    const uint64_t probes = m.counters.probes;
+    for (int i = 0; i < 45; ++i)
+      tlbt_map_robin_int_contains(&m, i);
+    tlbt_assert_msg(m.old == NULL, "the migration should be done");
+    tlbt_assert_msg(m.counters.probes > probes && m.counters.equals >= 44,
+                    "probes of the old table should have been added after the migration");
+    tlbt_assert_msg(m.counters.resizes == 1, "starting a migration counts as a resize");
+    tlbt_map_robin_int_destroy(&m);
+  }
+
+  // control bytes
+  {
+    tlbt_map_simd_int m = {0};
+    tlbt_map_simd_int_create(&m, 256);
+    for (int i = 0; i < 150; ++i)
+      tlbt_map_simd_int_insert(&m, i, i);
+    for (int i = 0; i < 150; i += 3)
+      tlbt_map_simd_int_remove(&m, i);
+    CHECK_STATS(simd, &m);
+    tlbt_map_stats_simd_int stats;
+    tlbt_map_simd_int_stats(&m, &stats);
+    tlbt_assert_fmt(stats.tombstones == 50, "should have counted 50 tombstones, got %d", (int)stats.tombstones);
+    tlbt_assert_msg(stats.max_probe_length > 16, "keys with the same hash should have pushed each other far away");
+    tlbt_map_simd_int_rehash(&m);
+    tlbt_map_simd_int_stats(&m, &stats);
+    tlbt_assert_msg(stats.tombstones == 0, "rehashing should have purged the tombstones");
+    tlbt_assert_msg(m.counters.resizes == 1 && m.counters.probes > 0 && m.counters.equals > 0, "should have counted");
+    tlbt_map_simd_int_destroy(&m);
+  }
+
+  // set
+  {
+    tlbt_set_int_key keys[32];
+    tlbt_set_int s = {0};
+    tlbt_set_int_init(&s, 32, keys);
+    for (int i = 0; i < 20; ++i)
+      tlbt_set_int_insert(&s, i * 32);
+    tlbt_set_stats_int stats;
+    tlbt_set_int_stats(&s, &stats);
+    tlbt_assert_msg(stats.count == 20 && stats.max_probe_length == 20 && stats.mean_probe_length == 10.5f,
+                    "every key should have been pushed one slot further than the previous one");
+    tlbt_assert_msg(BUCKETS(stats) == 16 && stats.histogram[15] == 5, "default histogram has 16 buckets");
+  }
+
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,104 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int hash_calls = 0;
+static int equals_calls = 0;
+
+// every key has the same home slot for capacities up to 256 but a different full hash
+static inline uint32_t counting_hash(int x) {
+  ++hash_calls;
+  return (uint32_t)x << 8;
+}
+
+static inline bool counting_equals(int a, int b) {
+  ++equals_calls;
+  return a == b;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) counting_equals(a, b)
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define STORE_HASH_TEST(NAME)                                                                                          \
+  do {                                                                                                                 \
+    tlbt_map_##NAME##_int m = {0};                                                                                     \
+    tlbt_map_##NAME##_int_create(&m, 16);                                                                              \
+    hash_calls = 0;                                                                                                    \
+    equals_calls = 0;                                                                                                  \
+    for (int i = 0; i < 64; ++i)                                                                                       \
+      tlbt_map_##NAME##_int_insert(&m, i, i * 2);                                                                      \
+    tlbt_assert_msg(m.capacity == 128, "capacity should be 128");                                                      \
+    tlbt_assert_fmt(hash_calls == 64, "resizing shouldn't hash again (%d hash calls)", hash_calls);                    \
+    tlbt_assert_fmt(equals_calls == 0, "inserting shouldn't compare keys (%d equals calls)", equals_calls);            \
+                                                                                                                       \
+    /* all keys share the same home slot so without stored hashes a lookup compares many of them */                    \
+    for (int i = 0; i < 64; ++i) {                                                                                     \
+      int value = 0;                                                                                                   \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_get(&m, i, &value), "should have found element");                          \
+      tlbt_assert_msg(value == i * 2, "wrong value associated with key");                                              \
+    }                                                                                                                  \
+    tlbt_assert_fmt(equals_calls == 64, "only matching hashes should be compared (%d equals calls)", equals_calls);    \
+                                                                                                                       \
+    equals_calls = 0;                                                                                                  \
+    for (int i = 64; i < 128; ++i)                                                                                     \
+      tlbt_assert_msg(!tlbt_map_##NAME##_int_contains(&m, i), "shouldn't have found element");                         \
+    tlbt_assert_fmt(equals_calls == 0, "misses shouldn't compare keys (%d equals calls)", equals_calls);               \
+                                                                                                                       \
+    for (int i = 0; i < 64; i += 2)                                                                                    \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_remove(&m, i), "should have removed element");                             \
+    for (int i = 0; i < 64; ++i)                                                                                       \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_contains(&m, i) == (i % 2 == 1), "only odd keys should remain");           \
+    for (int i = 0; i < 64; i += 2)                                                                                    \
+      tlbt_assert_msg(!tlbt_map_##NAME##_int_remove(&m, i), "removing twice shouldn't succeed");                       \
+    tlbt_assert_msg(m.count == 32, "count should be 32");                                                              \
+                                                                                                                       \
+    tlbt_map_##NAME##_int m2 = {0};                                                                                    \
+    tlbt_map_##NAME##_int_create(&m2, 64);                                                                             \
+    hash_calls = 0;                                                                                                    \
+    tlbt_assert_msg(tlbt_map_##NAME##_int_copy(&m2, &m), "should have succeeded copying");                             \
+    tlbt_assert_fmt(hash_calls == 0, "copying shouldn't hash again (%d hash calls)", hash_calls);                      \
+    for (int i = 1; i < 64; i += 2)                                                                                    \
+      tlbt_assert_msg(tlbt_map_##NAME##_int_contains(&m2, i), "copy should contain element");                          \
+                                                                                                                       \
+    tlbt_map_##NAME##_int_destroy(&m);                                                                                 \
+    tlbt_map_##NAME##_int_destroy(&m2);                                                                                \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+  STORE_HASH_TEST(int);
+  STORE_HASH_TEST(robin_hood);
+  STORE_HASH_TEST(simd);
+  TLBT_TEST_DONE();
+}
@@ -0,0 +1,135 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static int hash_calls = 0;
+
+static inline uint32_t counting_hash(int x) {
+  ++hash_calls;
+  // a few keys per home slot so that tombstones end up in the middle of probe sequences
+  return (uint32_t)x / 3 * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME robin_hood
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_ROBIN_HOOD
+#define TLBT_MAP_STORE_HASH
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME simd
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME dynamic
+#define TLBT_VALUE_T int
+#define TLBT_HASH(x) counting_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_STORE_HASH // otherwise migrating hashes keys again
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// counts key occurrences with get_or_insert while removing keys from time to time and compares with a lookup table
+#define COUNTING_TEST(MAP, INIT, CLEANUP)                                                                              \
+  do {                                                                                                                 \
+    int reference[64] = {0};                                                                                           \
+    tlbt_map_##MAP##_int m = {0};                                                                                      \
+    INIT;                                                                                                              \
+    uint32_t state = 777;                                                                                              \
+    for (int step = 0; step < 20000; ++step) {                                                                         \
+      state = state * 1103515245u + 12345u;                                                                            \
+      const int key = (int)((state >> 16) % 64);                                                                       \
+      if (step % 7 == 0) {                                                                                             \
+        tlbt_assert_msg(tlbt_map_##MAP##_int_remove(&m, key) == (reference[key] != 0), "remove disagrees");            \
+        reference[key] = 0;                                                                                            \
+        continue;                                                                                                      \
+      }                                                                                                                \
+      hash_calls = 0;                                                                                                  \
+      bool inserted = false;                                                                                           \
+      int *value = tlbt_map_##MAP##_int_get_or_insert(&m, key, &inserted);                                             \
+      tlbt_assert_msg(hash_calls == 1, "should have hashed the key only once");                                        \
+      tlbt_assert_msg(value != NULL, "the map can't be full");                                                         \
+      tlbt_assert_msg(inserted == (reference[key] == 0), "inserted flag disagrees");                                   \
+      if (inserted)                                                                                                    \
+        *value = 0;                                                                                                    \
+      ++*value;                                                                                                        \
+      ++reference[key];                                                                                                \
+    }                                                                                                                  \
+    size_t count = 0;                                                                                                  \
+    for (int key = 0; key < 64; ++key) {                                                                               \
+      int value = 0;                                                                                                   \
+      count += reference[key] != 0;                                                                                    \
+      const bool found = tlbt_map_##MAP##_int_get(&m, key, &value);                                                    \
+      tlbt_assert_msg(found == (reference[key] != 0), "map and reference disagree");                                   \
+      tlbt_assert_msg(reference[key] == 0 || value == reference[key], "wrong count");                                  \
+    }                                                                                                                  \
+    tlbt_assert_msg(m.count == count, "count should match the reference");                                             \
+    CLEANUP;                                                                                                           \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  {
+    tlbt_map_int_int_key keys[128];
+    int values[128];
+    COUNTING_TEST(int, tlbt_map_int_int_init(&m, 128, keys, values), (void)0);
+  }
+  {
+    tlbt_map_robin_hood_int_key keys[128];
+    int values[128];
+    COUNTING_TEST(robin_hood, tlbt_map_robin_hood_int_init(&m, 128, keys, values), (void)0);
+  }
+  {
+    tlbt_map_simd_int_key keys[128];
+    int values[128];
+    unsigned char ctrl[128 + 16];
+    COUNTING_TEST(simd, tlbt_map_simd_int_init(&m, 128, keys, values, ctrl), (void)0);
+  }
+  COUNTING_TEST(dynamic, tlbt_map_dynamic_int_create(&m, 16), tlbt_map_dynamic_int_destroy(&m));
+
+  // insert_or_assign and a full fixed memory map
+  {
+    tlbt_map_int_int_key keys[10];
+    int values[10];
+    tlbt_map_int_int m = {0};
+    tlbt_map_int_int_init(&m, 10, keys, values);
+    for (int i = 0; i < 7; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_insert_or_assign(&m, i, i), "should have inserted successfully");
+    for (int i = 0; i < 7; ++i)
+      tlbt_assert_msg(tlbt_map_int_int_insert_or_assign(&m, i, -i), "should have assigned successfully");
+    tlbt_assert_msg(m.count == 7, "assigning shouldn't change the count");
+    for (int i = 0; i < 7; ++i) {
+      int value = 0;
+      tlbt_assert_msg(tlbt_map_int_int_get(&m, i, &value) && value == -i, "value should have been overwritten");
+    }
+
+    bool inserted = true;
+    tlbt_assert_msg(!tlbt_map_int_int_insert_or_assign(&m, 100, 1), "the map should be full");
+    tlbt_assert_msg(tlbt_map_int_int_get_or_insert(&m, 100, &inserted) == NULL && !inserted, "the map should be full");
+    int *value = tlbt_map_int_int_get_or_insert(&m, 3, &inserted);
+    tlbt_assert_msg(value && *value == -3 && !inserted, "existing keys should still be found in a full map");
+  }
+
+  TLBT_TEST_DONE();
+}
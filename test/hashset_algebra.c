@@ -0,0 +1,134 @@
+#include <stddef.h>
+#include "common.h"
+#include "../src/assert.h"
+
+static inline uint32_t int_hash(int x) {
+  return (uint32_t)x * 2654435761u;
+}
+
+#define TLBT_KEY_T int
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_MAP_BATCH_CHUNK 7 // forces the keys to be split over several chunks
+#define TLBT_MAP_COUNTERS
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME stored
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_BASE2_CAPACITY
+#define TLBT_MAP_STORE_HASH
+#define TLBT_MAP_SIMD_PROBE
+#define TLBT_MAP_INCREMENTAL_RESIZE
+#define TLBT_MAP_MIGRATE_STEP 2
+#define TLBT_MAP_OCCUPANCY_BITMAP
+#define TLBT_DYNAMIC_MEMORY
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+#define TLBT_KEY_T int
+#define TLBT_KEY_T_NAME fixed
+#define TLBT_HASH(x) int_hash(x)
+#define TLBT_EQUALS(a, b) ((a) == (b))
+#define TLBT_STATIC
+#include "../src/hashmap.h"
+
+// a holds the multiples of 2 and b the multiples of 3 below 3000, so every result is easy to predict
+#define CHECK_ALGEBRA(SET, a, b)                                                                                       \
+  do {                                                                                                                 \
+    tlbt_set_##SET out = {0};                                                                                          \
+    tlbt_set_##SET##_create(&out, 16);                                                                                 \
+    tlbt_assert_msg(tlbt_set_##SET##_intersection_count((a), (b)) == 500, #SET " should have 500 multiples of 6");     \
+    tlbt_assert_msg(tlbt_set_##SET##_intersection_count((b), (a)) == 500, #SET " intersection should commute");        \
+                                                                                                                       \
+    tlbt_assert_msg(tlbt_set_##SET##_union_into(&out, (a), (b)) && out.count == 2000, #SET " wrong union");            \
+    for (int i = 0; i < 3000; ++i)                                                                                     \
+      tlbt_assert_fmt(tlbt_set_##SET##_contains(&out, i) == (i % 2 == 0 || i % 3 == 0),                                \
+                      #SET " union is wrong about %d", i);                                                             \
+    tlbt_assert_msg(tlbt_set_##SET##_intersect_into(&out, (b), (a)) && out.count == 500, #SET " wrong intersection");  \
+    for (int i = 0; i < 3000; ++i)                                                                                     \
+      tlbt_assert_fmt(tlbt_set_##SET##_contains(&out, i) == (i % 6 == 0), #SET " intersection is wrong about %d", i);  \
+    tlbt_assert_msg(tlbt_set_##SET##_difference_into(&out, (a), (b)) && out.count == 1000, #SET " wrong difference");  \
+    for (int i = 0; i < 3000; ++i)                                                                                     \
+      tlbt_assert_fmt(tlbt_set_##SET##_contains(&out, i) == (i % 2 == 0 && i % 3 != 0),                                \
+                      #SET " difference is wrong about %d", i);                                                        \
+    tlbt_set_##SET##_destroy(&out);                                                                                    \
+  } while (0)
+
+int main(void) {
+  TLBT_TEST_START();
+
+  {
+    tlbt_set_int a = {0}, b = {0};
+    tlbt_set_int_create(&a, 16);
+    tlbt_set_int_create(&b, 16);
+    for (int i = 0; i < 3000; ++i) {
+      if (i % 2 == 0)
+        tlbt_set_int_insert(&a, i);
+      if (i % 3 == 0)
+        tlbt_set_int_insert(&b, i);
+    }
+    CHECK_ALGEBRA(int, &a, &b);
+
+    // out is sized once for the biggest possible result
+    tlbt_set_int out = {0};
+    tlbt_set_int_create(&out, 16);
+    tlbt_set_int_union_into(&out, &a, &b);
+    tlbt_assert_msg(out.counters.resizes == 1, "union shouldn't grow more than once");
+    const uint64_t resizes = out.counters.resizes;
+    tlbt_set_int_intersect_into(&out, &a, &b);
+    tlbt_set_int_difference_into(&out, &b, &a);
+    tlbt_assert_msg(out.counters.resizes == resizes && out.count == 500, "big enough outputs shouldn't grow");
+
+    // empty sets
+    tlbt_set_int empty = {0};
+    tlbt_set_int_create(&empty, 16);
+    tlbt_assert_msg(tlbt_set_int_intersection_count(&a, &empty) == 0, "nothing intersects an empty set");
+    tlbt_assert_msg(tlbt_set_int_union_into(&out, &empty, &a) && out.count == a.count, "union with nothing is a");
+    tlbt_assert_msg(tlbt_set_int_difference_into(&out, &a, &empty) && out.count == a.count, "a minus nothing is a");
+    tlbt_assert_msg(tlbt_set_int_difference_into(&out, &empty, &a) && out.count == 0, "nothing minus a is nothing");
+    tlbt_set_int_destroy(&empty);
+    tlbt_set_int_destroy(&out);
+    tlbt_set_int_destroy(&a);
+    tlbt_set_int_destroy(&b);
+  }
+
+  // stored hashes, control bytes, the occupancy bitmap and inputs which are in the middle of a migration
+  {
+    tlbt_set_stored a = {0}, b = {0};
+    tlbt_set_stored_create(&a, 16);
+    tlbt_set_stored_create(&b, 16);
+    for (int i = 0; i < 3000; ++i) {
+      if (i % 2 == 0)
+        tlbt_set_stored_insert(&a, i);
+      if (i % 3 == 0)
+        tlbt_set_stored_insert(&b, i);
+    }
+    tlbt_assert_msg(a.old != NULL && b.old != NULL, "migrations should be in progress");
+    CHECK_ALGEBRA(stored, &a, &b);
+    tlbt_set_stored_destroy(&a);
+    tlbt_set_stored_destroy(&b);
+  }
+
+  // fixed memory outputs fail once they are full
+  {
+    tlbt_set_fixed_key a_keys[64], b_keys[64], out_keys[32];
+    tlbt_set_fixed a = {0}, b = {0}, out = {0};
+    tlbt_set_fixed_init(&a, 64, a_keys);
+    tlbt_set_fixed_init(&b, 64, b_keys);
+    tlbt_set_fixed_init(&out, 32, out_keys);
+    for (int i = 0; i < 40; ++i) {
+      tlbt_set_fixed_insert(&a, i);
+      tlbt_set_fixed_insert(&b, i + 30);
+    }
+    tlbt_assert_msg(tlbt_set_fixed_intersect_into(&out, &a, &b) && out.count == 10, "intersection should fit");
+    tlbt_assert_msg(!tlbt_set_fixed_union_into(&out, &a, &b) && out.count == 22, "union shouldn't fit");
+    tlbt_assert_msg(!tlbt_set_fixed_difference_into(&out, &a, &b) && out.count == 22, "difference shouldn't fit");
+    tlbt_assert_msg(tlbt_set_fixed_intersection_count(&a, &b) == 10, "should count without an output");
+  }
+
+  TLBT_TEST_DONE();
+}